@@ -0,0 +1,128 @@
+#ifndef MATHING_ALLOCATOR_H
+#define MATHING_ALLOCATOR_H
+
+/** Aligned memory for arrays of Vec4, Quaternion and Matrix.
+
+	Those types are aligned to MATHING_ALIGN, which is more than malloc() promises, and more than
+	std::allocator gives before C++17. AlignedAllocator keeps a std::vector of them aligned on any
+	standard, and AlignedVector is the shorthand for such a vector.
+
+	For transient buffers that only last a frame, a FrameArena hands out memory from one block
+	by bumping an offset, and takes it all back at once with Reset(), so there's no malloc() or
+	free() per buffer. It isn't thread safe, each thread should have its own.
+
+	\sa Vec4,
+		Quaternion,
+		Matrix
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <new>
+#include <vector>
+
+#include "scalar.h"
+
+namespace mathing
+{
+
+/// Allocates \p bytes aligned to \p align, a power of 2. Returns NULL if it can't.
+void *AlignedAlloc(size_t bytes, size_t align = MATHING_ALIGN);
+/// Frees memory from AlignedAlloc().
+void AlignedFree(void *p);
+
+/// Standard allocator of memory aligned to at least \p Align.
+template <typename T, size_t Align = (alignof(T) > MATHING_ALIGN ? alignof(T) : MATHING_ALIGN)>
+class AlignedAllocator
+{
+public:
+	typedef T value_type;
+	typedef T *pointer;
+	typedef const T *const_pointer;
+	typedef T &reference;
+	typedef const T &const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <typename U>
+	struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+	AlignedAllocator() {}
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Align> &) {}
+
+	T *allocate(size_t count)
+	{
+		if (count > SIZE_MAX / sizeof(T))
+			throw std::bad_array_new_length();
+		void *p = AlignedAlloc(count * sizeof(T), Align);
+		if (!p && count > 0)
+			throw std::bad_alloc();
+		return (T *)p;
+	}
+	void deallocate(T *p, size_t) { AlignedFree(p); }
+
+	template <typename U>
+	bool operator==(const AlignedAllocator<U, Align> &) const { return true; }
+	template <typename U>
+	bool operator!=(const AlignedAllocator<U, Align> &) const { return false; }
+};
+
+/// A std::vector that keeps its elements aligned.
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T> >;
+
+/// Bump allocator over one block, for buffers that are all thrown away together.
+class FrameArena
+{
+public:
+	/// Reserves \p capacity bytes.
+	FrameArena(size_t capacity = 0);
+	~FrameArena();
+
+	/// Changes the capacity. Everything allocated before is invalid.
+	void Reserve(size_t capacity);
+
+	/// Returns \p bytes aligned to \p align (a power of 2, at most MATHING_ALIGN), or NULL if
+	/// there isn't enough room left.
+	void *Allocate(size_t bytes, size_t align = MATHING_ALIGN);
+
+	/// Returns \p count default constructed T, or NULL if there isn't enough room left. Nothing is
+	/// destroyed when the arena is reset, so T should be something like Vec4, with nothing to clean up.
+	template <typename T>
+	T *Allocate(size_t count)
+	{
+		if (count > SIZE_MAX / sizeof(T))
+			return 0;
+		T *p = (T *)Allocate(count * sizeof(T), alignof(T));
+		if (p)
+		{
+			for (size_t i = 0; i < count; ++i)
+				new (p + i) T();
+		}
+		return p;
+	}
+
+	/// Where the arena is at, for Rewind().
+	inline size_t Mark() const { return m_Used; }
+	/// Takes back everything allocated since \p mark.
+	inline void Rewind(size_t mark) { m_Used = mark < m_Used ? mark : m_Used; }
+	/// Takes back everything, for the next frame.
+	inline void Reset() { m_Used = 0; }
+
+	inline size_t Used() const { return m_Used; }
+	inline size_t Capacity() const { return m_Capacity; }
+
+private:
+	FrameArena(const FrameArena &);
+	FrameArena &operator=(const FrameArena &);
+
+	char *m_Block;
+	size_t m_Capacity;
+	size_t m_Used;
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_ALLOCATOR_H
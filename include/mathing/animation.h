@@ -0,0 +1,98 @@
+#ifndef MATHING_ANIMATION_H
+#define MATHING_ANIMATION_H
+
+/** Keyframe animation clips, sampled a whole pose at a time.
+
+	A clip is a set of tracks, one per joint, each with its own keyframe times, and a rotation
+	and a position at every key. All the tracks' keys live in one array per channel (times,
+	rotations, positions), so sampling a pose walks a few contiguous arrays.
+
+	The clip is only read when sampling, so it can be shared between any number of characters
+	and threads. What each character's playback needs is an AnimationCursor, which remembers
+	the key each track was at. Playing forward, the next sample starts from there, so it costs
+	a compare or two per track instead of a binary search. Jumping back (looping) or far ahead
+	falls back to the search.
+
+	Rotations are blended with a normalized lerp along the shorter arc. For keys that are
+	close together, which is what sampled animation has, this is within a fraction of a degree
+	of Slerp() and a lot cheaper.
+
+	\sa Quaternion::Slerp,
+		Vec4::Lerp
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "allocator.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+class AnimationClip;
+
+/// Where one playback of a clip is at, per track.
+class AnimationCursor
+{
+public:
+	/// Starts over at the first key of every track of \p clip.
+	void Reset(const AnimationClip &clip);
+
+private:
+	friend class AnimationClip;
+	std::vector<uint32_t> m_Key;
+};
+
+class AnimationClip
+{
+public:
+	/// Adds a track with \p keyCount keys, at least 1, all at time 0 with no rotation. Returns the
+	/// index of the track. This can move the arrays, so pointers from before are invalid.
+	size_t AddTrack(size_t keyCount);
+	/// Removes all the tracks.
+	void Clear();
+
+	inline size_t TrackCount() const { return m_KeyStart.size(); }
+	inline size_t KeyCount(size_t track) const { return m_KeyCount[track]; }
+
+	/// The times of the keys of a track, which have to be increasing.
+	inline Scalar *Times(size_t track) { return &m_Time[m_KeyStart[track]]; }
+	/// The rotations and positions at each key of a track.
+	inline Quaternion *Rotations(size_t track) { return &m_Rotation[m_KeyStart[track]]; }
+	inline Vec4 *Positions(size_t track) { return &m_Position[m_KeyStart[track]]; }
+
+	/// The time of the last key of any track.
+	Scalar Duration() const;
+
+	/// Samples every track at \p time, into \p rotations and \p positions, TrackCount() of each.
+	/// Times before the first key or after the last are held at that key. \p cursor has to be
+	/// Reset() with this clip.
+	void Sample(AnimationCursor &cursor, Scalar time, Quaternion *rotations, Vec4 *positions) const;
+
+	/// Sample() straight into the local transform of every track.
+	void Sample(AnimationCursor &cursor, Scalar time, Matrix *transforms) const;
+
+private:
+	// Moves the cursor of a track to the key at or before \p time, and returns the blend toward the next key.
+	Scalar Seek(uint32_t &key, size_t track, Scalar time) const;
+	void SampleTrack(uint32_t &key, size_t track, Scalar time, Quaternion &rotation, Vec4 &position) const;
+
+	// Per track
+	std::vector<size_t> m_KeyStart;
+	std::vector<uint32_t> m_KeyCount;
+
+	// Per key
+	std::vector<Scalar> m_Time;
+	AlignedVector<Quaternion> m_Rotation;
+	AlignedVector<Vec4> m_Position;
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_ANIMATION_H
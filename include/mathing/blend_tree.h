@@ -0,0 +1,131 @@
+#ifndef MATHING_BLEND_TREE_H
+#define MATHING_BLEND_TREE_H
+
+/** Blending whole poses through a tree of blend and additive nodes.
+
+	A pose is a local rotation and position per bone, as AnimationClip::Sample() makes them.
+	The leaves of a tree are input poses given at evaluation, and every other node combines two
+	poses into one:
+
+	- Blend goes from pose a to pose b by a weight, with a normalized lerp along the shorter arc
+	  for the rotations. With a per-bone mask it only goes as far as the mask says for each bone,
+	  so a mask of ones and zeros makes an override layer.
+	- Additive puts pose b on top of pose a, as a delta: a's rotation times b's, with b's
+	  rotation scaled from no rotation by the weight, and b's position added.
+
+	Compile() flattens the tree under a root into the order it runs in, children before their
+	parent, which makes evaluating it a straight loop over a stack of poses. Every node writes
+	into the pose buffer of its depth in the stack, so the whole tree needs at most as many
+	buffers as it is deep, not one per node, and inputs are read where they are instead of
+	being copied. Those buffers come from a PoseArena, which is reset every frame, so nothing is allocated.
+
+	The tree itself isn't changed by evaluating it, so one tree can be evaluated on any number
+	of threads, each with its own arena.
+
+	\sa AnimationClip,
+		Quaternion
+*/
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "allocator.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+#define BLEND_TREE_MAX_DEPTH 32     // most poses on the evaluation stack at once
+
+namespace mathing
+{
+
+/// A rotation and a position for each bone. Nothing is owned.
+struct PoseBuffer
+{
+	Quaternion *rotations;
+	Vec4 *positions;
+
+	PoseBuffer() : rotations(0), positions(0) {}
+	PoseBuffer(Quaternion *rot, Vec4 *pos) : rotations(rot), positions(pos) {}
+};
+
+/// Hands out pose buffers from storage reserved up front, until Reset(). Unlike a FrameArena,
+/// the bones are constructed once by Reserve(), not every time a buffer is handed out.
+class PoseArena
+{
+public:
+	/// Reserves room for \p boneCapacity bones, over all the poses.
+	PoseArena(size_t boneCapacity = 0);
+	/// Changes the room reserved. Buffers handed out before are invalid.
+	void Reserve(size_t boneCapacity);
+
+	/// Takes back every buffer, for the next frame.
+	inline void Reset() { m_Used = 0; }
+	/// Sets \p pose to room for \p boneCount bones. Returns false if there isn't enough left.
+	bool Allocate(size_t boneCount, PoseBuffer &pose);
+
+	inline size_t Used() const { return m_Used; }
+	inline size_t Capacity() const { return m_Rotations.size(); }
+
+private:
+	AlignedVector<Quaternion> m_Rotations;
+	AlignedVector<Vec4> m_Positions;
+	size_t m_Used;
+};
+
+class BlendTree
+{
+public:
+	/// Every pose in the tree has \p boneCount bones.
+	BlendTree(size_t boneCount);
+
+	inline size_t BoneCount() const { return m_BoneCount; }
+
+	/// Adds a mask, \p boneWeights has a weight in [0, 1] for every bone. Returns the index of the mask.
+	int AddMask(const Scalar *boneWeights);
+
+	/// Adds a leaf that reads the pose \p input from the inputs given to Evaluate(). Returns the node.
+	size_t AddInput(size_t input);
+	/// Adds a node that blends from node \p a to node \p b by the parameter \p weightParam, and by
+	/// \p mask for each bone (-1 for none). Returns the node.
+	size_t AddBlend(size_t a, size_t b, size_t weightParam, int mask = -1);
+	/// Adds a node that adds node \p additive on top of node \p base, scaled by the parameter
+	/// \p weightParam, and by \p mask for each bone (-1 for none). Returns the node.
+	size_t AddAdditive(size_t base, size_t additive, size_t weightParam, int mask = -1);
+
+	/// Flattens the tree under \p root for Evaluate(). Nodes used in more than one place are
+	/// evaluated in each. Returns false if the tree is deeper than BLEND_TREE_MAX_DEPTH.
+	bool Compile(size_t root);
+
+	/// Pose buffers Evaluate() takes from the arena.
+	inline size_t ArenaPoses() const { return m_Buffers; }
+
+	/// Evaluates the compiled tree into \p out, with the poses \p inputs for the leaves and the
+	/// weights \p params for the nodes. Returns false if \p arena is out of room.
+	bool Evaluate(PoseArena &arena, const PoseBuffer *inputs, const Scalar *params, const PoseBuffer &out) const;
+
+private:
+	enum NodeType { INPUT, BLEND, ADDITIVE };
+	struct Node
+	{
+		NodeType type;
+		size_t a, b;        // children, or a is the input of a leaf
+		size_t param;
+		int mask;
+	};
+
+	void Flatten(size_t node);
+
+	size_t m_BoneCount;
+	std::vector<Node> m_Nodes;
+	std::vector<Scalar> m_Masks;
+	int m_MaskCount;
+	std::vector<size_t> m_Order;
+	size_t m_Depth;
+	size_t m_Buffers;
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_BLEND_TREE_H
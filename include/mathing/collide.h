@@ -0,0 +1,104 @@
+#ifndef MATHING_COLLIDE_H
+#define MATHING_COLLIDE_H
+
+/** Distance and penetration queries between posed convex shapes, with GJK and EPA.
+
+	Shapes are described in their local space by a support function, and posed in the world by
+	a rigid Matrix (or a Quaternion and a position). Every shape is a "core" (a point, segment,
+	box or hull) inflated by a radius, so a sphere is a point with a radius, and a capsule is a
+	segment with a radius. GJK runs on the cores, and the radii are applied analytically, which
+	is both faster and more exact for round shapes. EPA is only needed when the cores themselves
+	overlap.
+
+	Nothing here allocates. GJK keeps a fixed size simplex, and EPA a fixed size polytope.
+
+	\sa Matrix,
+		Quaternion,
+		Vec4
+*/
+
+#include <stddef.h>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// A convex shape in its local space.
+struct ConvexShape
+{
+	enum Type
+	{
+		/// A point at the origin, inflated by the radius.
+		SPHERE,
+		/// Box centered at the origin, with half extents.
+		BOX,
+		/// A segment along local Y, from -halfHeight to +halfHeight, inflated by the radius.
+		CAPSULE,
+		/// Convex hull of points. The points are not copied, and have to outlive the shape.
+		HULL
+	};
+
+	Type type;
+	/// Inflates the core of the shape. Can be used to round off the edges of boxes and hulls too.
+	Scalar radius;
+	/// Box half extents, or capsule half height in y.
+	Vec4 halfExtents;
+	const Vec4 *verts;
+	int vertCount;
+
+	static ConvexShape Sphere(Scalar radius);
+	static ConvexShape Box(const Vec4 &halfExtents, Scalar radius = 0);
+	static ConvexShape Capsule(Scalar halfHeight, Scalar radius);
+	static ConvexShape Hull(const Vec4 *verts, int vertCount, Scalar radius = 0);
+
+	/// The point of the core furthest along \p dir, in local space. Doesn't include the radius.
+	Vec4 Support(const Vec4 &dir) const;
+};
+
+/// Result of a query between shapes A and B.
+struct ShapeQueryResult
+{
+	/// Distance between the shapes, negative is the penetration depth.
+	Scalar distance;
+	/// Unit normal from A to B. Moving B along it by -distance separates the shapes.
+	Vec4 normal;
+	/// Closest points on A and B when separated, deepest points when penetrating. World space.
+	Vec4 pointA, pointB;
+	/// GJK iterations, plus EPA iterations if it was needed.
+	int iterations;
+};
+
+/// A pair of posed shapes for the batch query. Nothing is copied.
+struct ShapePair
+{
+	const ConvexShape *a;
+	const Matrix *poseA;
+	const ConvexShape *b;
+	const Matrix *poseB;
+};
+
+/// Distance between the shapes with GJK. Returns true if they are separated.
+/// If they overlap, \p result only has a penetration depth when just the radii overlap, otherwise
+/// the distance is 0. Use ShapeQuery() for the penetration.
+bool ShapeDistance(const ConvexShape &a, const Matrix &poseA,
+	const ConvexShape &b, const Matrix &poseB, ShapeQueryResult &result);
+bool ShapeDistance(const ConvexShape &a, const Quaternion &rotA, const Vec4 &posA,
+	const ConvexShape &b, const Quaternion &rotB, const Vec4 &posB, ShapeQueryResult &result);
+
+/// Distance between the shapes with GJK, or penetration with EPA if they overlap.
+/// Returns true if they overlap (or touch).
+bool ShapeQuery(const ConvexShape &a, const Matrix &poseA,
+	const ConvexShape &b, const Matrix &poseB, ShapeQueryResult &result);
+bool ShapeQuery(const ConvexShape &a, const Quaternion &rotA, const Vec4 &posA,
+	const ConvexShape &b, const Quaternion &rotB, const Vec4 &posB, ShapeQueryResult &result);
+
+/// ShapeQuery() on \p count \p pairs, one result each. Returns the number of overlapping pairs.
+size_t ShapeQuery(const ShapePair *pairs, size_t count, ShapeQueryResult *results);
+
+}  // namespace mathing
+
+#endif  // MATHING_COLLIDE_H
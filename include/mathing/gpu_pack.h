@@ -0,0 +1,79 @@
+#ifndef MATHING_GPU_PACK_H
+#define MATHING_GPU_PACK_H
+
+/** Packing transforms into GPU upload buffers.
+
+	Shaders usually want float or half matrices, multiplying column vectors, where a Matrix is
+	Scalar, multiplying row vectors. So the matrix the shader sees is the transpose of the
+	Matrix, T = M^T, with the axes and position in its columns. A PackLayout picks how T is
+	laid out in memory:
+
+	- COLUMN_MAJOR 4x4 is T's 4 columns, which is the Matrix as it is, narrowed.
+	- ROW_MAJOR 4x4 is T's 4 rows.
+	- 3x4 drops T's bottom row, which is always 0, 0, 0, 1, so ROW_MAJOR is 3 rows of 4 (the
+	  usual instance layout) and COLUMN_MAJOR is 4 columns of 3.
+
+	The elements are FLOAT32 or FLOAT16. Matrices start Stride() bytes apart, which is their
+	size unless the layout gives a bigger stride, to leave room for other per instance data,
+	which is left alone.
+
+	Upload buffers are usually write combined memory that's never read back by the CPU, so the
+	packers write with non-temporal stores where the hardware has them. Each matrix is narrowed
+	into one block of floats on the stack, already in its packed order, and stored from there;
+	transforms are written into it straight from the Quaternion and Vec4, no Matrix is made.
+	The destination has to be 4 byte aligned, and the stride a multiple of 4. With 16 byte
+	alignment of both, whole 16 byte blocks are stored at once.
+
+	\sa Matrix::Transpose,
+		FloatToHalf
+*/
+
+#include <stddef.h>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+struct PackLayout
+{
+	enum Order
+	{
+		/// T row by row.
+		ROW_MAJOR,
+		/// T column by column, which is the Matrix row by row.
+		COLUMN_MAJOR
+	};
+
+	enum Format
+	{
+		FLOAT32,
+		FLOAT16
+	};
+
+	Order order;
+	/// 4 for 4x4, or 3 for 3x4, without T's bottom row.
+	int rows;
+	Format format;
+	/// Bytes from the start of one matrix to the next, or 0 for MatrixBytes().
+	size_t stride;
+
+	PackLayout(Order orderArg = COLUMN_MAJOR, int rowsArg = 4, Format formatArg = FLOAT32, size_t strideArg = 0)
+		: order(orderArg), rows(rowsArg), format(formatArg), stride(strideArg) {}
+
+	inline size_t ElementCount() const { return rows * 4; }
+	inline size_t MatrixBytes() const { return ElementCount() * (format == FLOAT16 ? 2 : 4); }
+	inline size_t Stride() const { return stride ? stride : MatrixBytes(); }
+};
+
+/// Packs \p count matrices into \p out, which has to have room for count * layout.Stride() bytes.
+void PackMatrices(const Matrix *in, size_t count, const PackLayout &layout, void *out);
+/// Packs \p count transforms given as unit rotations and positions, as if they were matrices
+/// made from them. T is worked out from the rotation and position, without making the matrices.
+void PackTransforms(const Quaternion *rotations, const Vec4 *positions, size_t count, const PackLayout &layout, void *out);
+
+}  // namespace mathing
+
+#endif  // MATHING_GPU_PACK_H
@@ -0,0 +1,124 @@
+#ifndef MATHING_IK_H
+#define MATHING_IK_H
+
+/** Inverse kinematics for many joint chains at once, with CCD or FABRIK.
+
+	A chain is a root (the world position and rotation of the first joint's parent), followed by
+	joints that each have a local rotation and an offset to the next joint, in the joint's local
+	space. The offset of the last joint leads to the end effector, which gets pulled to the target.
+
+	Rotations compose the same way as Quaternion::operator*, a joint's world rotation is its
+	parent's world rotation times its local rotation.
+
+	All the chains live in a handful of contiguous arrays, one entry per joint, so solving doesn't
+	allocate. Chains are independent of each other, so the solvers take a range of chains and can
+	be split across threads.
+
+	Both solvers stop after a number of iterations, or once the end effector is within a tolerance
+	of the target, so the cost per frame is bounded.
+
+	\sa Quaternion
+*/
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "allocator.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// Budget for a solve.
+struct IKSettings
+{
+	/// Most iterations to spend on each chain.
+	int maxIterations;
+	/// Distance from the end effector to the target that is close enough.
+	Scalar tolerance;
+
+	IKSettings(int iterations = 16, Scalar tol = 1e-4) : maxIterations(iterations), tolerance(tol) {}
+};
+
+class IKChains
+{
+public:
+	/// Adds a chain of \p jointCount joints, all with no rotation, no offset, and no limits.
+	/// Returns the index of the chain. This can move the arrays, so pointers from before are invalid.
+	size_t AddChain(size_t jointCount);
+	/// Removes all the chains.
+	void Clear();
+
+	inline size_t ChainCount() const { return m_JointStart.size(); }
+	inline size_t JointCount(size_t chain) const { return m_JointCount[chain]; }
+
+	/// World position and rotation of the parent of the first joint.
+	inline Vec4 &RootPosition(size_t chain) { return m_RootPosition[chain]; }
+	inline Quaternion &RootRotation(size_t chain) { return m_RootRotation[chain]; }
+	/// Where the end effector should go.
+	inline Vec4 &Target(size_t chain) { return m_Target[chain]; }
+
+	/// The local rotations of the joints of a chain, JointCount() of them.
+	inline Quaternion *LocalRotations(size_t chain) { return &m_Local[m_JointStart[chain]]; }
+	/// The offset from each joint to the next (or the end effector), in the joint's local space.
+	inline Vec4 *Offsets(size_t chain) { return &m_Offset[m_JointStart[chain]]; }
+
+	/// Limits how far the local rotation of a joint can turn away from no rotation, in radians.
+	void SetJointLimit(size_t chain, size_t joint, Scalar maxAngle);
+	/// Removes the limit of a joint.
+	void ClearJointLimit(size_t chain, size_t joint);
+
+	/// World positions of the joints, plus the end effector at the end. Updated by the solvers and UpdateWorld().
+	inline const Vec4 *WorldPositions(size_t chain) const { return &m_WorldPos[m_JointStart[chain] + chain]; }
+	/// World rotations of the joints. Updated by the solvers and UpdateWorld().
+	inline const Quaternion *WorldRotations(size_t chain) const { return &m_WorldRot[m_JointStart[chain]]; }
+
+	/// Distance from the end effector to the target after the last solve.
+	inline Scalar Error(size_t chain) const { return m_Error[chain]; }
+	/// Iterations used by the last solve.
+	inline int Iterations(size_t chain) const { return m_Iterations[chain]; }
+
+	/// Forward kinematics, the world positions and rotations from the local rotations.
+	void UpdateWorld(size_t begin = 0, size_t end = (size_t)-1);
+
+	/// Cyclic coordinate descent. Each iteration turns every joint, from the end effector back to
+	/// the root, to point the end effector at the target.
+	void SolveCCD(const IKSettings &settings, size_t begin = 0, size_t end = (size_t)-1);
+
+	/// Forward and backward reaching. Each iteration solves the joint positions by dragging the chain
+	/// to the target and back to the root, and the rotations are fit to the positions at the end.
+	/// Joint limits are applied as the rotations are fit, so limited chains can end up short of the target.
+	void SolveFABRIK(const IKSettings &settings, size_t begin = 0, size_t end = (size_t)-1);
+
+private:
+	void UpdateWorldFrom(size_t chain, size_t joint);
+	void TurnJoint(size_t chain, size_t joint, const Vec4 &from, const Vec4 &to);
+
+	// Per chain
+	std::vector<size_t> m_JointStart;
+	std::vector<size_t> m_JointCount;
+	AlignedVector<Vec4> m_RootPosition;
+	AlignedVector<Quaternion> m_RootRotation;
+	AlignedVector<Vec4> m_Target;
+	std::vector<Scalar> m_Error;
+	std::vector<int> m_Iterations;
+
+	// Per joint
+	AlignedVector<Quaternion> m_Local;
+	AlignedVector<Vec4> m_Offset;
+	/// Cosine of half the limit angle, -1 for no limit, and the sine to go with it.
+	std::vector<Scalar> m_LimitCos;
+	std::vector<Scalar> m_LimitSin;
+	AlignedVector<Quaternion> m_WorldRot;
+
+	// Per joint, plus one per chain for the end effector
+	AlignedVector<Vec4> m_WorldPos;
+	AlignedVector<Vec4> m_Reach;
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_IK_H
@@ -1,6 +1,8 @@
 #ifndef MATHING_IMPL_MATRIX_H
 #define MATHING_IMPL_MATRIX_H
 
+#include <string.h>
+
 #include "../quaternion.h"
 #include "../vector.h"
 #include "../scalar.h"
@@ -13,8 +15,8 @@ namespace mathing
 // a simple c++ implementation.
 class MatrixCppImpl4x4
 {
-	/// Holds the data for the matrix
-	Scalar m[16];
+	/// Holds the data for the matrix, aligned so AxisX() and the rest are aligned Vec4s
+	alignas(MATHING_ALIGN) Scalar m[16];
 
 	// Access is awkward like this, and rarely used.
 	// If direct access to the buffer is really needed, it can be an accessor.
@@ -96,6 +98,25 @@ public:
 		m[15] = 1;
 	}
 
+	/// Positioned at \p eye with the Z axis toward \p target, and the Y axis as close to \p up as it
+	/// can be. When \p target is at \p eye, Z stays the unit Z. When \p up is along the look
+	/// direction (or 0), the world axis furthest from it is used for up instead.
+	void SetLookAt(const Vec4 &eye, const Vec4 &target, const Vec4 &up);
+
+	// Projections for a view looking down +Z, the way SetLookAt() points Z at the target, with
+	// depth 0 at the near plane and 1 at the far plane.
+	void SetPerspective(Scalar fovY, Scalar aspect, Scalar zNear, Scalar zFar);
+	inline void SetOrthographic(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar zNear, Scalar zFar)
+	{
+		Scalar invWidth = 1 / (right - left);
+		Scalar invHeight = 1 / (top - bottom);
+		Scalar invDepth = 1 / (zFar - zNear);
+		m[ 0] = 2 * invWidth;					m[ 1] = 0;								m[ 2] = 0;					m[ 3] = 0;
+		m[ 4] = 0;								m[ 5] = 2 * invHeight;					m[ 6] = 0;					m[ 7] = 0;
+		m[ 8] = 0;								m[ 9] = 0;								m[10] = invDepth;			m[11] = 0;
+		m[12] = -(right + left) * invWidth;	m[13] = -(top + bottom) * invHeight;	m[14] = -zNear * invDepth;	m[15] = 1;
+	}
+
 	inline Vec4 &AxisX() const { return (Vec4 &)m[0]; }
 	inline Vec4 &AxisY() const { return (Vec4 &)m[4]; }
 	inline Vec4 &AxisZ() const { return (Vec4 &)m[8]; }
@@ -129,22 +150,22 @@ public:
 		tmp.m[ 0]=m[ 0]*rhs.m[ 0] + m[ 1]*rhs.m[ 4] + m[ 2]*rhs.m[ 8] + m[ 3]*rhs.m[12];
 		tmp.m[ 1]=m[ 0]*rhs.m[ 1] + m[ 1]*rhs.m[ 5] + m[ 2]*rhs.m[ 9] + m[ 3]*rhs.m[13];
 		tmp.m[ 2]=m[ 0]*rhs.m[ 2] + m[ 1]*rhs.m[ 6] + m[ 2]*rhs.m[10] + m[ 3]*rhs.m[14];
-		tmp.m[ 3]=m[ 0]*rhs.m[ 3] + m[ 1]*rhs.m[ 7] + m[ 2]*rhs.m[12] + m[ 3]*rhs.m[15];
+		tmp.m[ 3]=m[ 0]*rhs.m[ 3] + m[ 1]*rhs.m[ 7] + m[ 2]*rhs.m[11] + m[ 3]*rhs.m[15];
 
 		tmp.m[ 4]=m[ 4]*rhs.m[ 0] + m[ 5]*rhs.m[ 4] + m[ 6]*rhs.m[ 8] + m[ 7]*rhs.m[12];
 		tmp.m[ 5]=m[ 4]*rhs.m[ 1] + m[ 5]*rhs.m[ 5] + m[ 6]*rhs.m[ 9] + m[ 7]*rhs.m[13];
 		tmp.m[ 6]=m[ 4]*rhs.m[ 2] + m[ 5]*rhs.m[ 6] + m[ 6]*rhs.m[10] + m[ 7]*rhs.m[14];
-		tmp.m[ 7]=m[ 4]*rhs.m[ 3] + m[ 5]*rhs.m[ 7] + m[ 6]*rhs.m[12] + m[ 7]*rhs.m[15];
+		tmp.m[ 7]=m[ 4]*rhs.m[ 3] + m[ 5]*rhs.m[ 7] + m[ 6]*rhs.m[11] + m[ 7]*rhs.m[15];
 
 		tmp.m[ 8]=m[ 8]*rhs.m[ 0] + m[ 9]*rhs.m[ 4] + m[10]*rhs.m[ 8] + m[11]*rhs.m[12];
 		tmp.m[ 9]=m[ 8]*rhs.m[ 1] + m[ 9]*rhs.m[ 5] + m[10]*rhs.m[ 9] + m[11]*rhs.m[13];
 		tmp.m[10]=m[ 8]*rhs.m[ 2] + m[ 9]*rhs.m[ 6] + m[10]*rhs.m[10] + m[11]*rhs.m[14];
-		tmp.m[11]=m[ 8]*rhs.m[ 3] + m[ 9]*rhs.m[ 7] + m[10]*rhs.m[12] + m[11]*rhs.m[15];
+		tmp.m[11]=m[ 8]*rhs.m[ 3] + m[ 9]*rhs.m[ 7] + m[10]*rhs.m[11] + m[11]*rhs.m[15];
 
 		tmp.m[12]=m[12]*rhs.m[ 0] + m[13]*rhs.m[ 4] + m[14]*rhs.m[ 8] + m[15]*rhs.m[12];
 		tmp.m[13]=m[12]*rhs.m[ 1] + m[13]*rhs.m[ 5] + m[14]*rhs.m[ 9] + m[15]*rhs.m[13];
 		tmp.m[14]=m[12]*rhs.m[ 2] + m[13]*rhs.m[ 6] + m[14]*rhs.m[10] + m[15]*rhs.m[14];
-		tmp.m[15]=m[12]*rhs.m[ 3] + m[13]*rhs.m[ 7] + m[14]*rhs.m[12] + m[15]*rhs.m[15];
+		tmp.m[15]=m[12]*rhs.m[ 3] + m[13]*rhs.m[ 7] + m[14]*rhs.m[11] + m[15]*rhs.m[15];
 
 		memcpy(m, tmp.m, sizeof(Scalar)*16);
 		return *this;
@@ -157,22 +178,22 @@ public:
 		tmp.m[ 0] = m[ 0] * rhs.m[ 0] + m[ 1]*rhs.m[ 4] + m[ 2]*rhs.m[ 8] + m[ 3]*rhs.m[12];
 		tmp.m[ 1] = m[ 0] * rhs.m[ 1] + m[ 1]*rhs.m[ 5] + m[ 2]*rhs.m[ 9] + m[ 3]*rhs.m[13];
 		tmp.m[ 2] = m[ 0] * rhs.m[ 2] + m[ 1]*rhs.m[ 6] + m[ 2]*rhs.m[10] + m[ 3]*rhs.m[14];
-		tmp.m[ 3] = m[ 0] * rhs.m[ 3] + m[ 1]*rhs.m[ 7] + m[ 2]*rhs.m[12] + m[ 3]*rhs.m[15];
+		tmp.m[ 3] = m[ 0] * rhs.m[ 3] + m[ 1]*rhs.m[ 7] + m[ 2]*rhs.m[11] + m[ 3]*rhs.m[15];
 
 		tmp.m[ 4] = m[ 4] * rhs.m[ 0] + m[ 5]*rhs.m[ 4] + m[ 6]*rhs.m[ 8] + m[ 7]*rhs.m[12];
 		tmp.m[ 5] = m[ 4] * rhs.m[ 1] + m[ 5]*rhs.m[ 5] + m[ 6]*rhs.m[ 9] + m[ 7]*rhs.m[13];
 		tmp.m[ 6] = m[ 4] * rhs.m[ 2] + m[ 5]*rhs.m[ 6] + m[ 6]*rhs.m[10] + m[ 7]*rhs.m[14];
-		tmp.m[ 7] = m[ 4] * rhs.m[ 3] + m[ 5]*rhs.m[ 7] + m[ 6]*rhs.m[12] + m[ 7]*rhs.m[15];
+		tmp.m[ 7] = m[ 4] * rhs.m[ 3] + m[ 5]*rhs.m[ 7] + m[ 6]*rhs.m[11] + m[ 7]*rhs.m[15];
 
 		tmp.m[ 8] = m[ 8] * rhs.m[ 0] + m[ 9]*rhs.m[ 4] + m[10]*rhs.m[ 8] + m[11]*rhs.m[12];
 		tmp.m[ 9] = m[ 8] * rhs.m[ 1] + m[ 9]*rhs.m[ 5] + m[10]*rhs.m[ 9] + m[11]*rhs.m[13];
 		tmp.m[10] = m[ 8] * rhs.m[ 2] + m[ 9]*rhs.m[ 6] + m[10]*rhs.m[10] + m[11]*rhs.m[14];
-		tmp.m[11] = m[ 8] * rhs.m[ 3] + m[ 9]*rhs.m[ 7] + m[10]*rhs.m[12] + m[11]*rhs.m[15];
+		tmp.m[11] = m[ 8] * rhs.m[ 3] + m[ 9]*rhs.m[ 7] + m[10]*rhs.m[11] + m[11]*rhs.m[15];
 
 		tmp.m[12] = m[12] * rhs.m[ 0] + m[13]*rhs.m[ 4] + m[14]*rhs.m[ 8] + m[15]*rhs.m[12];
 		tmp.m[13] = m[12] * rhs.m[ 1] + m[13]*rhs.m[ 5] + m[14]*rhs.m[ 9] + m[15]*rhs.m[13];
 		tmp.m[14] = m[12] * rhs.m[ 2] + m[13]*rhs.m[ 6] + m[14]*rhs.m[10] + m[15]*rhs.m[14];
-		tmp.m[15] = m[12] * rhs.m[ 3] + m[13]*rhs.m[ 7] + m[14]*rhs.m[12] + m[15]*rhs.m[15];
+		tmp.m[15] = m[12] * rhs.m[ 3] + m[13]*rhs.m[ 7] + m[14]*rhs.m[11] + m[15]*rhs.m[15];
 		return tmp;
 	}
 
@@ -185,8 +206,19 @@ public:
 		ret.y = v.x * m[1] + v.y * m[5] + v.z * m[ 9] + m[13];
 		ret.z = v.x * m[2] + v.y * m[6] + v.z * m[10] + m[14];
 
-		// TODO: Change to 1?
-		ret.w=v.w; //v.x*m[ 3] + v.y*m[ 7] + v.z*m[11] + m[15];	// usually just 1
+		// The last column is 0,0,0,1 for rigid transforms, so w passes through; Project() is
+		// the one that works it out.
+		ret.w = v.w;
+		return ret;
+	}
+	// <x,y,z,1> * M with all 4 columns, for projections.
+	inline Vec4 Project(const Vec4 &v) const
+	{
+		Vec4 ret;
+		ret.x = v.x * m[0] + v.y * m[4] + v.z * m[ 8] + m[12];
+		ret.y = v.x * m[1] + v.y * m[5] + v.z * m[ 9] + m[13];
+		ret.z = v.x * m[2] + v.y * m[6] + v.z * m[10] + m[14];
+		ret.w = v.x * m[3] + v.y * m[7] + v.z * m[11] + m[15];
 		return ret;
 	}
 
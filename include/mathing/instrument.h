@@ -0,0 +1,138 @@
+#ifndef MATHING_INSTRUMENT_H
+#define MATHING_INSTRUMENT_H
+
+/** Optional counts and timings of the hot math operations.
+
+	Built with MATHING_INSTRUMENT defined (the MATHING_INSTRUMENT option in CMake, which defines
+	it for the library and everything that uses it), the operations below count every call, and
+	time every INSTRUMENT_SAMPLE_PERIOD-th one, in ticks of the cycle counter where there is one
+	(rdtsc on x86), or nanoseconds where there isn't. The counters are per thread, so counting
+	is a plain add to memory no other thread writes.
+
+	Without it, MATHING_INSTRUMENT_SCOPE() is nothing at all, and the snapshot is all zeros.
+
+	InstrumentSnapshot() sums the counters of every thread, running or finished, into an
+	InstrumentCounts, and InstrumentReport() prints one as a table. Counts from threads that
+	are running while the snapshot is taken may be a few calls behind.
+
+	The operations are counted one call at a time. A lot of calls to the single versions from
+	one place is what says to move it to the batch versions.
+*/
+
+#include <stdint.h>
+
+#include <iostream>
+
+#ifdef MATHING_INSTRUMENT
+#include <atomic>
+#endif
+
+#define INSTRUMENT_SAMPLE_PERIOD 64    // every this many calls of an operation on a thread is timed, a power of 2
+
+namespace mathing
+{
+
+enum InstrumentOp
+{
+	INSTRUMENT_MATRIX_MULTIPLY,
+	INSTRUMENT_MATRIX_INVERSE,
+	INSTRUMENT_MATRIX_TRANSFORM,
+	INSTRUMENT_QUATERNION_MULTIPLY,
+	INSTRUMENT_QUATERNION_SLERP,
+	INSTRUMENT_QUATERNION_FROM_MATRIX,
+	INSTRUMENT_QUATERNION_ROTATE,
+	INSTRUMENT_OP_COUNT
+};
+
+/// Totals per operation.
+struct InstrumentCounts
+{
+	uint64_t calls[INSTRUMENT_OP_COUNT];
+	/// How many of the calls were timed, and their ticks all together.
+	uint64_t sampledCalls[INSTRUMENT_OP_COUNT];
+	uint64_t sampledTicks[INSTRUMENT_OP_COUNT];
+
+	InstrumentCounts();
+};
+
+/// True if the library was built with MATHING_INSTRUMENT.
+bool InstrumentEnabled();
+/// The name of \p op, like "Matrix::operator*".
+const char *InstrumentOpName(InstrumentOp op);
+/// Sums the counters of every thread into \p out.
+void InstrumentSnapshot(InstrumentCounts &out);
+/// Zeroes the counters of every thread. Calls counted at the same time on other threads may be lost.
+void InstrumentReset();
+/// Writes a line per operation that was called: calls, average ticks of the timed ones, and the
+/// estimated total ticks, most first.
+void InstrumentReport(std::ostream &os, const InstrumentCounts &counts);
+
+#ifdef MATHING_INSTRUMENT
+
+/// Reads the cycle counter, or the time in nanoseconds.
+uint64_t InstrumentTicks();
+
+/// The counters of one thread. Only that thread writes them, the atomics are only so other
+/// threads can read them while it does.
+struct InstrumentThread
+{
+	std::atomic<uint64_t> calls[INSTRUMENT_OP_COUNT];
+	std::atomic<uint64_t> sampledCalls[INSTRUMENT_OP_COUNT];
+	std::atomic<uint64_t> sampledTicks[INSTRUMENT_OP_COUNT];
+
+	/// Registers the thread's counters, so snapshots find them.
+	InstrumentThread();
+	/// Adds them to the totals of finished threads.
+	~InstrumentThread();
+
+	static inline InstrumentThread &Local()
+	{
+		static thread_local InstrumentThread counters;
+		return counters;
+	}
+
+	static inline void Add(std::atomic<uint64_t> &counter, uint64_t v)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+	}
+};
+
+/// Counts a call for as long as it's in scope, and times it if it's a sampled one.
+class InstrumentScope
+{
+public:
+	inline InstrumentScope(InstrumentOp op)
+		: m_Counters(InstrumentThread::Local()), m_Op(op), m_Start(0)
+	{
+		uint64_t n = m_Counters.calls[op].load(std::memory_order_relaxed) + 1;
+		m_Counters.calls[op].store(n, std::memory_order_relaxed);
+		if ((n & (INSTRUMENT_SAMPLE_PERIOD - 1)) == 0)
+			m_Start = InstrumentTicks();
+	}
+
+	inline ~InstrumentScope()
+	{
+		if (m_Start)
+		{
+			InstrumentThread::Add(m_Counters.sampledTicks[m_Op], InstrumentTicks() - m_Start);
+			InstrumentThread::Add(m_Counters.sampledCalls[m_Op], 1);
+		}
+	}
+
+private:
+	InstrumentThread &m_Counters;
+	InstrumentOp m_Op;
+	uint64_t m_Start;
+};
+
+#define MATHING_INSTRUMENT_SCOPE(op) ::mathing::InstrumentScope mathingInstrumentScope(::mathing::op)
+
+#else
+
+#define MATHING_INSTRUMENT_SCOPE(op) ((void)0)
+
+#endif  // MATHING_INSTRUMENT
+
+}  // namespace mathing
+
+#endif  // MATHING_INSTRUMENT_H
@@ -0,0 +1,63 @@
+#ifndef MATHING_INTEGRATE_H
+#define MATHING_INTEGRATE_H
+
+/** Batch integration of rigid body positions and orientations.
+
+	The bodies are kept as separate arrays per quantity (positions, orientations, ...), which
+	the integrators walk in lock step. Orientations are renormalized as part of every step, so
+	the caller never has to.
+
+	Angular velocities are in world space, so a body spinning at w for dt turns by |w|*dt
+	about w, applied after (on top of) its current orientation.
+
+	Every body is independent, so the range [begin, end) can be split across threads.
+
+	\sa Quaternion,
+		Vec4,
+		Matrix
+*/
+
+#include <stddef.h>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// Arrays of rigid body state, all \p count long. Nothing is owned.
+struct RigidBodyArrays
+{
+	Vec4 *position;
+	Vec4 *velocity;
+	Quaternion *orientation;
+	Vec4 *angularVelocity;
+
+	/// Optional (NULL for none), added to the velocities before they are integrated.
+	const Vec4 *acceleration;
+	const Vec4 *angularAcceleration;
+
+	/// Optional (NULL for none), receives the world transform of every body after the step.
+	Matrix *world;
+
+	size_t count;
+
+	RigidBodyArrays()
+		: position(0), velocity(0), orientation(0), angularVelocity(0),
+		  acceleration(0), angularAcceleration(0), world(0), count(0) {}
+};
+
+/// Semi-implicit Euler: velocities are updated first, then integrate the positions, and the
+/// orientations step along q' = 1/2 (w, 0) q, then renormalize. Cheap, and fine for small
+/// angular steps.
+void IntegrateEuler(const RigidBodyArrays &bodies, Scalar dt, size_t begin = 0, size_t end = (size_t)-1);
+
+/// Like IntegrateEuler(), but the orientations are rotated by the exact rotation of |w|*dt about
+/// w (the exponential map), so fast spinning bodies don't lose or gain rotation.
+void IntegrateExpMap(const RigidBodyArrays &bodies, Scalar dt, size_t begin = 0, size_t end = (size_t)-1);
+
+}  // namespace mathing
+
+#endif  // MATHING_INTEGRATE_H
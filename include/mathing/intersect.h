@@ -0,0 +1,119 @@
+#ifndef MATHING_INTERSECT_H
+#define MATHING_INTERSECT_H
+
+/** Ray intersection kernels for triangles (Moller-Trumbore) and axis aligned boxes (slabs).
+
+	The packet versions work on N rays at once, stored as structure-of-arrays, so that every
+	lane does exactly the same math with no branches. That's the layout the compiler can turn
+	into vector code, and it's the reason to use them for coherent rays (camera, shadow).
+	Packets are instantiated for N = 4, 8 and 16.
+
+	Lane results are reported as a bit mask, lane i is bit (1 << i).
+
+	\sa Vec4
+*/
+
+#include <limits>
+
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// N rays stored as structure-of-arrays.
+template <int N>
+struct RayPacket
+{
+	Scalar ox[N], oy[N], oz[N];
+	Scalar dx[N], dy[N], dz[N];
+	/// 1/d, precomputed for the box slabs.
+	Scalar idx[N], idy[N], idz[N];
+	Scalar tMin[N], tMax[N];
+
+	/// Set lane \p i from an \p origin and a \p dir. The direction doesn't need to be unit length,
+	/// but the hit distances are measured in units of its length.
+	inline void Set(int i, const Vec4 &origin, const Vec4 &dir,
+		Scalar tmin = 0, Scalar tmax = std::numeric_limits<Scalar>::max())
+	{
+		ox[i] = origin.x;	oy[i] = origin.y;	oz[i] = origin.z;
+		dx[i] = dir.x;		dy[i] = dir.y;		dz[i] = dir.z;
+		// Infinite reciprocals are fine here, the slab test handles them.
+		idx[i] = 1 / dir.x;	idy[i] = 1 / dir.y;	idz[i] = 1 / dir.z;
+		tMin[i] = tmin;
+		tMax[i] = tmax;
+	}
+
+	static const int Size = N;
+};
+
+/// Closest hit per lane, for a packet of N rays.
+template <int N>
+struct PacketHit
+{
+	/// Hit distance, along the ray direction.
+	Scalar t[N];
+	/// Barycentrics of the hit, the point is (1-u-v)*v0 + u*v1 + v*v2.
+	Scalar u[N], v[N];
+	/// Id of the primitive that was hit, or -1.
+	int prim[N];
+
+	/// Clear the hits, so any hit within the ray's range will be accepted.
+	inline void Reset(const RayPacket<N> &rays)
+	{
+		for (int i = 0; i < N; ++i)
+		{
+			t[i] = rays.tMax[i];
+			u[i] = 0;
+			v[i] = 0;
+			prim[i] = -1;
+		}
+	}
+};
+
+/// Intersect one ray with a triangle. Returns true on a hit in (\p tmin, \p tmax), and the
+/// distance \p t and barycentrics \p u, \p v of the hit. Triangles are double sided.
+bool IntersectTriangle(const Vec4 &origin, const Vec4 &dir,
+	const Vec4 &v0, const Vec4 &v1, const Vec4 &v2,
+	Scalar &t, Scalar &u, Scalar &v,
+	Scalar tmin = 0, Scalar tmax = std::numeric_limits<Scalar>::max());
+
+/// Intersect one ray with an axis aligned box. Returns true on overlap of the ray's range
+/// [\p tmin, \p tmax] with the box, and the entry and exit distances.
+bool IntersectBox(const Vec4 &origin, const Vec4 &dir,
+	const Vec4 &boxMin, const Vec4 &boxMax,
+	Scalar &tNear, Scalar &tFar,
+	Scalar tmin = 0, Scalar tmax = std::numeric_limits<Scalar>::max());
+
+/// Intersect a packet of rays with one triangle. Lanes that hit closer than their current
+/// \p hit are updated, with \p prim as their primitive id. Returns the mask of updated lanes.
+template <int N>
+unsigned int IntersectTriangle(const RayPacket<N> &rays,
+	const Vec4 &v0, const Vec4 &v1, const Vec4 &v2,
+	PacketHit<N> &hit, int prim = 0);
+
+/// Intersect a packet of rays with a triangle soup, 3 consecutive vertices per triangle, and
+/// the triangle index as the primitive id. Returns the mask of lanes that hit anything.
+template <int N>
+unsigned int IntersectTriangles(const RayPacket<N> &rays,
+	const Vec4 *verts, int triCount,
+	PacketHit<N> &hit);
+
+/// Intersect a packet of rays with an axis aligned box. Writes the entry distance for each
+/// lane to \p tNear, and returns the mask of lanes that overlap the box in their range.
+template <int N>
+unsigned int IntersectBox(const RayPacket<N> &rays,
+	const Vec4 &boxMin, const Vec4 &boxMax,
+	Scalar tNear[N]);
+
+typedef RayPacket<4> RayPacket4;
+typedef RayPacket<8> RayPacket8;
+typedef RayPacket<16> RayPacket16;
+
+typedef PacketHit<4> PacketHit4;
+typedef PacketHit<8> PacketHit8;
+typedef PacketHit<16> PacketHit16;
+
+}  // namespace mathing
+
+#endif  // MATHING_INTERSECT_H
@@ -57,15 +57,18 @@
 */
 
 // TODO:
-// * Support shear, reflection, and projection
-// * Orthonormalize
+// * Support shear and reflection
 // * Remember tricks like, if you have a shear matrix you can still rotate vectors but you have to do
 //   extra work, like 
 
 
+#include <stddef.h>
+
 #include <iostream>
 
+#include "instrument.h"
 #include "quaternion.h"
+#include "vec3.h"
 #include "vector.h"
 
 #include "impl/matrix_impl.h"
@@ -95,6 +98,18 @@
 namespace mathing
 {
 
+/// Outcodes of Matrix::ToClip(), a bit for each clip plane a point is outside of.
+enum ClipOutcode
+{
+	CLIP_LEFT = 0x01,     ///< x < -w
+	CLIP_RIGHT = 0x02,    ///< x > w
+	CLIP_BOTTOM = 0x04,   ///< y < -w
+	CLIP_TOP = 0x08,      ///< y > w
+	CLIP_NEAR = 0x10,     ///< z < 0
+	CLIP_FAR = 0x20,      ///< z > w
+	CLIP_ALL = 0x3f
+};
+
 // The goal of this class is to provide the front end API as a completely transparent
 // wrapper around an implementaiton. The default implementation is provided as
 // a simple c++ implementation.
@@ -129,6 +144,25 @@ public:
 	/// Sets the matrix from an orientation Quaternion and a position vector.
 	inline void Set(const Quaternion &q, const Vec4 &pv) { _impl.Set(q, pv); }
 
+	/// Sets the matrix to be at \p eye, with the Z axis pointing at \p target and the Y axis as
+	/// close to \p up as it can be. There's no trig in it, and it can't fail, see
+	/// MatrixCppImpl4x4::SetLookAt() for what happens with degenerate vectors.
+	inline void SetLookAt(const Vec4 &eye, const Vec4 &target, const Vec4 &up = Vec4::m_UnitY) {
+		_impl.SetLookAt(eye, target, up);
+	}
+	/// Sets the matrix to a perspective projection, \p fovY radians from the bottom to the top,
+	/// with \p aspect as width over height. It's for view space looking down +Z, the inverse of
+	/// a SetLookAt() matrix, and puts the \p zNear plane at depth 0 and \p zFar at 1, with the
+	/// view z in w. It isn't rigid, so use Project() or ToClip() with it, not Transform().
+	inline void SetPerspective(Scalar fovY, Scalar aspect, Scalar zNear, Scalar zFar) {
+		_impl.SetPerspective(fovY, aspect, zNear, zFar);
+	}
+	/// Sets the matrix to an orthographic projection of the view space box, to -1..1 in x and y
+	/// and 0..1 in depth, like SetPerspective().
+	inline void SetOrthographic(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar zNear, Scalar zFar) {
+		_impl.SetOrthographic(left, right, bottom, top, zNear, zFar);
+	}
+
 	inline Vec4 &AxisX() const { return _impl.AxisX(); }
 	inline Vec4 &AxisY() const { return _impl.AxisY(); }
 	inline Vec4 &AxisZ() const { return _impl.AxisZ(); }
@@ -145,18 +179,46 @@ public:
 
 	/// Applies the rhs transformation to the current matrix, stores the result in the current matrix,
 	/// and returns the address.
-	inline Matrix &operator*=(const Matrix &rhs) { _impl *= rhs._impl; return *this; }
+	inline Matrix &operator*=(const Matrix &rhs) {
+		MATHING_INSTRUMENT_SCOPE(INSTRUMENT_MATRIX_MULTIPLY);
+		_impl *= rhs._impl;
+		return *this;
+	}
 
 	/// Transforms the current matrix by another and return the the resulting matrix.
-	inline Matrix operator*(const Matrix &rhs) const { return Matrix(_impl * rhs._impl); }
+	inline Matrix operator*(const Matrix &rhs) const {
+		MATHING_INSTRUMENT_SCOPE(INSTRUMENT_MATRIX_MULTIPLY);
+		return Matrix(_impl * rhs._impl);
+	}
 
 	/// <x,y,z,1> * Matrix, transforms the point by the matrix, and returns the resulting point
 	/// This is a convenience similar to the multiplication, but ignores the w of the vec4, and assumes 1.
-	inline Vec4 Transform(const Vec4 &rhs) const { return _impl.Transform(rhs); }
+	inline Vec4 Transform(const Vec4 &rhs) const {
+		MATHING_INSTRUMENT_SCOPE(INSTRUMENT_MATRIX_TRANSFORM);
+		return _impl.Transform(rhs);
+	}
 	/// <x,y,z,0> * Matrix, transforms the vector, does not apply translation
 	/// This is a convenience similar to the multiplication, but ignores the w of the vec4, and assumes 0.
 	inline Vec4 Rotate(const Vec4 &v) const { return _impl.Rotate(v); }
 
+	/// Transforms \p count packed points (as if w is 1) into \p out, which can be \p in. The math is
+	/// done in Scalar, there's no Vec4 in between.
+	void Transform(const Vec3f *in, Vec3f *out, size_t count) const;
+	void Transform(const Vec3d *in, Vec3d *out, size_t count) const;
+	/// <x,y,z,1> * Matrix with the w column too, so a projection comes out in clip space.
+	inline Vec4 Project(const Vec4 &rhs) const {
+		return _impl.Project(rhs);
+	}
+	/// Projects \p count points (as if w is 1) to clip space, and in the same pass divides by w
+	/// into \p out, which can be \p in, as x/w, y/w, z/w and 1/w. Points with w <= 0, behind the
+	/// eye, can't be divided and keep their clip coordinates. \p outcodes gets the ClipOutcode bits
+	/// for every point, and the return is all of them and-ed together, so if it's not 0 every
+	/// point is outside the same plane.
+	unsigned ToClip(const Vec4 *in, Vec4 *out, unsigned char *outcodes, size_t count) const;
+	/// Rotates \p count packed directions (as if w is 0) into \p out, which can be \p in.
+	void Rotate(const Vec3f *in, Vec3f *out, size_t count) const;
+	void Rotate(const Vec3d *in, Vec3d *out, size_t count) const;
+
 	/// Convert handedness.
 	/// For example if using right-hand and expecting X to the right, Y up, and Z would be towards you,
 	/// then to convert to left hand, we'll invert Z. This negates all z components of all axies,
@@ -166,6 +228,36 @@ public:
 	/// The transformation matrix that undoes this transformation.
 	Matrix Inverse() const;
 
+	/// How far the axes are from orthonormal, the most any of them is off unit length squared,
+	/// or any two of them are off perpendicular (as a dot product). Inverse() is only right for
+	/// orthonormal axes, so this says when a matrix needs orthonormalizing.
+	Scalar OrthonormalDrift() const;
+	/// True if OrthonormalDrift() is over \p epsilon.
+	inline bool IsDrifted(Scalar epsilon = m_DriftEpsilon) const { return OrthonormalDrift() > epsilon; }
+	/// Makes the axes orthonormal by Gram-Schmidt: X is normalized, Y is made perpendicular to X and
+	/// normalized, and Z is X cross Y. X keeps its direction, so the error all goes to Y and Z. The
+	/// axes have to be independent. The position is left alone.
+	void OrthonormalizeGramSchmidt();
+	/// Makes the axes the closest orthonormal axes to what they are, by polar decomposition, so
+	/// the error is spread over all of them. Reflections stay reflections. Falls back to
+	/// OrthonormalizeGramSchmidt() if the axes are nearly dependent.
+	void OrthonormalizePolar();
+	/// OrthonormalizeGramSchmidt() the \p count matrices that are drifted over \p epsilon, and
+	/// returns how many that was.
+	static size_t OrthonormalizeGramSchmidt(Matrix *m, size_t count, Scalar epsilon = m_DriftEpsilon);
+	/// OrthonormalizePolar() the \p count matrices that are drifted over \p epsilon, and returns
+	/// how many that was.
+	static size_t OrthonormalizePolar(Matrix *m, size_t count, Scalar epsilon = m_DriftEpsilon);
+
+	/// Splits the matrix into a unit \p rotation, a \p scale along each of the rotated axes (in x,
+	/// y, z, with w 0), and the \p position, so the matrix is the axes of the rotation each scaled,
+	/// at the position. Any shear goes into the rotation the way polar decomposition does it. A
+	/// reflection comes out as a negative z scale. Returns false, with no rotation, if the axes
+	/// are nearly dependent.
+	bool Decompose(Quaternion &rotation, Vec4 &scale, Vec4 &position) const;
+	/// Decompose() \p count matrices, and returns how many of them could be.
+	static size_t Decompose(const Matrix *m, Quaternion *rotation, Vec4 *scale, Vec4 *position, size_t count);
+
 	/// Swap the rows and columns (used to get access to a column major version)
 	Matrix Transpose() const;
 
@@ -175,9 +267,38 @@ public:
 	/// Vec4's with a 0 in the w are like directions that get transformed.
 	friend Vec4 operator*(const Vec4 &lhs, const Matrix &rhs);
 
+	/// The matrix at \p eye looking at \p target, see SetLookAt().
+	static Matrix LookAt(const Vec4 &eye, const Vec4 &target, const Vec4 &up = Vec4::m_UnitY) {
+		Matrix ret;
+		ret.SetLookAt(eye, target, up);
+		return ret;
+	}
+	/// SetLookAt() for \p count matrices, each from an eye and a target, and the same \p up.
+	static void LookAt(const Vec4 *eyes, const Vec4 *targets, const Vec4 &up, Matrix *out, size_t count);
+	/// The view matrix of a camera at \p eye looking at \p target, the inverse of LookAt(), which
+	/// takes world space to the view space the projections are for.
+	static Matrix View(const Vec4 &eye, const Vec4 &target, const Vec4 &up = Vec4::m_UnitY) {
+		return LookAt(eye, target, up).Inverse();
+	}
+	/// The projection of SetPerspective().
+	static Matrix Perspective(Scalar fovY, Scalar aspect, Scalar zNear, Scalar zFar) {
+		Matrix ret;
+		ret.SetPerspective(fovY, aspect, zNear, zFar);
+		return ret;
+	}
+	/// The projection of SetOrthographic().
+	static Matrix Orthographic(Scalar left, Scalar right, Scalar bottom, Scalar top, Scalar zNear, Scalar zFar) {
+		Matrix ret;
+		ret.SetOrthographic(left, right, bottom, top, zNear, zFar);
+		return ret;
+	}
+
 	// TODO: Compare return by value here completely inline vs
 	// return by address of a static wrapped ident.
 	static const Matrix Identity() { return Matrix(MatrixCppImpl4x4::m_Identity); }
+
+	/// OrthonormalDrift() past which a matrix is drifted, by default.
+	static const Scalar m_DriftEpsilon;
 };
 
 //typedef Matrix<MatrixCppImpl4x4> Matrix;
@@ -0,0 +1,47 @@
+#ifndef MATHING_OBB_H
+#define MATHING_OBB_H
+
+/** Overlap tests for oriented boxes, with the separating axis test.
+
+	A box is a rigid Matrix, with its axes as the box axes and Pos() as the center, plus half
+	extents along each axis. The tests work straight from the rows of the matrices, there's no
+	need for the relative transform (no Inverse(), or operator*).
+
+	The batch versions run the 15 axes over a block of pairs at once, and the block skips the
+	9 edge axes when the 6 face axes have already separated all of its pairs, which is the
+	usual case for broad phase pairs.
+
+	\sa Matrix,
+		ShapeQuery
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// Returns true if the box posed by \p poseA with half extents \p halfA overlaps box B.
+bool ObbOverlap(const Matrix &poseA, const Vec4 &halfA, const Matrix &poseB, const Vec4 &halfB);
+
+/// Returns true if the box overlaps the sphere.
+bool ObbSphereOverlap(const Matrix &pose, const Vec4 &half, const Vec4 &center, Scalar radius);
+
+/// Box overlap for the pairs of boxes \p pairs[2*i] and \p pairs[2*i + 1], which index into
+/// \p poses and \p halfExtents. Writes the result of each pair to \p overlaps, and returns the
+/// number of overlapping pairs.
+size_t ObbOverlap(const Matrix *poses, const Vec4 *halfExtents,
+	const uint32_t *pairs, size_t pairCount, bool *overlaps);
+
+/// Box vs sphere for \p count boxes and spheres, one to one.
+/// Writes the result of each to \p overlaps, and returns the number that overlap.
+size_t ObbSphereOverlap(const Matrix *poses, const Vec4 *halfExtents,
+	const Vec4 *centers, const Scalar *radii, size_t count, bool *overlaps);
+
+}  // namespace mathing
+
+#endif  // MATHING_OBB_H
@@ -0,0 +1,76 @@
+#ifndef MATHING_POINT_STREAM_H
+#define MATHING_POINT_STREAM_H
+
+/** Transforming point files of any size, a chunk at a time.
+
+	A point file is nothing but packed points, Vec3f or Vec3d, one after another. A
+	PointTransformer streams one through a Matrix into another file: read a chunk, convert it
+	to the output type, transform it, and write it. Only a couple of chunks are in memory at a
+	time, however big the file is.
+
+	Reading overlaps with the rest. From a FILE, a reader thread that lasts the whole run reads
+	the next chunk into the other of two buffers while the current one is transformed and
+	written. From a mapped file, the next chunk is asked for ahead of time with madvise(), and
+	the pages of chunks that are done are let go, so the mapping doesn't build up either.
+
+	For a rotation and translation, give it Matrix(rotation, translation).
+
+	\sa Vec3f,
+		Matrix::Transform(const Vec3f *, Vec3f *, size_t) const
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "matrix.h"
+
+#define POINT_STREAM_CHUNK 65536     // points per chunk by default
+
+namespace mathing
+{
+
+class PointTransformer
+{
+public:
+	enum Type
+	{
+		/// Vec3f, 12 bytes a point.
+		FLOAT32,
+		/// Vec3d, 24 bytes a point.
+		FLOAT64
+	};
+
+	PointTransformer(const Matrix &transform, Type inType = FLOAT32, Type outType = FLOAT32,
+		size_t chunkPoints = POINT_STREAM_CHUNK);
+
+	/// Transforms every point from \p in to \p out. Returns false if reading or writing fails, or
+	/// \p in ends part way through a point.
+	bool Run(FILE *in, FILE *out);
+	/// Run() from the file at \p inPath, mapped into memory where there's mmap(), or read like a
+	/// FILE where there isn't.
+	bool RunMapped(const char *inPath, FILE *out);
+
+	/// Points transformed by the last run.
+	inline size_t PointCount() const { return m_PointCount; }
+
+	/// Bytes a point of \p type takes.
+	static inline size_t PointBytes(Type type) { return type == FLOAT64 ? 24 : 12; }
+
+private:
+	// Converts, transforms and writes \p count points starting at \p in.
+	bool Process(const char *in, size_t count, FILE *out);
+
+	Matrix m_Transform;
+	Type m_InType;
+	Type m_OutType;
+	size_t m_ChunkPoints;
+	size_t m_PointCount;
+	// A chunk of transformed points on their way out
+	std::vector<char> m_Out;
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_POINT_STREAM_H
@@ -0,0 +1,87 @@
+#ifndef MATHING_QUANTIZE_H
+#define MATHING_QUANTIZE_H
+
+/** Small storage formats for Vec4 and Quaternion, for caching, files and the network.
+
+	Vec4 and Quaternion are 32 bytes each, which is right for doing math and a lot for
+	keeping or sending. These trade precision for size, and each comes with a batch encode
+	from, and decode to, the full types:
+
+	- Half4, 8 bytes, all 4 components as IEEE half floats, good to about 3 decimal digits
+	  over +-65504. Out of range goes to infinity.
+	- OctNormal, 4 bytes, a unit direction folded onto an octahedron and unfolded into a
+	  square, as 2 snorm16. Good to about 0.003 degrees. Decodes to unit length.
+	- SnormQuaternion, 8 bytes, a unit quaternion as 4 snorm16, good to about 1/32767 per
+	  component. Decodes to unit length.
+	- FixedPosition, 6 bytes, a point as 3 unorm16 fractions of a bounding box, so the
+	  precision is the size of the box over 65535. Points outside the box are clamped to it.
+
+	The same box has to be given to decode a FixedPosition as encoded it. Half4 keeps w, and
+	the others decode with w of 0 for an OctNormal and 1 for a FixedPosition.
+
+	\sa Vec3f
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// 4 half floats.
+struct Half4
+{
+	uint16_t x, y, z, w;
+};
+
+/// A unit direction in octahedral mapping, as 2 snorm16.
+struct OctNormal
+{
+	int16_t x, y;
+};
+
+/// A unit quaternion as 4 snorm16.
+struct SnormQuaternion
+{
+	int16_t x, y, z, w;
+};
+
+/// A point as 3 unorm16 fractions of a bounding box.
+struct FixedPosition
+{
+	uint16_t x, y, z;
+};
+
+/// \p f as the nearest half float, rounding to even.
+uint16_t FloatToHalf(float f);
+/// Half float \p h as a float, which is exact.
+float HalfToFloat(uint16_t h);
+
+/// Encodes \p count Vec4 as Half4.
+void EncodeHalf4(const Vec4 *in, Half4 *out, size_t count);
+/// Decodes \p count Half4 to Vec4.
+void DecodeHalf4(const Half4 *in, Vec4 *out, size_t count);
+
+/// Encodes \p count directions, which should be unit length, as OctNormal. A zero direction
+/// encodes as +Z.
+void EncodeOctNormal(const Vec4 *in, OctNormal *out, size_t count);
+/// Decodes \p count OctNormal to unit directions.
+void DecodeOctNormal(const OctNormal *in, Vec4 *out, size_t count);
+
+/// Encodes \p count unit quaternions as SnormQuaternion.
+void EncodeSnormQuaternion(const Quaternion *in, SnormQuaternion *out, size_t count);
+/// Decodes \p count SnormQuaternion to unit quaternions.
+void DecodeSnormQuaternion(const SnormQuaternion *in, Quaternion *out, size_t count);
+
+/// Encodes \p count points as fractions of the box from \p boxMin to \p boxMax.
+void EncodeFixedPosition(const Vec4 *in, FixedPosition *out, size_t count, const Vec4 &boxMin, const Vec4 &boxMax);
+/// Decodes \p count points in the box from \p boxMin to \p boxMax.
+void DecodeFixedPosition(const FixedPosition *in, Vec4 *out, size_t count, const Vec4 &boxMin, const Vec4 &boxMax);
+
+}  // namespace mathing
+
+#endif  // MATHING_QUANTIZE_H
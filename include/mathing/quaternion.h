@@ -1,6 +1,8 @@
 #ifndef MATHING_QUATERNION_H
 #define MATHING_QUATERNION_H
 
+#include <stddef.h>
+
 #include <iostream>
 
 #include "scalar.h"
@@ -10,12 +12,14 @@ namespace mathing
 {
 
 class Matrix;
+class Vec4;
 
 /// Stores a 3D rotation, free of gimbal lock
 /// Mathematical structure that you shouldn't even try to visualize. These are
 /// good for interpolating between two rotations and applying successive
 /// rotations.
-class Quaternion
+/// Aligned to MATHING_ALIGN, like Vec4.
+class alignas(MATHING_ALIGN) Quaternion
 {
 public:
 	Scalar x, y, z, w;
@@ -35,13 +39,36 @@ public:
 	void FromMatrix(const Matrix &mat);
 	/// Set to \p x,\p y,\p z,\p w
 	void FromAxisAndAngle(Scalar x, Scalar y, Scalar z, Scalar theta);
+	/// Set to the shortest rotation that turns the direction \p from to the direction \p to.
+	/// Neither has to be unit length. Opposite directions turn half way around an axis
+	/// perpendicular to \p from, and a zero length direction gives no rotation.
+	void FromTo(const Vec4 &from, const Vec4 &to);
+	/// FromTo() for \p count pairs of directions.
+	static void FromTo(const Vec4 *from, const Vec4 *to, Quaternion *out, size_t count);
 	/// Set from Euler angles \p yaw, \p pitch, and \p roll
 	void FromEuler(Scalar yaw, Scalar pitch, Scalar roll);
 	/// Get the Euler angles from the quaternion
 	void GetEuler(Scalar &yaw, Scalar &pitch, Scalar &roll);
+	/// Scale to unit length, which is what every rotation here expects. Returns the length before.
+	Scalar Normalize();
+	/// Normalize() with a hardware reciprocal square root estimate and one Newton step, see
+	/// Vec4::Normalize3Fast(). The length comes out within 2.1e-7 of 1.
+	Scalar NormalizeFast();
+	/// Normalize() \p count quaternions in place.
+	static void Normalize(Quaternion *q, size_t count);
+	/// NormalizeFast() \p count quaternions in place.
+	static void NormalizeFast(Quaternion *q, size_t count);
 	/// Assign to the value of another quaternion
 	Quaternion &operator=(const Quaternion &q);
 
+	/// Return \p v rotated by this unit quaternion, the same as Matrix(q).Rotate(v) but without
+	/// filling a matrix. The w of \p v is kept.
+	Vec4 Rotate(const Vec4 &v) const;
+	/// Rotate() \p count vectors by this quaternion. \p out can be \p v.
+	void Rotate(const Vec4 *v, Vec4 *out, size_t count) const;
+	/// Rotate() each of \p count vectors by its own quaternion. \p out can be \p v.
+	static void Rotate(const Quaternion *q, const Vec4 *v, Vec4 *out, size_t count);
+
 	/// Rotate this quaternion by another
 	Quaternion &operator*=(const Quaternion &q);
 	/// Return the rotation of this quaternion then another, \p q
@@ -53,6 +80,8 @@ public:
 	static Quaternion Slerp(const Quaternion &from, const Quaternion &to, Scalar t);
 	/// Linearly interpolates between two UNIT quaternions
 	static Quaternion Lerp(const Quaternion &from, const Quaternion &to, Scalar t);
+	/// Lerp(), renormalized with NormalizeFast(), so it's a unit quaternion again
+	static Quaternion Nlerp(const Quaternion &from, const Quaternion &to, Scalar t);
 };
 
 std::ostream &operator<<(std::ostream &os, const Quaternion &q);
@@ -0,0 +1,89 @@
+#ifndef MATHING_REGISTRATION_H
+#define MATHING_REGISTRATION_H
+
+/** Best fit rigid transform between corresponding point sets.
+
+	Given pairs of points, source[i] and target[i], and optionally a weight for each, this finds
+	the rotation and translation that take the sources closest to the targets, in the least
+	squares sense. The rotation comes straight out as a Quaternion, the eigenvector of the
+	largest eigenvalue of Horn's 4x4 matrix made from the cross covariance, so it's always a
+	proper rotation, never a reflection.
+
+	The points only go through RegistrationSums, which accumulates the weight, the weighted
+	sums of the sources and targets, and their cross products, in a single pass. Sums of
+	different ranges of pairs can be accumulated on their own threads and Merge()d, in any
+	order, and solved once at the end, so it scales with however many cores there are.
+
+	To keep precision over millions of points, every sum is relative to a reference pair, the
+	first one added, so points far from the origin don't cancel, and pairs are summed in short
+	blocks of plain adds, which vectorize, and the blocks are added up with compensated
+	(Neumaier) summation.
+
+	\sa Quaternion,
+		Matrix
+*/
+
+#include <math.h>
+#include <stddef.h>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// A sum that carries the rounding error of every add along with it.
+struct CompensatedSum
+{
+	Scalar sum;
+	Scalar error;
+
+	CompensatedSum() : sum(0), error(0) {}
+
+	inline void Add(Scalar v)
+	{
+		Scalar t = sum + v;
+		error += fabs(sum) >= fabs(v) ? (sum - t) + v : (v - t) + sum;
+		sum = t;
+	}
+	inline Scalar Value() const { return sum + error; }
+};
+
+class RegistrationSums
+{
+public:
+	RegistrationSums();
+
+	void Clear();
+
+	/// Adds \p count pairs of points. \p weights can be NULL for all 1. Only x, y and z are used.
+	void Add(const Vec4 *source, const Vec4 *target, const Scalar *weights, size_t count);
+	/// Adds the pairs summed in \p other.
+	void Merge(const RegistrationSums &other);
+
+	/// Total weight of the pairs.
+	inline Scalar Weight() const { return m_Sum[0].Value(); }
+	/// Weighted centroids of the sources and the targets.
+	Vec4 SourceCentroid() const;
+	Vec4 TargetCentroid() const;
+
+	/// The rotation and translation that take the sources to the targets, so
+	/// target ~= rotation.Rotate(source) + translation. Returns false if there's no weight.
+	bool Solve(Quaternion &rotation, Vec4 &translation) const;
+	/// Solve() as a Matrix, so target ~= transform.Transform(source).
+	bool Solve(Matrix &transform) const;
+
+private:
+	// The reference pair everything is summed relative to, and if it's been set yet.
+	Vec4 m_SourceRef;
+	Vec4 m_TargetRef;
+	bool m_HasRef;
+	// W, the 3 sums of w s and of w t, and the 9 of w s_i t_j, all relative to the references.
+	CompensatedSum m_Sum[16];
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_REGISTRATION_H
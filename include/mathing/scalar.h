@@ -7,6 +7,10 @@ namespace mathing
 // Yes, it seems absurd now, but it will make sense when intrinsics are added.
 typedef double Scalar;
 
+// Alignment of Vec4, Quaternion and Matrix, in bytes. It's the size of 4 Scalars, so a whole
+// Vec4 or Quaternion, or a row of a Matrix, can be moved with one aligned SIMD load or store.
+#define MATHING_ALIGN (4 * sizeof(::mathing::Scalar))
+
 };
 
 #endif  // MATHING_SCALAR_H
\ No newline at end of file
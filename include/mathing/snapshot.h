@@ -0,0 +1,78 @@
+#ifndef MATHING_SNAPSHOT_H
+#define MATHING_SNAPSHOT_H
+
+/** Delta compressed snapshots of transforms, for sending over the network or recording.
+
+	A Snapshot is the rotations and positions of a set of entities, quantized: rotations as
+	snorm16 (see SnormQuaternion), and positions to a grid of the position step. Once
+	quantized, a snapshot encodes against a baseline snapshot, that the other end already has,
+	as only what changed:
+
+	- 1 bit per entity, for whether it changed at all.
+	- For one that did, 7 bits for which of the 4 rotation and 3 position components changed,
+	  a bit width for each kind, and the changed components' differences from the baseline in
+	  that many bits.
+
+	So an entity that didn't move costs a bit, and one that moved a little costs a few bytes.
+	The bytes decode against the same baseline into a Snapshot, which is exactly the one that
+	was encoded, and from there all at once into Quaternion and Vec4 arrays.
+
+	Entities past the end of the baseline are sent against an identity rotation at the origin,
+	so an empty Snapshot as the baseline sends everything. Both ends have to use the same
+	position step, it isn't in the bytes.
+
+	Everything works on byte buffers in memory, there's no I/O.
+
+	\sa SnormQuaternion
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "matrix.h"
+#include "quantize.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+#define SNAPSHOT_POSITION_STEP (1.0 / 1024)    // default grid positions are quantized to
+
+namespace mathing
+{
+
+class Snapshot
+{
+public:
+	/// An empty snapshot, with positions quantized to multiples of \p positionStep.
+	explicit Snapshot(Scalar positionStep = SNAPSHOT_POSITION_STEP);
+
+	inline size_t Count() const { return m_Rotations.size(); }
+	inline Scalar PositionStep() const { return m_PositionStep; }
+
+	/// Quantizes \p count entities. Rotations are unit quaternions, and their sign doesn't matter.
+	void Set(const Quaternion *rotations, const Vec4 *positions, size_t count);
+	/// Quantizes \p count entities, from the rotation and position of orthonormal matrices.
+	void Set(const Matrix *transforms, size_t count);
+	/// Decodes every entity, with unit rotations and positions with w of 1.
+	void Get(Quaternion *rotations, Vec4 *positions) const;
+	/// Decodes every entity to a matrix.
+	void Get(Matrix *transforms) const;
+
+	/// Appends the changes from \p baseline to \p out.
+	void Encode(const Snapshot &baseline, std::vector<uint8_t> &out) const;
+	/// Replaces this with the \p size bytes at \p data, decoded against \p baseline. Returns
+	/// false, leaving this empty, if they end too soon.
+	bool Decode(const Snapshot &baseline, const uint8_t *data, size_t size);
+
+private:
+	Scalar m_PositionStep;
+	std::vector<SnormQuaternion> m_Rotations;
+	// Positions in steps, 3 per entity
+	std::vector<int32_t> m_Positions;
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_SNAPSHOT_H
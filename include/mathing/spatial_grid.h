@@ -0,0 +1,143 @@
+#ifndef MATHING_SPATIAL_GRID_H
+#define MATHING_SPATIAL_GRID_H
+
+/** Uniform grid of points, hashed into a fixed number of buckets, for neighbor queries.
+
+	It's meant to be rebuilt from scratch every frame. Build() is a counting sort: the points are
+	counted per bucket, the counts become offsets, and the points are copied into one packed array
+	in bucket order. There are no per-cell allocations, and the arrays keep their capacity from
+	one frame to the next, so a steady state rebuild doesn't allocate at all.
+
+	Different cells can share a bucket, so every packed point also keeps its cell, and the queries
+	skip the points that don't belong to the cell they're looking at.
+
+	For queries, the cell size is best at about the query radius. Larger radii still work, they
+	just visit more cells.
+
+	\sa Vec4
+*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "allocator.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+class SpatialHashGrid
+{
+public:
+	SpatialHashGrid();
+
+	/// Rebuild the grid from \p count \p positions, with cubic cells of \p cellSize.
+	/// The positions are copied, so they don't need to outlive the grid.
+	void Build(const Vec4 *positions, size_t count, Scalar cellSize);
+
+	/// Writes the indices of the points within \p radius of \p center to \p results, up to
+	/// \p maxResults of them. Returns the number of points found, which can be more than were written.
+	size_t QueryRadius(const Vec4 &center, Scalar radius, uint32_t *results, size_t maxResults) const;
+
+	/// Writes the indices of up to \p k points nearest to \p center, that are within \p maxRadius,
+	/// closest first, and their squared distances to \p distSqr. Returns how many were found.
+	size_t QueryKNearest(const Vec4 &center, size_t k, uint32_t *results, Scalar *distSqr,
+		Scalar maxRadius = HUGE_VAL) const;
+
+	/// Calls visit(i, j, distSqr) once for every pair of points closer than \p radius, with i < j.
+	/// Only the points in the buckets [\p bucketBegin, \p bucketEnd) are visited as the first point
+	/// of the pairs, so splitting BucketCount() into ranges, each on its own thread with its own
+	/// visitor, visits every pair exactly once.
+	template <typename Visitor>
+	void ForEachPair(Scalar radius, Visitor &visit, size_t bucketBegin = 0, size_t bucketEnd = (size_t)-1) const;
+
+	/// Number of points in the grid.
+	inline size_t Count() const { return m_Points.size(); }
+	/// Number of hash buckets, the grid is split by bucket for ForEachPair.
+	inline size_t BucketCount() const { return m_BucketStart.empty() ? 0 : m_BucketStart.size() - 1; }
+	inline Scalar CellSize() const { return m_CellSize; }
+
+private:
+	struct Cell
+	{
+		int32_t x, y, z;
+		inline bool operator==(const Cell &c) const { return x == c.x && y == c.y && z == c.z; }
+	};
+
+	inline Cell CellOf(Scalar x, Scalar y, Scalar z) const
+	{
+		Cell c;
+		c.x = (int32_t)floor(x * m_InvCellSize);
+		c.y = (int32_t)floor(y * m_InvCellSize);
+		c.z = (int32_t)floor(z * m_InvCellSize);
+		return c;
+	}
+
+	inline uint32_t Bucket(const Cell &c) const
+	{
+		return ((uint32_t)c.x * 73856093u ^ (uint32_t)c.y * 19349663u ^ (uint32_t)c.z * 83492791u) & m_BucketMask;
+	}
+
+	Scalar m_CellSize;
+	Scalar m_InvCellSize;
+	uint32_t m_BucketMask;
+
+	/// Offsets into the packed arrays for every bucket, plus one at the end.
+	std::vector<uint32_t> m_BucketStart;
+	/// Packed in bucket order. Original index, position and cell of every point.
+	std::vector<uint32_t> m_Indices;
+	AlignedVector<Vec4> m_Points;
+	std::vector<Cell> m_Cells;
+	/// Range of the occupied cells, bounds the k-nearest search.
+	Cell m_CellMin, m_CellMax;
+
+	/// Per point scratch for Build().
+	std::vector<uint32_t> m_Scratch;
+};
+
+template <typename Visitor>
+void SpatialHashGrid::ForEachPair(Scalar radius, Visitor &visit, size_t bucketBegin, size_t bucketEnd) const
+{
+	if (bucketEnd > BucketCount())
+		bucketEnd = BucketCount();
+	Scalar radiusSqr = radius * radius;
+	int32_t reach = (int32_t)ceil(radius * m_InvCellSize);
+
+	for (size_t b = bucketBegin; b < bucketEnd; ++b)
+	{
+		for (uint32_t p = m_BucketStart[b]; p < m_BucketStart[b + 1]; ++p)
+		{
+			const Vec4 &pos = m_Points[p];
+			const Cell &home = m_Cells[p];
+			uint32_t i = m_Indices[p];
+
+			Cell c;
+			for (c.z = home.z - reach; c.z <= home.z + reach; ++c.z)
+			for (c.y = home.y - reach; c.y <= home.y + reach; ++c.y)
+			for (c.x = home.x - reach; c.x <= home.x + reach; ++c.x)
+			{
+				uint32_t nb = Bucket(c);
+				for (uint32_t q = m_BucketStart[nb]; q < m_BucketStart[nb + 1]; ++q)
+				{
+					uint32_t j = m_Indices[q];
+					if (j <= i || !(m_Cells[q] == c))
+						continue;
+					Scalar dx = m_Points[q].x - pos.x;
+					Scalar dy = m_Points[q].y - pos.y;
+					Scalar dz = m_Points[q].z - pos.z;
+					Scalar distSqr = dx*dx + dy*dy + dz*dz;
+					if (distSqr < radiusSqr)
+						visit(i, j, distSqr);
+				}
+			}
+		}
+	}
+}
+
+}  // namespace mathing
+
+#endif  // MATHING_SPATIAL_GRID_H
@@ -0,0 +1,127 @@
+#ifndef MATHING_SPATIAL_SORT_H
+#define MATHING_SPATIAL_SORT_H
+
+/** Spatial ordering for arrays of points.
+
+	Points are quantized into a grid over the given bounds, and given a key along a space
+	filling curve (Morton / Z-order, or Hilbert). Sorting by the key puts points that are close
+	in space close in memory, which makes later passes over them cache friendly.
+
+	The 30-bit keys use 10 bits per axis, the 63-bit keys use 21 bits per axis. Points outside
+	the bounds are clamped to the edge cells.
+
+	The sort doesn't move the points, it returns a permutation, so any number of companion
+	arrays can be reordered the same way with ApplyPermutation().
+
+	The key functions are independent per point, so large arrays can be split into ranges and
+	computed on as many threads as are available. Sorting can't be split that simply, since
+	every key can end up anywhere, so ParallelKeySort breaks each radix pass into steps that
+	are each split by range, with a short step on one thread between them.
+
+	\sa Vec4
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// Morton (Z-order) keys, 10 bits per axis. x is the lowest bit of each triple.
+void MortonKeys30(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint32_t *keys);
+
+/// Morton (Z-order) keys, 21 bits per axis. x is the lowest bit of each triple.
+void MortonKeys63(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint64_t *keys);
+
+/// Hilbert curve keys, 10 bits per axis. Better locality than Morton, consecutive keys are
+/// always neighboring cells, but it's more expensive to compute.
+void HilbertKeys30(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint32_t *keys);
+
+/// Hilbert curve keys, 21 bits per axis.
+void HilbertKeys63(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint64_t *keys);
+
+/// Sorts the \p keys in place (LSD radix sort, stable), and writes the permutation to \p perm,
+/// where perm[i] is the original index of the i-th sorted key.
+void SortKeys(uint32_t *keys, size_t count, uint32_t *perm);
+void SortKeys(uint64_t *keys, size_t count, uint32_t *perm);
+
+/// The radix sort of SortKeys(), split so it can run on several threads. The keys are cut into
+/// equal ranges, and every pass counts the digits of each range, works out where each range's
+/// keys go, and moves them. Only working out where they go is on one thread:
+///
+///		sorter.Begin(keys, count, perm, ranges);
+///		for (int pass = 0; pass < sorter.PassCount(); ++pass)
+///		{
+///			sorter.Count(pass, range);      // every range, on any threads
+///			sorter.Offsets(pass);           // once all the ranges are counted
+///			sorter.Scatter(pass, range);    // every range, on any threads
+///		}
+///		sorter.Finish(range);               // every range, once all the ranges are scattered
+///
+/// The keys and permutation come out the same as from SortKeys().
+template <typename Key>
+class ParallelKeySort
+{
+public:
+	ParallelKeySort();
+
+	/// Sets up to sort \p count \p keys, in \p ranges ranges, into \p perm like SortKeys().
+	void Begin(Key *keys, size_t count, uint32_t *perm, size_t ranges);
+
+	inline int PassCount() const { return (int)sizeof(Key); }
+	inline size_t RangeCount() const { return m_Ranges; }
+
+	/// Counts the digits of \p pass in \p range.
+	void Count(int pass, size_t range);
+	/// Turns the counts of every range into where each range's keys go, or skips the pass if
+	/// every key has the same digit.
+	void Offsets(int pass);
+	/// Moves the keys of \p range to where they go for \p pass.
+	void Scatter(int pass, size_t range);
+	/// Copies \p range of the sorted keys and permutation back, if they ended in the scratch.
+	void Finish(size_t range);
+
+private:
+	inline void RangeOf(size_t range, size_t &begin, size_t &end) const;
+
+	Key *m_Keys;
+	uint32_t *m_Perm;
+	size_t m_Count;
+	size_t m_Ranges;
+	std::vector<Key> m_KeyScratch;
+	std::vector<uint32_t> m_PermScratch;
+	// Where the next pass reads from, and where the pass being scattered goes from and to
+	Key *m_SrcKeys, *m_FromKeys, *m_ToKeys;
+	uint32_t *m_SrcPerm, *m_FromPerm, *m_ToPerm;
+	// 256 digit counts per range, turned into offsets by Offsets()
+	std::vector<size_t> m_Hist;
+	bool m_Skip;
+};
+
+/// Convenience for the whole thing: writes the permutation that sorts \p points along the
+/// Hilbert curve (or Morton if \p hilbert is false), using 30-bit keys.
+void SpatialSort(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint32_t *perm, bool hilbert = true);
+
+/// out[i] = in[perm[i]]. \p in and \p out must not overlap.
+template <typename T>
+inline void ApplyPermutation(const T *in, const uint32_t *perm, size_t count, T *out)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i] = in[perm[i]];
+	}
+}
+
+}  // namespace mathing
+
+#endif  // MATHING_SPATIAL_SORT_H
@@ -0,0 +1,102 @@
+#ifndef MATHING_SPLINE_H
+#define MATHING_SPLINE_H
+
+/** Cubic spline paths over Vec4, SQUAD over Quaternion, and arc length reparameterization.
+
+	A Spline is a chain of cubic segments, which can be given as Catmull-Rom points, Hermite
+	points and tangents, or Bezier control points. They all turn into the same polynomial
+	coefficients per segment when they are set, so evaluating is a few multiply adds per
+	component, whatever kind of curve it started as.
+
+	The parameter u runs from 0 at the start to SegmentCount() at the end, each segment taking
+	one unit. Equal steps in u aren't equal steps along the curve, so for constant speed
+	BuildArcLength() makes a table of u at equal distances along the curve, once, and after that
+	looking up the u for a distance is a lerp between two entries.
+
+	A QuaternionSpline goes through a set of rotations with SQUAD, which is smooth through every
+	rotation. It takes the same u as a Spline, so a path can be given rotations that follow it
+	at constant speed with ParamAtDistance().
+
+	Everything that evaluates is const, so paths can be shared across threads.
+
+	\sa Vec4::Lerp,
+		Quaternion::Slerp
+*/
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "allocator.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+class Spline
+{
+public:
+	Spline();
+
+	/// Goes through every one of \p count points, with the tangent at each point from its
+	/// neighbors. The end points are mirrored for tangents at the ends.
+	void SetCatmullRom(const Vec4 *points, size_t count);
+	/// \p count pairs of a point and the tangent at it, in \p points[2*i] and \p points[2*i + 1].
+	void SetHermite(const Vec4 *points, size_t count);
+	/// Cubic Bezier segments, \p count points as point, control, control, point, control, ..., so
+	/// 3 per segment plus the last point.
+	void SetBezier(const Vec4 *points, size_t count);
+
+	inline size_t SegmentCount() const { return m_Coeff.size() / 4; }
+
+	/// The point at \p u, clamped to [0, SegmentCount()].
+	Vec4 Evaluate(Scalar u) const;
+	/// Evaluate() for \p count parameters.
+	void Evaluate(const Scalar *u, Vec4 *out, size_t count) const;
+
+	/// Measures the curve with \p samplesPerSegment straight lines per segment, and makes the
+	/// table for ParamAtDistance(). Has to be called again if the curve is set again.
+	void BuildArcLength(size_t samplesPerSegment = 16);
+	/// Length of the curve, as measured by BuildArcLength().
+	inline Scalar Length() const { return m_Length; }
+	/// The parameter \p distance along the curve from the start, clamped to [0, Length()].
+	Scalar ParamAtDistance(Scalar distance) const;
+	/// The points \p distances along the curve, for \p count distances.
+	void EvaluateAtDistance(const Scalar *distances, Vec4 *out, size_t count) const;
+
+private:
+	// Picks the segment for u, and sets t to how far along it is.
+	inline const Vec4 *Segment(Scalar u, Scalar &t) const;
+
+	// Per segment, the coefficients a, b, c, d of ((a t + b) t + c) t + d
+	AlignedVector<Vec4> m_Coeff;
+	// u at equal steps of distance along the curve, from 0 to m_Length
+	std::vector<Scalar> m_ArcParam;
+	Scalar m_Length;
+};
+
+class QuaternionSpline
+{
+public:
+	/// Goes through every one of \p count rotations. Their signs are made to agree, so each is
+	/// the short way around from the one before.
+	void Set(const Quaternion *rotations, size_t count);
+
+	inline size_t SegmentCount() const { return m_Rotation.size() > 1 ? m_Rotation.size() - 1 : 0; }
+
+	/// The rotation at \p u, clamped to [0, SegmentCount()].
+	Quaternion Evaluate(Scalar u) const;
+	/// Evaluate() for \p count parameters.
+	void Evaluate(const Scalar *u, Quaternion *out, size_t count) const;
+
+private:
+	AlignedVector<Quaternion> m_Rotation;
+	// The inner control rotation of SQUAD at every rotation
+	AlignedVector<Quaternion> m_Control;
+};
+
+}  // namespace mathing
+
+#endif  // MATHING_SPLINE_H
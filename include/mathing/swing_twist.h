@@ -0,0 +1,76 @@
+#ifndef MATHING_SWING_TWIST_H
+#define MATHING_SWING_TWIST_H
+
+/** Swing-twist decomposition of rotations, and joint limits on the two parts.
+
+	A rotation q about a twist axis (a unit vector, in the same space as the rotation) splits
+	into q = swing * twist. The twist turns about the axis and is applied first; the swing
+	turns about an axis perpendicular to it, and is what moves the axis itself.
+
+	Nothing here calls any trig function: the twist is the projection of q's vector part onto
+	the axis, normalized, and the limits are kept as the cos and sin of half angles, which is
+	what the quaternion components already are. So there are no Euler angles, and no
+	singularities near straight up like GetEuler() has.
+
+	Every joint is independent, so the batch versions can be split across threads by range.
+
+	\sa Quaternion,
+		IKChains
+*/
+
+#include <stddef.h>
+
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// Limits of a joint: a cone the swing must stay in, and a range the twist must stay in.
+/// The angles are converted once, by Set(), so clamping has no trig.
+struct SwingTwistLimit
+{
+	/// Twist axis of the joint, unit length.
+	Vec4 axis;
+	/// Cosine and sine of half the cone angle.
+	Scalar swingCos, swingSin;
+	/// Cosine and sine of half the smallest and the largest twist angles.
+	Scalar twistMinCos, twistMinSin;
+	Scalar twistMaxCos, twistMaxSin;
+
+	/// No limits about x.
+	SwingTwistLimit();
+	/// Limits the swing to \p coneAngle away from the axis, and the twist to [\p twistMin, \p twistMax],
+	/// in radians. The cone angle goes up to pi, and the twist from -pi to pi.
+	SwingTwistLimit(const Vec4 &axis, Scalar coneAngle, Scalar twistMin, Scalar twistMax);
+	void Set(const Vec4 &axis, Scalar coneAngle, Scalar twistMin, Scalar twistMax);
+};
+
+/// Splits \p q into \p swing * \p twist about the unit \p axis. Both come out with w >= 0.
+/// When q swings the axis half way around, the twist is undefined and is set to no rotation.
+void SwingTwistDecompose(const Quaternion &q, const Vec4 &axis, Quaternion &swing, Quaternion &twist);
+
+/// SwingTwistDecompose() for \p count rotations about the same axis.
+void SwingTwistDecompose(const Quaternion *q, const Vec4 &axis,
+	Quaternion *swing, Quaternion *twist, size_t count);
+
+/// SwingTwistDecompose() for \p count rotations, each about its own axis.
+void SwingTwistDecompose(const Quaternion *q, const Vec4 *axes,
+	Quaternion *swing, Quaternion *twist, size_t count);
+
+/// Puts \p count rotations back together, \p out[i] = \p swing[i] * \p twist[i]. \p out can be
+/// either of the inputs.
+void SwingTwistCompose(const Quaternion *swing, const Quaternion *twist, Quaternion *out, size_t count);
+
+/// Clamps the swing and the twist of \p q to \p limit. Returns true if \p q was changed. The
+/// sign of \p q is kept, so it stays close to what it was for blending.
+bool ClampSwingTwist(Quaternion &q, const SwingTwistLimit &limit);
+
+/// ClampSwingTwist() for \p count rotations, each with its own limit. Returns the number of
+/// rotations that were changed.
+size_t ClampSwingTwist(Quaternion *q, const SwingTwistLimit *limits, size_t count);
+
+}  // namespace mathing
+
+#endif  // MATHING_SWING_TWIST_H
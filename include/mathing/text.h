@@ -0,0 +1,59 @@
+#ifndef MATHING_TEXT_H
+#define MATHING_TEXT_H
+
+/** Text formatting and parsing of Scalar, Vec4, Quaternion and Matrix, for logs and debugging.
+
+	Numbers are written in the shortest form that reads back as exactly the same Scalar, and
+	read back exactly, with no locale, so a "." is always the decimal point. The components of
+	a Vec4 or Quaternion are separated by a space, x y z w, and a Matrix is its 16 numbers in
+	the same order as Buff(), so a Matrix is a line of AxisX() AxisY() AxisZ() Pos().
+
+	ToChars() writes into [first, last) and returns the end of what it wrote, or NULL if it
+	didn't fit. FromChars() reads from [first, last) and returns the end of what it read, or
+	NULL if it wasn't there. Between numbers it skips whitespace, and commas and brackets, so
+	it reads what operator<< writes too, though that isn't exact.
+
+	The bulk functions do whole arrays, one value per line, which is much faster than going
+	through iostream.
+
+	\sa operator<<(std::ostream &, const Matrix &)
+*/
+
+#include <stddef.h>
+
+#include <string>
+
+#include "matrix.h"
+#include "quaternion.h"
+#include "scalar.h"
+#include "vector.h"
+
+#define TEXT_SCALAR_CHARS 24     // most chars a Scalar takes, as in -2.2250738585072014e-308
+
+namespace mathing
+{
+
+char *ToChars(char *first, char *last, Scalar s);
+char *ToChars(char *first, char *last, const Vec4 &v);
+char *ToChars(char *first, char *last, const Quaternion &q);
+char *ToChars(char *first, char *last, const Matrix &m);
+
+const char *FromChars(const char *first, const char *last, Scalar &s);
+const char *FromChars(const char *first, const char *last, Vec4 &v);
+const char *FromChars(const char *first, const char *last, Quaternion &q);
+const char *FromChars(const char *first, const char *last, Matrix &m);
+
+/// Appends \p count values to \p out, each on its own line.
+void AppendText(const Vec4 *in, size_t count, std::string &out);
+void AppendText(const Quaternion *in, size_t count, std::string &out);
+void AppendText(const Matrix *in, size_t count, std::string &out);
+
+/// Reads up to \p count values from [first, last), and returns how many it read before the
+/// text ran out, or something that isn't a number.
+size_t ParseText(const char *first, const char *last, Vec4 *out, size_t count);
+size_t ParseText(const char *first, const char *last, Quaternion *out, size_t count);
+size_t ParseText(const char *first, const char *last, Matrix *out, size_t count);
+
+}  // namespace mathing
+
+#endif  // MATHING_TEXT_H
@@ -0,0 +1,53 @@
+#ifndef MATHING_VEC3_H
+#define MATHING_VEC3_H
+
+/** Packed 3 component vectors, for storing a lot of points or directions.
+
+	Vec4 is what the math works on, and it's 4 Scalars wide and aligned for that. A Vec3f is
+	12 bytes and a Vec3d 24, with no fourth component and nothing more than the alignment of
+	the components, so arrays of them pack tightly, for meshes, files and the network.
+
+	Whole arrays convert to Vec4 and back with Vec3ToVec4() and Vec4ToVec3(), or get
+	transformed without converting at all, with the packed overloads of Matrix::Transform()
+	and Matrix::Rotate().
+
+	\sa Vec4,
+		Matrix
+*/
+
+#include <stddef.h>
+
+#include "scalar.h"
+#include "vector.h"
+
+namespace mathing
+{
+
+/// 3 packed components, of float or double.
+template <typename T>
+struct Vec3T
+{
+	T x, y, z;
+
+	/// Initialize to 0,0,0
+	Vec3T() : x(0), y(0), z(0) {}
+	/// Initialize to \p x,\p y,\p z
+	Vec3T(T xarg, T yarg, T zarg) : x(xarg), y(yarg), z(zarg) {}
+	/// Set to \p x,\p y,\p z
+	inline void Set(T xarg, T yarg, T zarg) { x = xarg; y = yarg; z = zarg; }
+};
+
+typedef Vec3T<float> Vec3f;
+typedef Vec3T<double> Vec3d;
+
+/// Widens \p count packed vectors to Vec4, with \p w for the fourth component, 1 for points or 0 for directions.
+void Vec3ToVec4(const Vec3f *in, Vec4 *out, size_t count, Scalar w = 1);
+void Vec3ToVec4(const Vec3d *in, Vec4 *out, size_t count, Scalar w = 1);
+
+/// Narrows \p count Vec4 to packed vectors, dropping w.
+void Vec4ToVec3(const Vec4 *in, Vec3f *out, size_t count);
+void Vec4ToVec3(const Vec4 *in, Vec3d *out, size_t count);
+
+}  // namespace mathing
+
+#endif  // MATHING_VEC3_H
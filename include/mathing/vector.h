@@ -1,6 +1,8 @@
 #ifndef MATHING_VECTOR_H
 #define MATHING_VECTOR_H
 
+#include <stddef.h>
+
 #include <iostream>
 
 #include "scalar.h"
@@ -10,10 +12,11 @@ namespace mathing
 
 /// 4-Component vector
 /** Mathematical structure used to hold 3D points and vectors.
+Aligned to MATHING_ALIGN, see AlignedVector for containers that keep it that way.
 \sa ad::Matrix,
 ad::Quaternion
 */
-class Vec4
+class alignas(MATHING_ALIGN) Vec4
 {
 public:
 	Scalar x,y,z,w;
@@ -70,6 +73,18 @@ public:
 	/// Make this a unit-vector in the same direction
 	Scalar Normalize4();
 
+	/// Normalize3() with a hardware reciprocal square root estimate and one Newton step instead of
+	/// sqrt and divides. The length comes out within 2.1e-7 (relative) of 1, and so does the returned
+	/// length of the original. The vector can't be 0, and its squared length has to be in float range.
+	Scalar Normalize3Fast();
+	/// Normalize4() the same way as Normalize3Fast().
+	Scalar Normalize4Fast();
+
+	/// Normalize3() \p count vectors in place.
+	static void Normalize3(Vec4 *v, size_t count);
+	/// Normalize3Fast() \p count vectors in place.
+	static void Normalize3Fast(Vec4 *v, size_t count);
+
 	/// Cross Product: returns the vector perpendicular to both \p v1 and \p v2 (the fourth component is ignored, and returns 0)
 	static Vec4 Cross(const Vec4 &v1, const Vec4 &v2);
 
@@ -0,0 +1,64 @@
+#include "mathing/allocator.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace mathing
+{
+
+void *AlignedAlloc(size_t bytes, size_t align)
+{
+	if (align < sizeof(void *))
+		align = sizeof(void *);
+#ifdef _WIN32
+	return _aligned_malloc(bytes ? bytes : 1, align);
+#else
+	void *p = 0;
+	if (posix_memalign(&p, align, bytes ? bytes : 1) != 0)
+		return 0;
+	return p;
+#endif
+}
+
+void AlignedFree(void *p)
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+FrameArena::FrameArena(size_t capacity)
+	: m_Block(0), m_Capacity(0), m_Used(0)
+{
+	Reserve(capacity);
+}
+
+FrameArena::~FrameArena()
+{
+	AlignedFree(m_Block);
+}
+
+void FrameArena::Reserve(size_t capacity)
+{
+	AlignedFree(m_Block);
+	m_Block = capacity ? (char *)AlignedAlloc(capacity) : 0;
+	m_Capacity = m_Block ? capacity : 0;
+	m_Used = 0;
+}
+
+void *FrameArena::Allocate(size_t bytes, size_t align)
+{
+	// The block is aligned to MATHING_ALIGN, so aligning the offset aligns the pointer.
+	size_t start = (m_Used + align - 1) & ~(align - 1);
+	if (start > m_Capacity || bytes > m_Capacity - start)
+		return 0;
+	m_Used = start + bytes;
+	return m_Block + start;
+}
+
+}  // namespace mathing
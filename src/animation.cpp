@@ -0,0 +1,113 @@
+#include "mathing/animation.h"
+
+#include <algorithm>
+
+#include "quaternion_ops.h"
+
+#define ANIMATION_SCAN_KEYS 4     // keys to step forward from the cursor before falling back to a search
+
+namespace mathing
+{
+
+void AnimationCursor::Reset(const AnimationClip &clip)
+{
+	m_Key.assign(clip.TrackCount(), 0);
+}
+
+size_t AnimationClip::AddTrack(size_t keyCount)
+{
+	if (keyCount < 1)
+		keyCount = 1;
+	size_t track = m_KeyStart.size();
+	m_KeyStart.push_back(m_Time.size());
+	m_KeyCount.push_back((uint32_t)keyCount);
+	m_Time.resize(m_Time.size() + keyCount, 0);
+	m_Rotation.resize(m_Rotation.size() + keyCount);
+	m_Position.resize(m_Position.size() + keyCount, Vec4(0, 0, 0, 1));
+	return track;
+}
+
+void AnimationClip::Clear()
+{
+	m_KeyStart.clear();
+	m_KeyCount.clear();
+	m_Time.clear();
+	m_Rotation.clear();
+	m_Position.clear();
+}
+
+Scalar AnimationClip::Duration() const
+{
+	Scalar duration = 0;
+	for (size_t t = 0; t < m_KeyStart.size(); ++t)
+	{
+		Scalar last = m_Time[m_KeyStart[t] + m_KeyCount[t] - 1];
+		if (last > duration)
+			duration = last;
+	}
+	return duration;
+}
+
+Scalar AnimationClip::Seek(uint32_t &key, size_t track, Scalar time) const
+{
+	const Scalar *times = &m_Time[m_KeyStart[track]];
+	uint32_t last = m_KeyCount[track] - 1;
+	uint32_t k = key < last ? key : last;
+
+	if (time >= times[k])
+	{
+		// Playing forward, the key is usually the same one or the next.
+		uint32_t scanEnd = k + ANIMATION_SCAN_KEYS < last ? k + ANIMATION_SCAN_KEYS : last;
+		while (k < scanEnd && times[k + 1] <= time)
+			++k;
+		if (k == scanEnd && k < last && times[k + 1] <= time)
+			k = (uint32_t)(std::upper_bound(times + k, times + last + 1, time) - times) - 1;
+	}
+	else
+	{
+		// Went back, search everything before.
+		uint32_t upper = (uint32_t)(std::upper_bound(times, times + k, time) - times);
+		k = upper > 0 ? upper - 1 : 0;
+	}
+	key = k;
+
+	if (k == last || time <= times[k])
+		return 0;
+	return (time - times[k]) / (times[k + 1] - times[k]);
+}
+
+inline void AnimationClip::SampleTrack(uint32_t &key, size_t track, Scalar time, Quaternion &rotation, Vec4 &position) const
+{
+	Scalar s = Seek(key, track, time);
+	size_t i = m_KeyStart[track] + key;
+	size_t next = key + 1 < m_KeyCount[track] ? i + 1 : i;
+
+	const Vec4 &p0 = m_Position[i];
+	const Vec4 &p1 = m_Position[next];
+	position.Set(p0.x + (p1.x - p0.x)*s, p0.y + (p1.y - p0.y)*s, p0.z + (p1.z - p0.z)*s, p0.w + (p1.w - p0.w)*s);
+
+	rotation = QuaternionNlerp(m_Rotation[i], m_Rotation[next], s);
+}
+
+void AnimationClip::Sample(AnimationCursor &cursor, Scalar time, Quaternion *rotations, Vec4 *positions) const
+{
+	size_t trackCount = m_KeyStart.size();
+	for (size_t t = 0; t < trackCount; ++t)
+	{
+		SampleTrack(cursor.m_Key[t], t, time, rotations[t], positions[t]);
+	}
+}
+
+void AnimationClip::Sample(AnimationCursor &cursor, Scalar time, Matrix *transforms) const
+{
+	size_t trackCount = m_KeyStart.size();
+	for (size_t t = 0; t < trackCount; ++t)
+	{
+		Quaternion rotation;
+		Vec4 position;
+		SampleTrack(cursor.m_Key[t], t, time, rotation, position);
+		transforms[t].Set(rotation, position);
+	}
+}
+
+}  // namespace mathing
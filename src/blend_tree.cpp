@@ -0,0 +1,179 @@
+#include "mathing/blend_tree.h"
+
+#include "quaternion_ops.h"
+
+namespace mathing
+{
+
+PoseArena::PoseArena(size_t boneCapacity)
+	: m_Used(0)
+{
+	Reserve(boneCapacity);
+}
+
+void PoseArena::Reserve(size_t boneCapacity)
+{
+	m_Rotations.resize(boneCapacity);
+	m_Positions.resize(boneCapacity);
+	m_Used = 0;
+}
+
+bool PoseArena::Allocate(size_t boneCount, PoseBuffer &pose)
+{
+	if (m_Used + boneCount > m_Rotations.size())
+		return false;
+	pose.rotations = m_Rotations.data() + m_Used;
+	pose.positions = m_Positions.data() + m_Used;
+	m_Used += boneCount;
+	return true;
+}
+
+static void Blend(const PoseBuffer &a, const PoseBuffer &b, Scalar weight, const Scalar *mask,
+	size_t boneCount, const PoseBuffer &out)
+{
+	for (size_t i = 0; i < boneCount; ++i)
+	{
+		Scalar t = mask ? weight * mask[i] : weight;
+		out.rotations[i] = QuaternionNlerp(a.rotations[i], b.rotations[i], t);
+		const Vec4 &pa = a.positions[i];
+		const Vec4 &pb = b.positions[i];
+		out.positions[i].Set(pa.x + (pb.x - pa.x)*t, pa.y + (pb.y - pa.y)*t, pa.z + (pb.z - pa.z)*t, pa.w);
+	}
+}
+
+static void Additive(const PoseBuffer &base, const PoseBuffer &add, Scalar weight, const Scalar *mask,
+	size_t boneCount, const PoseBuffer &out)
+{
+	for (size_t i = 0; i < boneCount; ++i)
+	{
+		Scalar t = mask ? weight * mask[i] : weight;
+
+		// The delta scaled from no rotation, then base * delta.
+		Quaternion d = QuaternionNlerp(Quaternion(), add.rotations[i], t);
+		out.rotations[i] = QuaternionMul(base.rotations[i], d);
+
+		const Vec4 &pa = base.positions[i];
+		const Vec4 &pb = add.positions[i];
+		out.positions[i].Set(pa.x + pb.x*t, pa.y + pb.y*t, pa.z + pb.z*t, pa.w);
+	}
+}
+
+BlendTree::BlendTree(size_t boneCount)
+	: m_BoneCount(boneCount), m_MaskCount(0), m_Depth(0), m_Buffers(0)
+{
+}
+
+int BlendTree::AddMask(const Scalar *boneWeights)
+{
+	// Counted rather than worked out from the size of m_Masks, which is 0 for a tree of 0 bones.
+	m_Masks.insert(m_Masks.end(), boneWeights, boneWeights + m_BoneCount);
+	return m_MaskCount++;
+}
+
+size_t BlendTree::AddInput(size_t input)
+{
+	Node node = {INPUT, input, 0, 0, -1};
+	m_Nodes.push_back(node);
+	return m_Nodes.size() - 1;
+}
+
+size_t BlendTree::AddBlend(size_t a, size_t b, size_t weightParam, int mask)
+{
+	Node node = {BLEND, a, b, weightParam, mask};
+	m_Nodes.push_back(node);
+	return m_Nodes.size() - 1;
+}
+
+size_t BlendTree::AddAdditive(size_t base, size_t additive, size_t weightParam, int mask)
+{
+	Node node = {ADDITIVE, base, additive, weightParam, mask};
+	m_Nodes.push_back(node);
+	return m_Nodes.size() - 1;
+}
+
+void BlendTree::Flatten(size_t node)
+{
+	const Node &n = m_Nodes[node];
+	if (n.type != INPUT)
+	{
+		Flatten(n.a);
+		Flatten(n.b);
+	}
+	m_Order.push_back(node);
+}
+
+bool BlendTree::Compile(size_t root)
+{
+	m_Order.clear();
+	Flatten(root);
+
+	// Run the stack without any poses, to see how deep it gets, and the deepest a node other than
+	// the root leaves its result at, which is how many buffers it takes.
+	size_t depth = 0;
+	m_Depth = 0;
+	m_Buffers = 0;
+	for (size_t i = 0; i < m_Order.size(); ++i)
+	{
+		if (m_Nodes[m_Order[i]].type == INPUT)
+		{
+			++depth;
+			if (depth > m_Depth)
+				m_Depth = depth;
+		}
+		else
+		{
+			--depth;
+			if (depth > m_Buffers && i + 1 < m_Order.size())
+				m_Buffers = depth;
+		}
+	}
+	return m_Depth <= BLEND_TREE_MAX_DEPTH;
+}
+
+bool BlendTree::Evaluate(PoseArena &arena, const PoseBuffer *inputs, const Scalar *params, const PoseBuffer &out) const
+{
+	if (m_Order.empty() || m_Depth > BLEND_TREE_MAX_DEPTH)
+		return false;
+
+	// A buffer for each depth a node can leave its result at, except the root, which goes to out.
+	PoseBuffer buffers[BLEND_TREE_MAX_DEPTH];
+	for (size_t d = 0; d < m_Buffers; ++d)
+	{
+		if (!arena.Allocate(m_BoneCount, buffers[d]))
+			return false;
+	}
+
+	PoseBuffer stack[BLEND_TREE_MAX_DEPTH];
+	size_t top = 0;
+	for (size_t i = 0; i < m_Order.size(); ++i)
+	{
+		const Node &n = m_Nodes[m_Order[i]];
+		if (n.type == INPUT)
+		{
+			stack[top++] = inputs[n.a];
+			continue;
+		}
+
+		--top;
+		const PoseBuffer &dst = i + 1 == m_Order.size() ? out : buffers[top - 1];
+		const Scalar *mask = n.mask < 0 ? 0 : m_Masks.data() + n.mask * m_BoneCount;
+		if (n.type == BLEND)
+			Blend(stack[top - 1], stack[top], params[n.param], mask, m_BoneCount, dst);
+		else
+			Additive(stack[top - 1], stack[top], params[n.param], mask, m_BoneCount, dst);
+		stack[top - 1] = dst;
+	}
+
+	// Only the root was an input.
+	if (m_Order.size() == 1)
+	{
+		for (size_t i = 0; i < m_BoneCount; ++i)
+		{
+			out.rotations[i] = stack[0].rotations[i];
+			out.positions[i] = stack[0].positions[i];
+		}
+	}
+	return true;
+}
+
+}  // namespace mathing
@@ -0,0 +1,771 @@
+#include "mathing/collide.h"
+
+#include <math.h>
+
+#define GJK_MAX_ITERATIONS 64
+#define GJK_EPSILON 1e-10     // relative progress toward the origin at which GJK has converged
+#define GJK_TOUCHING 1e-20    // squared distance between cores that counts as overlapping
+
+#define EPA_MAX_ITERATIONS 64
+#define EPA_MAX_VERTS 64
+#define EPA_MAX_FACES 128
+#define EPA_MAX_EDGES 64
+#define EPA_EPSILON 1e-8      // how close the support has to be to the closest face to stop
+
+namespace mathing
+{
+
+//
+// Shapes
+//
+
+ConvexShape ConvexShape::Sphere(Scalar radius)
+{
+	ConvexShape s;
+	s.type = SPHERE;
+	s.radius = radius;
+	s.verts = 0;
+	s.vertCount = 0;
+	return s;
+}
+
+ConvexShape ConvexShape::Box(const Vec4 &halfExtents, Scalar radius)
+{
+	ConvexShape s;
+	s.type = BOX;
+	s.radius = radius;
+	s.halfExtents = halfExtents;
+	s.verts = 0;
+	s.vertCount = 0;
+	return s;
+}
+
+ConvexShape ConvexShape::Capsule(Scalar halfHeight, Scalar radius)
+{
+	ConvexShape s;
+	s.type = CAPSULE;
+	s.radius = radius;
+	s.halfExtents.Set(0, halfHeight, 0);
+	s.verts = 0;
+	s.vertCount = 0;
+	return s;
+}
+
+ConvexShape ConvexShape::Hull(const Vec4 *verts, int vertCount, Scalar radius)
+{
+	ConvexShape s;
+	s.type = HULL;
+	s.radius = radius;
+	s.verts = verts;
+	s.vertCount = vertCount;
+	return s;
+}
+
+Vec4 ConvexShape::Support(const Vec4 &dir) const
+{
+	switch (type)
+	{
+	case BOX:
+		return Vec4(
+			dir.x < 0 ? -halfExtents.x : halfExtents.x,
+			dir.y < 0 ? -halfExtents.y : halfExtents.y,
+			dir.z < 0 ? -halfExtents.z : halfExtents.z);
+	case CAPSULE:
+		return Vec4(0, dir.y < 0 ? -halfExtents.y : halfExtents.y, 0);
+	case HULL:
+	{
+		int best = 0;
+		Scalar bestDot = Vec4::Dot3(verts[0], dir);
+		for (int i = 1; i < vertCount; ++i)
+		{
+			Scalar d = Vec4::Dot3(verts[i], dir);
+			if (d > bestDot)
+			{
+				bestDot = d;
+				best = i;
+			}
+		}
+		return verts[best];
+	}
+	case SPHERE:
+	default:
+		return Vec4();
+	}
+}
+
+//
+// Support of the Minkowski difference A - B in world space
+//
+
+// One shape in its pose. The world direction goes into local space through the transpose of
+// the rotation, so there's no need for the inverse matrix.
+struct PosedShape
+{
+	const ConvexShape &shape;
+	const Matrix &pose;
+
+	PosedShape(const ConvexShape &s, const Matrix &m) : shape(s), pose(m) {}
+
+	inline Vec4 Support(const Vec4 &dir) const
+	{
+		Vec4 local(Vec4::Dot3(dir, pose.AxisX()), Vec4::Dot3(dir, pose.AxisY()), Vec4::Dot3(dir, pose.AxisZ()), 0);
+		Vec4 p = shape.Support(local);
+		p.w = 1;
+		return pose.Transform(p);
+	}
+};
+
+// A vertex of the simplex / polytope, with the points on A and B it came from.
+struct SupportVert
+{
+	Vec4 w, a, b;
+};
+
+static inline void Support(const PosedShape &A, const PosedShape &B, const Vec4 &dir, SupportVert &out)
+{
+	out.a = A.Support(dir);
+	out.b = B.Support(-dir);
+	out.w = out.a - out.b;
+}
+
+//
+// GJK
+//
+
+struct Simplex
+{
+	SupportVert v[4];
+	Scalar lambda[4];
+	int count;
+
+	// Keeps only the listed vertices, with their barycentric weights.
+	inline void Reduce(int n, const int *keep, const Scalar *weights)
+	{
+		SupportVert tmp[4];
+		for (int i = 0; i < n; ++i)
+			tmp[i] = v[keep[i]];
+		for (int i = 0; i < n; ++i)
+		{
+			v[i] = tmp[i];
+			lambda[i] = weights[i];
+		}
+		count = n;
+	}
+
+	inline Vec4 Closest() const
+	{
+		Vec4 p;
+		for (int i = 0; i < count; ++i)
+			p += v[i].w * lambda[i];
+		return p;
+	}
+
+	inline void Witnesses(Vec4 &pa, Vec4 &pb) const
+	{
+		pa = Vec4();
+		pb = Vec4();
+		for (int i = 0; i < count; ++i)
+		{
+			pa += v[i].a * lambda[i];
+			pb += v[i].b * lambda[i];
+		}
+		pa.w = 1;
+		pb.w = 1;
+	}
+};
+
+// Closest point to the origin on the triangle abc, from Ericson's "Real-Time Collision Detection".
+// Writes which vertices support it, and their weights. Returns the number of them.
+static int ClosestOnTriangle(const Vec4 &a, const Vec4 &b, const Vec4 &c, int idx[3], Scalar weights[3])
+{
+	Vec4 ab = b - a;
+	Vec4 ac = c - a;
+
+	Scalar d1 = -Vec4::Dot3(ab, a);
+	Scalar d2 = -Vec4::Dot3(ac, a);
+	if (d1 <= 0 && d2 <= 0)
+	{
+		idx[0] = 0; weights[0] = 1;
+		return 1;
+	}
+
+	Scalar d3 = -Vec4::Dot3(ab, b);
+	Scalar d4 = -Vec4::Dot3(ac, b);
+	if (d3 >= 0 && d4 <= d3)
+	{
+		idx[0] = 1; weights[0] = 1;
+		return 1;
+	}
+
+	Scalar vc = d1*d4 - d3*d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0)
+	{
+		Scalar t = d1 / (d1 - d3);
+		idx[0] = 0; weights[0] = 1 - t;
+		idx[1] = 1; weights[1] = t;
+		return 2;
+	}
+
+	Scalar d5 = -Vec4::Dot3(ab, c);
+	Scalar d6 = -Vec4::Dot3(ac, c);
+	if (d6 >= 0 && d5 <= d6)
+	{
+		idx[0] = 2; weights[0] = 1;
+		return 1;
+	}
+
+	Scalar vb = d5*d2 - d1*d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0)
+	{
+		Scalar t = d2 / (d2 - d6);
+		idx[0] = 0; weights[0] = 1 - t;
+		idx[1] = 2; weights[1] = t;
+		return 2;
+	}
+
+	Scalar va = d3*d6 - d5*d4;
+	if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+	{
+		Scalar t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		idx[0] = 1; weights[0] = 1 - t;
+		idx[1] = 2; weights[1] = t;
+		return 2;
+	}
+
+	Scalar denom = 1 / (va + vb + vc);
+	Scalar v = vb * denom;
+	Scalar w = vc * denom;
+	idx[0] = 0; weights[0] = 1 - v - w;
+	idx[1] = 1; weights[1] = v;
+	idx[2] = 2; weights[2] = w;
+	return 3;
+}
+
+// Reduces the simplex to the smallest sub-simplex that supports its closest point to the origin.
+// Returns false if the simplex is a tetrahedron that contains the origin.
+static bool UpdateSimplex(Simplex &s)
+{
+	switch (s.count)
+	{
+	case 1:
+	{
+		s.lambda[0] = 1;
+		return true;
+	}
+	case 2:
+	{
+		Vec4 ab = s.v[1].w - s.v[0].w;
+		Scalar len = Vec4::Dot3(ab, ab);
+		Scalar t = len > 0 ? -Vec4::Dot3(s.v[0].w, ab) / len : 0;
+		if (t <= 0)
+		{
+			int keep[1] = {0};
+			Scalar w[1] = {1};
+			s.Reduce(1, keep, w);
+		}
+		else if (t >= 1)
+		{
+			int keep[1] = {1};
+			Scalar w[1] = {1};
+			s.Reduce(1, keep, w);
+		}
+		else
+		{
+			s.lambda[0] = 1 - t;
+			s.lambda[1] = t;
+		}
+		return true;
+	}
+	case 3:
+	{
+		int idx[3];
+		Scalar w[3];
+		int n = ClosestOnTriangle(s.v[0].w, s.v[1].w, s.v[2].w, idx, w);
+		s.Reduce(n, idx, w);
+		return true;
+	}
+	case 4:
+	{
+		// Check the origin against each face, the ones it's outside of can have the closest point.
+		static const int faces[4][4] = {
+			{0, 1, 2, 3},
+			{0, 3, 1, 2},
+			{0, 2, 3, 1},
+			{1, 3, 2, 0},
+		};
+
+		bool outsideAny = false;
+		Scalar bestDist = 0;
+		int bestN = 0;
+		int bestIdx[3];
+		Scalar bestW[3];
+		for (int f = 0; f < 4; ++f)
+		{
+			const Vec4 &a = s.v[faces[f][0]].w;
+			const Vec4 &b = s.v[faces[f][1]].w;
+			const Vec4 &c = s.v[faces[f][2]].w;
+			const Vec4 &d = s.v[faces[f][3]].w;
+			Vec4 n = Vec4::Cross(b - a, c - a);
+			Scalar signO = -Vec4::Dot3(a, n);
+			Scalar signD = Vec4::Dot3(d - a, n);
+			// A flat tetrahedron has no inside, so all its faces are candidates.
+			if (signO * signD >= 0 && signD != 0)
+				continue;
+
+			outsideAny = true;
+			int idx[3];
+			Scalar w[3];
+			int count = ClosestOnTriangle(a, b, c, idx, w);
+			Vec4 p;
+			for (int i = 0; i < count; ++i)
+				p += s.v[faces[f][idx[i]]].w * w[i];
+			Scalar dist = Vec4::Dot3(p, p);
+			if (bestN == 0 || dist < bestDist)
+			{
+				bestDist = dist;
+				bestN = count;
+				for (int i = 0; i < count; ++i)
+				{
+					bestIdx[i] = faces[f][idx[i]];
+					bestW[i] = w[i];
+				}
+			}
+		}
+
+		if (!outsideAny)
+			return false;
+		s.Reduce(bestN, bestIdx, bestW);
+		return true;
+	}
+	}
+	return true;
+}
+
+// Runs GJK on the cores. Returns true if the cores are separated, and leaves the simplex that
+// supports the closest point. If they overlap, the simplex is left as it was when that was found.
+static bool Gjk(const PosedShape &A, const PosedShape &B, Simplex &s, int &iterations)
+{
+	s.count = 0;
+	Vec4 v = A.pose.Pos() - B.pose.Pos();
+	if (Vec4::Dot3(v, v) < GJK_TOUCHING)
+		v = Vec4::m_UnitX;
+	Scalar vv = HUGE_VAL;
+
+	for (iterations = 0; iterations < GJK_MAX_ITERATIONS; ++iterations)
+	{
+		SupportVert sv;
+		Support(A, B, -v, sv);
+
+		if (s.count > 0)
+		{
+			// No closer to the origin than we already are.
+			if (vv - Vec4::Dot3(v, sv.w) <= GJK_EPSILON * vv)
+				return true;
+			for (int i = 0; i < s.count; ++i)
+			{
+				if (Vec4::Dot3(s.v[i].w - sv.w, s.v[i].w - sv.w) == 0)
+					return true;
+			}
+		}
+
+		s.v[s.count++] = sv;
+		if (!UpdateSimplex(s))
+			return false;
+
+		v = s.Closest();
+		Scalar newVV = Vec4::Dot3(v, v);
+		if (newVV <= GJK_TOUCHING)
+			return false;
+		// Numerical trouble, it has to get closer every step.
+		if (newVV >= vv)
+			return true;
+		vv = newVV;
+	}
+	return true;
+}
+
+//
+// EPA
+//
+
+struct EpaFace
+{
+	int i[3];
+	Vec4 n;
+	Scalar d;
+	bool alive;
+};
+
+struct EpaPolytope
+{
+	SupportVert verts[EPA_MAX_VERTS];
+	int vertCount;
+	EpaFace faces[EPA_MAX_FACES];
+	int faceCount;
+
+	// Adds the face, wound a, b, c counter clockwise seen from outside. Returns false if it's full.
+	bool AddFace(int a, int b, int c)
+	{
+		int slot = -1;
+		for (int f = 0; f < faceCount; ++f)
+		{
+			if (!faces[f].alive)
+			{
+				slot = f;
+				break;
+			}
+		}
+		if (slot < 0)
+		{
+			if (faceCount == EPA_MAX_FACES)
+				return false;
+			slot = faceCount++;
+		}
+
+		EpaFace &face = faces[slot];
+		face.i[0] = a;
+		face.i[1] = b;
+		face.i[2] = c;
+		face.alive = true;
+		face.n = Vec4::Cross(verts[b].w - verts[a].w, verts[c].w - verts[a].w);
+		Scalar len = face.n.Length3();
+		if (len > 0)
+		{
+			face.n /= len;
+			face.d = Vec4::Dot3(face.n, verts[a].w);
+		}
+		else
+		{
+			// Sliver faces have no normal to search along. They stay in the polytope, but are
+			// never picked as the closest.
+			face.d = HUGE_VAL;
+		}
+		return true;
+	}
+
+	// The live face closest to the origin, or -1 if there's none left with a normal.
+	int Closest() const
+	{
+		int best = -1;
+		for (int f = 0; f < faceCount; ++f)
+		{
+			if (faces[f].alive && faces[f].d != HUGE_VAL && (best < 0 || faces[f].d < faces[best].d))
+				best = f;
+		}
+		return best;
+	}
+};
+
+// Grows a simplex that overlaps the origin into a tetrahedron. It can be smaller when the
+// shapes are just touching, or when GJK found an overlap early. Returns false if the
+// Minkowski difference is flat in some direction (touching with no depth).
+static bool BuildTetrahedron(const PosedShape &A, const PosedShape &B, Simplex &s)
+{
+	static const Vec4 axes[6] = {
+		Vec4(1, 0, 0), Vec4(-1, 0, 0),
+		Vec4(0, 1, 0), Vec4(0, -1, 0),
+		Vec4(0, 0, 1), Vec4(0, 0, -1),
+	};
+
+	if (s.count == 0)
+	{
+		Support(A, B, Vec4::m_UnitX, s.v[0]);
+		s.count = 1;
+	}
+
+	if (s.count == 1)
+	{
+		for (int i = 0; i < 6 && s.count == 1; ++i)
+		{
+			SupportVert sv;
+			Support(A, B, axes[i], sv);
+			if ((sv.w - s.v[0].w).Length3Sqr() > GJK_TOUCHING)
+				s.v[s.count++] = sv;
+		}
+		if (s.count == 1)
+			return false;
+	}
+
+	if (s.count == 2)
+	{
+		Vec4 d = s.v[1].w - s.v[0].w;
+		for (int i = 0; i < 6 && s.count == 2; ++i)
+		{
+			Vec4 dir = Vec4::Cross(d, axes[i]);
+			if (dir.Length3Sqr() <= GJK_TOUCHING)
+				continue;
+			SupportVert sv;
+			Support(A, B, dir, sv);
+			if (Vec4::Cross(d, sv.w - s.v[0].w).Length3Sqr() > GJK_TOUCHING)
+				s.v[s.count++] = sv;
+		}
+		if (s.count == 2)
+			return false;
+	}
+
+	if (s.count == 3)
+	{
+		Vec4 n = Vec4::Cross(s.v[1].w - s.v[0].w, s.v[2].w - s.v[0].w);
+		for (int i = 0; i < 2 && s.count == 3; ++i)
+		{
+			SupportVert sv;
+			Support(A, B, i == 0 ? n : -n, sv);
+			Scalar volume = Vec4::Dot3(sv.w - s.v[0].w, n);
+			if (volume * volume > GJK_TOUCHING)
+				s.v[s.count++] = sv;
+		}
+		if (s.count == 3)
+			return false;
+	}
+	return true;
+}
+
+// Normal for cores that overlap without any volume, such as a point on a segment. The
+// Minkowski difference is flat (a point, segment or triangle), and any direction across it
+// will do, so it takes the one closest to \p hint.
+static Vec4 FlatNormal(const Simplex &s, const Vec4 &hint)
+{
+	Vec4 n = hint;
+	if (s.count >= 3)
+	{
+		n = Vec4::Cross(s.v[1].w - s.v[0].w, s.v[2].w - s.v[0].w);
+		if (Vec4::Dot3(n, hint) < 0)
+			n = -n;
+	}
+	else if (s.count == 2)
+	{
+		Vec4 d = s.v[1].w - s.v[0].w;
+		n = hint - d * (Vec4::Dot3(hint, d) / d.Length3Sqr());
+		if (n.Length3Sqr() <= GJK_TOUCHING)
+			n = Vec4::Cross(d, fabs(d.x) < fabs(d.y) ? Vec4::m_UnitX : Vec4::m_UnitY);
+	}
+	if (n.Length3Sqr() <= GJK_TOUCHING)
+		n = Vec4::m_UnitX;
+	n.w = 0;
+	n.Normalize3();
+	return n;
+}
+
+// Penetration of the cores, starting from a tetrahedron around the origin. Returns false if the
+// polytope has no face to measure it against.
+static bool Epa(const PosedShape &A, const PosedShape &B, const Simplex &s, ShapeQueryResult &result)
+{
+	EpaPolytope poly;
+	poly.vertCount = 4;
+	poly.faceCount = 0;
+	for (int i = 0; i < 4; ++i)
+		poly.verts[i] = s.v[i];
+
+	// Wind the faces of the tetrahedron to face outward.
+	Vec4 center = (s.v[0].w + s.v[1].w + s.v[2].w + s.v[3].w) * 0.25;
+	static const int tet[4][3] = { {0, 1, 2}, {0, 3, 1}, {0, 2, 3}, {1, 3, 2} };
+	for (int f = 0; f < 4; ++f)
+	{
+		const Vec4 &a = s.v[tet[f][0]].w;
+		Vec4 n = Vec4::Cross(s.v[tet[f][1]].w - a, s.v[tet[f][2]].w - a);
+		if (Vec4::Dot3(n, a - center) < 0)
+			poly.AddFace(tet[f][0], tet[f][2], tet[f][1]);
+		else
+			poly.AddFace(tet[f][0], tet[f][1], tet[f][2]);
+	}
+
+	// The last face that was picked, in case an expansion leaves no live face behind (the new
+	// point saw all of them, or the horizon overflowed). Copied, since its slot can be reused.
+	EpaFace last;
+	bool haveLast = false;
+	for (int iter = 0; iter < EPA_MAX_ITERATIONS; ++iter)
+	{
+		++result.iterations;
+
+		int best = poly.Closest();
+		if (best < 0)
+			break;
+		last = poly.faces[best];
+		haveLast = true;
+
+		const EpaFace &closest = last;
+		SupportVert sv;
+		Support(A, B, closest.n, sv);
+		if (Vec4::Dot3(sv.w, closest.n) - closest.d <= EPA_EPSILON * (1 + closest.d))
+			break;
+		if (poly.vertCount == EPA_MAX_VERTS)
+			break;
+
+		int newVert = poly.vertCount++;
+		poly.verts[newVert] = sv;
+
+		// Remove every face the new point can see, the edges that only one of them had form the
+		// horizon, which gets connected to the new point.
+		int edges[EPA_MAX_EDGES][2];
+		int edgeCount = 0;
+		bool overflow = false;
+		for (int f = 0; f < poly.faceCount; ++f)
+		{
+			EpaFace &face = poly.faces[f];
+			if (!face.alive || Vec4::Dot3(face.n, sv.w - poly.verts[face.i[0]].w) <= 0)
+				continue;
+			face.alive = false;
+			for (int e = 0; e < 3; ++e)
+			{
+				int a = face.i[e];
+				int b = face.i[(e + 1) % 3];
+				int found = -1;
+				for (int k = 0; k < edgeCount; ++k)
+				{
+					if (edges[k][0] == b && edges[k][1] == a)
+					{
+						found = k;
+						break;
+					}
+				}
+				if (found >= 0)
+				{
+					edges[found][0] = edges[edgeCount - 1][0];
+					edges[found][1] = edges[edgeCount - 1][1];
+					--edgeCount;
+				}
+				else if (edgeCount < EPA_MAX_EDGES)
+				{
+					edges[edgeCount][0] = a;
+					edges[edgeCount][1] = b;
+					++edgeCount;
+				}
+				else
+				{
+					overflow = true;
+				}
+			}
+		}
+
+		for (int k = 0; k < edgeCount && !overflow; ++k)
+			overflow = !poly.AddFace(edges[k][0], edges[k][1], newVert);
+		if (overflow)
+			break;
+	}
+
+	// Recompute the best face, the last expansion could have replaced it.
+	int best = poly.Closest();
+	if (best < 0 && !haveLast)
+		return false;
+	const EpaFace &face = best >= 0 ? poly.faces[best] : last;
+	const SupportVert &a = poly.verts[face.i[0]];
+	const SupportVert &b = poly.verts[face.i[1]];
+	const SupportVert &c = poly.verts[face.i[2]];
+
+	// Barycentrics of the origin projected onto the face.
+	Vec4 p = face.n * face.d;
+	Vec4 v0 = b.w - a.w, v1 = c.w - a.w, v2 = p - a.w;
+	Scalar d00 = Vec4::Dot3(v0, v0);
+	Scalar d01 = Vec4::Dot3(v0, v1);
+	Scalar d11 = Vec4::Dot3(v1, v1);
+	Scalar d20 = Vec4::Dot3(v2, v0);
+	Scalar d21 = Vec4::Dot3(v2, v1);
+	Scalar denom = d00 * d11 - d01 * d01;
+	Scalar u = 1.0 / 3, v = 1.0 / 3;
+	if (denom != 0)
+	{
+		u = (d11 * d20 - d01 * d21) / denom;
+		v = (d00 * d21 - d01 * d20) / denom;
+	}
+	Scalar w0 = 1 - u - v;
+
+	result.distance = -face.d;
+	result.normal = face.n;
+	result.pointA = a.a * w0 + b.a * u + c.a * v;
+	result.pointB = a.b * w0 + b.b * u + c.b * v;
+	result.pointA.w = 1;
+	result.pointB.w = 1;
+	return true;
+}
+
+//
+// Queries
+//
+
+// GJK on the cores, then the radii are taken off along the normal.
+// Returns false if the cores overlap, and leaves the simplex for EPA.
+static bool CoreDistance(const PosedShape &A, const PosedShape &B, Simplex &s, ShapeQueryResult &result)
+{
+	result.iterations = 0;
+	if (!Gjk(A, B, s, result.iterations))
+	{
+		result.distance = 0;
+		result.normal = Vec4::m_UnitX;
+		// A tetrahedron around the origin has no weights.
+		if (s.count < 4)
+		{
+			s.Witnesses(result.pointA, result.pointB);
+		}
+		else
+		{
+			result.pointA = A.pose.Pos();
+			result.pointB = B.pose.Pos();
+		}
+		return false;
+	}
+
+	Vec4 pa, pb;
+	s.Witnesses(pa, pb);
+	Vec4 d = pb - pa;
+	Scalar dist = d.Length3();
+	result.normal = d / dist;
+	result.distance = dist - A.shape.radius - B.shape.radius;
+	result.pointA = pa + result.normal * A.shape.radius;
+	result.pointB = pb - result.normal * B.shape.radius;
+	return true;
+}
+
+bool ShapeDistance(const ConvexShape &a, const Matrix &poseA,
+	const ConvexShape &b, const Matrix &poseB, ShapeQueryResult &result)
+{
+	Simplex s;
+	if (!CoreDistance(PosedShape(a, poseA), PosedShape(b, poseB), s, result))
+		return false;
+	return result.distance > 0;
+}
+
+bool ShapeDistance(const ConvexShape &a, const Quaternion &rotA, const Vec4 &posA,
+	const ConvexShape &b, const Quaternion &rotB, const Vec4 &posB, ShapeQueryResult &result)
+{
+	return ShapeDistance(a, Matrix(rotA, posA), b, Matrix(rotB, posB), result);
+}
+
+bool ShapeQuery(const ConvexShape &a, const Matrix &poseA,
+	const ConvexShape &b, const Matrix &poseB, ShapeQueryResult &result)
+{
+	PosedShape A(a, poseA);
+	PosedShape B(b, poseB);
+	Simplex s;
+	if (CoreDistance(A, B, s, result))
+		return result.distance <= 0;
+
+	// The cores overlap. Their penetration is a polytope problem for EPA, and the radii just add
+	// to the depth, so the round parts of the shapes are exact.
+	if (!BuildTetrahedron(A, B, s) || !Epa(A, B, s, result))
+		result.normal = FlatNormal(s, poseB.Pos() - poseA.Pos());
+
+	result.distance -= a.radius + b.radius;
+	result.pointA += result.normal * a.radius;
+	result.pointB -= result.normal * b.radius;
+	return true;
+}
+
+bool ShapeQuery(const ConvexShape &a, const Quaternion &rotA, const Vec4 &posA,
+	const ConvexShape &b, const Quaternion &rotB, const Vec4 &posB, ShapeQueryResult &result)
+{
+	return ShapeQuery(a, Matrix(rotA, posA), b, Matrix(rotB, posB), result);
+}
+
+size_t ShapeQuery(const ShapePair *pairs, size_t count, ShapeQueryResult *results)
+{
+	size_t overlaps = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const ShapePair &p = pairs[i];
+		if (ShapeQuery(*p.a, *p.poseA, *p.b, *p.poseB, results[i]))
+			++overlaps;
+	}
+	return overlaps;
+}
+
+}  // namespace mathing
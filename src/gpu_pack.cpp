@@ -0,0 +1,183 @@
+#include "mathing/gpu_pack.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "mathing/quantize.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MATHING_HAVE_STREAM
+#endif
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+namespace mathing
+{
+
+// Writes \p count 32 bit words from \p src around the cache, in 16 byte blocks while dst is
+// aligned for them. src has to be 16 byte aligned.
+static inline void Stream(char *dst, const void *src, size_t count)
+{
+#ifdef MATHING_HAVE_STREAM
+	const char *words = (const char *)src;
+	size_t i = 0;
+	if (((uintptr_t)dst & 15) == 0)
+	{
+		for (; i + 4 <= count; i += 4)
+			_mm_stream_si128((__m128i *)(dst + i*4), _mm_load_si128((const __m128i *)(words + i*4)));
+	}
+	for (; i < count; ++i)
+	{
+		int word;
+		memcpy(&word, words + i*4, 4);
+		_mm_stream_si32((int *)(dst + i*4), word);
+	}
+#else
+	memcpy(dst, src, count * 4);
+#endif
+}
+
+// Where T[r][c] goes in a matrix of Rows rows, in order RowMajor. The layout is in the template
+// so the sources write to constant indices.
+template <int Rows, bool RowMajor>
+static inline int Slot(int r, int c)
+{
+	return RowMajor ? r*4 + c : c*Rows + r;
+}
+
+// One matrix, already narrowed and in its order in \p f, to dst as floats or halves.
+template <int Rows, bool Half>
+static inline void PackOne(const float *f, char *dst)
+{
+	if (Half)
+	{
+		alignas(16) uint32_t words[8];
+		for (int k = 0; k < Rows*4; k += 4)
+		{
+#ifdef __F16C__
+			_mm_storel_epi64((__m128i *)(words + k/2), _mm_cvtps_ph(_mm_load_ps(f + k), _MM_FROUND_TO_NEAREST_INT));
+#else
+			words[k/2] = FloatToHalf(f[k]) | (uint32_t)FloatToHalf(f[k + 1]) << 16;
+			words[k/2 + 1] = FloatToHalf(f[k + 2]) | (uint32_t)FloatToHalf(f[k + 3]) << 16;
+#endif
+		}
+		Stream(dst, words, Rows*2);
+	}
+	else
+	{
+		Stream(dst, f, Rows*4);
+	}
+}
+
+// Orders the streamed stores before whatever hands the buffer to the GPU.
+static inline void StreamFence()
+{
+#ifdef MATHING_HAVE_STREAM
+	_mm_sfence();
+#endif
+}
+
+// Every transform from Source::Get<Rows, RowMajor>(i, f) packed in one layout.
+template <int Rows, bool RowMajor, bool Half, typename Source>
+static void PackAll(const Source &source, size_t count, size_t stride, char *dst)
+{
+	alignas(16) float f[16];
+	for (size_t i = 0; i < count; ++i, dst += stride)
+	{
+		source.template Get<Rows, RowMajor>(i, f);
+		PackOne<Rows, Half>(f, dst);
+	}
+	StreamFence();
+}
+
+template <typename Source>
+static void Pack(const Source &source, size_t count, const PackLayout &layout, void *out)
+{
+	size_t stride = layout.Stride();
+	char *dst = (char *)out;
+	bool rowMajor = layout.order == PackLayout::ROW_MAJOR;
+	bool half = layout.format == PackLayout::FLOAT16;
+	int kind = (layout.rows == 3 ? 4 : 0) | (rowMajor ? 2 : 0) | (half ? 1 : 0);
+	switch (kind)
+	{
+	case 0: PackAll<4, false, false>(source, count, stride, dst); break;
+	case 1: PackAll<4, false, true>(source, count, stride, dst); break;
+	case 2: PackAll<4, true, false>(source, count, stride, dst); break;
+	case 3: PackAll<4, true, true>(source, count, stride, dst); break;
+	case 4: PackAll<3, false, false>(source, count, stride, dst); break;
+	case 5: PackAll<3, false, true>(source, count, stride, dst); break;
+	case 6: PackAll<3, true, false>(source, count, stride, dst); break;
+	case 7: PackAll<3, true, true>(source, count, stride, dst); break;
+	}
+}
+
+struct MatrixSource
+{
+	const Matrix *in;
+
+	// T[r][c] is m[c*4 + r].
+	template <int Rows, bool RowMajor>
+	inline void Get(size_t i, float *f) const
+	{
+		const Scalar *m = in[i].Buff();
+		for (int c = 0; c < 4; ++c)
+			for (int r = 0; r < Rows; ++r)
+				f[Slot<Rows, RowMajor>(r, c)] = (float)m[c*4 + r];
+	}
+};
+
+struct TransformSource
+{
+	const Quaternion *rotations;
+	const Vec4 *positions;
+
+	// T of Matrix::Set(q, p), written straight from the quaternion: the rotated axes are its
+	// first 3 columns and p is the last.
+	template <int Rows, bool RowMajor>
+	inline void Get(size_t i, float *f) const
+	{
+		const Quaternion &q = rotations[i];
+		const Vec4 &p = positions[i];
+		Scalar x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+		Scalar wx = q.w*x2, wy = q.w*y2, wz = q.w*z2;
+		Scalar xx = q.x*x2, xy = q.x*y2, xz = q.x*z2;
+		Scalar yy = q.y*y2, yz = q.y*z2, zz = q.z*z2;
+
+		f[Slot<Rows, RowMajor>(0, 0)] = (float)(1 - (yy + zz));
+		f[Slot<Rows, RowMajor>(1, 0)] = (float)(xy + wz);
+		f[Slot<Rows, RowMajor>(2, 0)] = (float)(xz - wy);
+		f[Slot<Rows, RowMajor>(0, 1)] = (float)(xy - wz);
+		f[Slot<Rows, RowMajor>(1, 1)] = (float)(1 - (xx + zz));
+		f[Slot<Rows, RowMajor>(2, 1)] = (float)(yz + wx);
+		f[Slot<Rows, RowMajor>(0, 2)] = (float)(xz + wy);
+		f[Slot<Rows, RowMajor>(1, 2)] = (float)(yz - wx);
+		f[Slot<Rows, RowMajor>(2, 2)] = (float)(1 - (xx + yy));
+		f[Slot<Rows, RowMajor>(0, 3)] = (float)p.x;
+		f[Slot<Rows, RowMajor>(1, 3)] = (float)p.y;
+		f[Slot<Rows, RowMajor>(2, 3)] = (float)p.z;
+		if (Rows == 4)
+		{
+			f[Slot<Rows, RowMajor>(3, 0)] = 0;
+			f[Slot<Rows, RowMajor>(3, 1)] = 0;
+			f[Slot<Rows, RowMajor>(3, 2)] = 0;
+			f[Slot<Rows, RowMajor>(3, 3)] = 1;
+		}
+	}
+};
+
+void PackMatrices(const Matrix *in, size_t count, const PackLayout &layout, void *out)
+{
+	MatrixSource source = {in};
+	Pack(source, count, layout, out);
+}
+
+void PackTransforms(const Quaternion *rotations, const Vec4 *positions, size_t count, const PackLayout &layout, void *out)
+{
+	TransformSource source = {rotations, positions};
+	Pack(source, count, layout, out);
+}
+
+}  // namespace mathing
@@ -0,0 +1,213 @@
+#include "mathing/ik.h"
+
+#include <math.h>
+
+#include "quaternion_ops.h"
+
+#define IK_MIN_LENGTH 1e-12     // squared length below which a direction is too short to aim with
+
+namespace mathing
+{
+
+size_t IKChains::AddChain(size_t jointCount)
+{
+	size_t chain = m_JointStart.size();
+	m_JointStart.push_back(m_Local.size());
+	m_JointCount.push_back(jointCount);
+	m_RootPosition.push_back(Vec4(0, 0, 0, 1));
+	m_RootRotation.push_back(Quaternion());
+	m_Target.push_back(Vec4(0, 0, 0, 1));
+	m_Error.push_back(0);
+	m_Iterations.push_back(0);
+
+	m_Local.resize(m_Local.size() + jointCount);
+	m_Offset.resize(m_Offset.size() + jointCount);
+	m_LimitCos.resize(m_LimitCos.size() + jointCount, -1);
+	m_LimitSin.resize(m_LimitSin.size() + jointCount, 1);
+	m_WorldRot.resize(m_WorldRot.size() + jointCount);
+	m_WorldPos.resize(m_WorldPos.size() + jointCount + 1);
+	m_Reach.resize(m_Reach.size() + jointCount + 1);
+	return chain;
+}
+
+void IKChains::Clear()
+{
+	m_JointStart.clear();
+	m_JointCount.clear();
+	m_RootPosition.clear();
+	m_RootRotation.clear();
+	m_Target.clear();
+	m_Error.clear();
+	m_Iterations.clear();
+	m_Local.clear();
+	m_Offset.clear();
+	m_LimitCos.clear();
+	m_LimitSin.clear();
+	m_WorldRot.clear();
+	m_WorldPos.clear();
+	m_Reach.clear();
+}
+
+void IKChains::SetJointLimit(size_t chain, size_t joint, Scalar maxAngle)
+{
+	size_t j = m_JointStart[chain] + joint;
+	m_LimitCos[j] = cos(maxAngle / 2);
+	m_LimitSin[j] = sin(maxAngle / 2);
+}
+
+void IKChains::ClearJointLimit(size_t chain, size_t joint)
+{
+	size_t j = m_JointStart[chain] + joint;
+	m_LimitCos[j] = -1;
+	m_LimitSin[j] = 1;
+}
+
+void IKChains::UpdateWorldFrom(size_t chain, size_t joint)
+{
+	size_t start = m_JointStart[chain];
+	size_t count = m_JointCount[chain];
+	Vec4 *pos = &m_WorldPos[start + chain];
+
+	if (joint == 0)
+		pos[0] = m_RootPosition[chain];
+	for (size_t j = joint; j < count; ++j)
+	{
+		const Quaternion &parent = j == 0 ? m_RootRotation[chain] : m_WorldRot[start + j - 1];
+		m_WorldRot[start + j] = QuaternionMul(parent, m_Local[start + j]);
+		Vec4 offset = QuaternionRotate(m_WorldRot[start + j], m_Offset[start + j]);
+		pos[j + 1].Set(pos[j].x + offset.x, pos[j].y + offset.y, pos[j].z + offset.z, 1);
+	}
+}
+
+void IKChains::UpdateWorld(size_t begin, size_t end)
+{
+	if (end > ChainCount())
+		end = ChainCount();
+	for (size_t c = begin; c < end; ++c)
+	{
+		UpdateWorldFrom(c, 0);
+	}
+}
+
+// Turns a joint so the world direction \p from turns toward \p to, within the joint's limit,
+// and updates the world transforms after it.
+void IKChains::TurnJoint(size_t chain, size_t joint, const Vec4 &from, const Vec4 &to)
+{
+	Scalar fromLen = from.Length3Sqr();
+	Scalar toLen = to.Length3Sqr();
+	if (fromLen < IK_MIN_LENGTH || toLen < IK_MIN_LENGTH)
+		return;
+
+	// From-to rotation with the half way vector, (from x to, |from||to| + from.to), normalized.
+	Vec4 axis = Vec4::Cross(from, to);
+	Quaternion r(axis.x, axis.y, axis.z, sqrt(fromLen * toLen) + Vec4::Dot3(from, to));
+	if (r.x*r.x + r.y*r.y + r.z*r.z + r.w*r.w < IK_MIN_LENGTH)
+		return;  // Pointing directly away, there's no preferred way to turn.
+	QuaternionNormalize(r);
+
+	// The world rotation is parent * local. Turning it by r in world space is the same as turning
+	// the local rotation by r brought into the parent's space.
+	size_t j = m_JointStart[chain] + joint;
+	const Quaternion &parent = joint == 0 ? m_RootRotation[chain] : m_WorldRot[j - 1];
+	Quaternion parentInv = QuaternionConjugate(parent);
+	Quaternion &local = m_Local[j];
+	local = QuaternionMul(QuaternionMul(QuaternionMul(parentInv, r), parent), local);
+	QuaternionNormalize(local);
+
+	if (fabs(local.w) < m_LimitCos[j])
+	{
+		Scalar s = m_LimitSin[j] / sqrt(local.x*local.x + local.y*local.y + local.z*local.z);
+		local.Set(local.x * s, local.y * s, local.z * s, local.w < 0 ? -m_LimitCos[j] : m_LimitCos[j]);
+	}
+
+	UpdateWorldFrom(chain, joint);
+}
+
+void IKChains::SolveCCD(const IKSettings &settings, size_t begin, size_t end)
+{
+	if (end > ChainCount())
+		end = ChainCount();
+	Scalar tolSqr = settings.tolerance * settings.tolerance;
+
+	for (size_t c = begin; c < end; ++c)
+	{
+		size_t count = m_JointCount[c];
+		const Vec4 *pos = &m_WorldPos[m_JointStart[c] + c];
+		const Vec4 &target = m_Target[c];
+		UpdateWorldFrom(c, 0);
+
+		int iter = 0;
+		for (; iter < settings.maxIterations; ++iter)
+		{
+			if ((pos[count] - target).Length3Sqr() <= tolSqr)
+				break;
+			for (size_t j = count; j-- > 0;)
+			{
+				TurnJoint(c, j, pos[count] - pos[j], target - pos[j]);
+			}
+		}
+		m_Iterations[c] = iter;
+		m_Error[c] = (pos[count] - target).Length3();
+	}
+}
+
+void IKChains::SolveFABRIK(const IKSettings &settings, size_t begin, size_t end)
+{
+	if (end > ChainCount())
+		end = ChainCount();
+	Scalar tolSqr = settings.tolerance * settings.tolerance;
+
+	for (size_t c = begin; c < end; ++c)
+	{
+		size_t start = m_JointStart[c];
+		size_t count = m_JointCount[c];
+		const Vec4 *pos = &m_WorldPos[start + c];
+		Vec4 *reach = &m_Reach[start + c];
+		const Vec4 &target = m_Target[c];
+		const Vec4 &root = m_RootPosition[c];
+		UpdateWorldFrom(c, 0);
+
+		for (size_t j = 0; j <= count; ++j)
+			reach[j] = pos[j];
+
+		int iter = 0;
+		for (; iter < settings.maxIterations; ++iter)
+		{
+			if ((reach[count] - target).Length3Sqr() <= tolSqr)
+				break;
+
+			// Forward: pin the end effector to the target and drag the rest along.
+			reach[count] = target;
+			for (size_t j = count; j-- > 0;)
+			{
+				Vec4 d = reach[j] - reach[j + 1];
+				Scalar len = m_Offset[start + j].Length3();
+				Scalar dist = d.Length3();
+				if (dist > 0)
+					reach[j] = reach[j + 1] + d * (len / dist);
+			}
+
+			// Backward: pin the root back, and drag the rest the other way.
+			reach[0] = root;
+			for (size_t j = 0; j < count; ++j)
+			{
+				Vec4 d = reach[j + 1] - reach[j];
+				Scalar len = m_Offset[start + j].Length3();
+				Scalar dist = d.Length3();
+				if (dist > 0)
+					reach[j + 1] = reach[j] + d * (len / dist);
+			}
+		}
+
+		// Fit the rotations, root first, each joint aims at where the next one was solved to.
+		for (size_t j = 0; j < count; ++j)
+		{
+			TurnJoint(c, j, pos[j + 1] - pos[j], reach[j + 1] - pos[j]);
+		}
+
+		m_Iterations[c] = iter;
+		m_Error[c] = (pos[count] - target).Length3();
+	}
+}
+
+}  // namespace mathing
@@ -0,0 +1,193 @@
+#include "mathing/instrument.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+#ifdef MATHING_INSTRUMENT
+#include <chrono>
+#include <mutex>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define MATHING_HAVE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MATHING_HAVE_RDTSC
+#endif
+#endif
+
+namespace mathing
+{
+
+static const char *s_OpNames[INSTRUMENT_OP_COUNT] = {
+	"Matrix::operator*",
+	"Matrix::Inverse",
+	"Matrix::Transform",
+	"Quaternion::operator*",
+	"Quaternion::Slerp",
+	"Quaternion::FromMatrix",
+	"Quaternion::Rotate"
+};
+
+InstrumentCounts::InstrumentCounts()
+{
+	memset(calls, 0, sizeof(calls));
+	memset(sampledCalls, 0, sizeof(sampledCalls));
+	memset(sampledTicks, 0, sizeof(sampledTicks));
+}
+
+const char *InstrumentOpName(InstrumentOp op)
+{
+	return op >= 0 && op < INSTRUMENT_OP_COUNT ? s_OpNames[op] : "";
+}
+
+#ifdef MATHING_INSTRUMENT
+
+// Every running thread's counters, and the totals of the ones that finished.
+struct InstrumentRegistry
+{
+	std::mutex mutex;
+	std::vector<InstrumentThread *> threads;
+	InstrumentCounts finished;
+
+	static InstrumentRegistry &Get()
+	{
+		static InstrumentRegistry registry;
+		return registry;
+	}
+};
+
+uint64_t InstrumentTicks()
+{
+#ifdef MATHING_HAVE_RDTSC
+	return __rdtsc();
+#else
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+InstrumentThread::InstrumentThread()
+{
+	for (int op = 0; op < INSTRUMENT_OP_COUNT; ++op)
+	{
+		calls[op].store(0, std::memory_order_relaxed);
+		sampledCalls[op].store(0, std::memory_order_relaxed);
+		sampledTicks[op].store(0, std::memory_order_relaxed);
+	}
+	InstrumentRegistry &registry = InstrumentRegistry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.threads.push_back(this);
+}
+
+InstrumentThread::~InstrumentThread()
+{
+	InstrumentRegistry &registry = InstrumentRegistry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (int op = 0; op < INSTRUMENT_OP_COUNT; ++op)
+	{
+		registry.finished.calls[op] += calls[op].load(std::memory_order_relaxed);
+		registry.finished.sampledCalls[op] += sampledCalls[op].load(std::memory_order_relaxed);
+		registry.finished.sampledTicks[op] += sampledTicks[op].load(std::memory_order_relaxed);
+	}
+	registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+bool InstrumentEnabled()
+{
+	return true;
+}
+
+void InstrumentSnapshot(InstrumentCounts &out)
+{
+	InstrumentRegistry &registry = InstrumentRegistry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	out = registry.finished;
+	for (size_t i = 0; i < registry.threads.size(); ++i)
+	{
+		const InstrumentThread &t = *registry.threads[i];
+		for (int op = 0; op < INSTRUMENT_OP_COUNT; ++op)
+		{
+			out.calls[op] += t.calls[op].load(std::memory_order_relaxed);
+			out.sampledCalls[op] += t.sampledCalls[op].load(std::memory_order_relaxed);
+			out.sampledTicks[op] += t.sampledTicks[op].load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void InstrumentReset()
+{
+	InstrumentRegistry &registry = InstrumentRegistry::Get();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.finished = InstrumentCounts();
+	for (size_t i = 0; i < registry.threads.size(); ++i)
+	{
+		InstrumentThread &t = *registry.threads[i];
+		for (int op = 0; op < INSTRUMENT_OP_COUNT; ++op)
+		{
+			t.calls[op].store(0, std::memory_order_relaxed);
+			t.sampledCalls[op].store(0, std::memory_order_relaxed);
+			t.sampledTicks[op].store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+#else
+
+bool InstrumentEnabled()
+{
+	return false;
+}
+
+void InstrumentSnapshot(InstrumentCounts &out)
+{
+	out = InstrumentCounts();
+}
+
+void InstrumentReset()
+{
+}
+
+#endif  // MATHING_INSTRUMENT
+
+// Estimated ticks of all the calls of op, from the timed ones.
+static inline double TotalTicks(const InstrumentCounts &counts, int op)
+{
+	if (counts.sampledCalls[op] == 0)
+		return 0;
+	return (double)counts.sampledTicks[op] / counts.sampledCalls[op] * counts.calls[op];
+}
+
+void InstrumentReport(std::ostream &os, const InstrumentCounts &counts)
+{
+	std::vector<int> ops;
+	for (int op = 0; op < INSTRUMENT_OP_COUNT; ++op)
+	{
+		if (counts.calls[op])
+			ops.push_back(op);
+	}
+	std::stable_sort(ops.begin(), ops.end(), [&counts](int a, int b) {
+		return TotalTicks(counts, a) > TotalTicks(counts, b);
+	});
+
+	std::ios_base::fmtflags flags = os.flags();
+	std::streamsize precision = os.precision();
+	os << std::left << std::setw(24) << "operation" << std::right << std::setw(14) << "calls"
+		<< std::setw(14) << "ticks/call" << std::setw(18) << "total ticks" << "\n";
+	os << std::fixed << std::setprecision(1);
+	for (size_t i = 0; i < ops.size(); ++i)
+	{
+		int op = ops[i];
+		double perCall = counts.sampledCalls[op] ? (double)counts.sampledTicks[op] / counts.sampledCalls[op] : 0;
+		os << std::left << std::setw(24) << s_OpNames[op] << std::right << std::setw(14) << counts.calls[op]
+			<< std::setw(14) << perCall << std::setw(18) << std::setprecision(0) << TotalTicks(counts, op)
+			<< std::setprecision(1) << "\n";
+	}
+	os.flags(flags);
+	os.precision(precision);
+}
+
+}  // namespace mathing
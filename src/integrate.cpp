@@ -0,0 +1,83 @@
+#include "mathing/integrate.h"
+
+#include <math.h>
+
+#include "quaternion_ops.h"
+
+#define EXPMAP_SMALL_ANGLE 1e-4     // below this half angle, sin(x)/x is replaced by its series
+
+namespace mathing
+{
+
+// Both integrators share everything except how the orientation is stepped, which is a
+// template parameter so the loop has no branch on it.
+template <bool ExpMap>
+static void Integrate(const RigidBodyArrays &bodies, Scalar dt, size_t begin, size_t end)
+{
+	if (end > bodies.count)
+		end = bodies.count;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		Vec4 &p = bodies.position[i];
+		Vec4 &v = bodies.velocity[i];
+		Quaternion &q = bodies.orientation[i];
+		Vec4 &w = bodies.angularVelocity[i];
+
+		if (bodies.acceleration)
+		{
+			const Vec4 &a = bodies.acceleration[i];
+			v.x += a.x * dt;
+			v.y += a.y * dt;
+			v.z += a.z * dt;
+		}
+		if (bodies.angularAcceleration)
+		{
+			const Vec4 &a = bodies.angularAcceleration[i];
+			w.x += a.x * dt;
+			w.y += a.y * dt;
+			w.z += a.z * dt;
+		}
+
+		p.x += v.x * dt;
+		p.y += v.y * dt;
+		p.z += v.z * dt;
+
+		// The rotation to apply in front of q.
+		Quaternion d;
+		if (ExpMap)
+		{
+			// exp(1/2 w dt) = (sin(h) w/|w|, cos(h)), with h = |w| dt / 2
+			Scalar hx = w.x * dt * 0.5;
+			Scalar hy = w.y * dt * 0.5;
+			Scalar hz = w.z * dt * 0.5;
+			Scalar hSqr = hx*hx + hy*hy + hz*hz;
+			Scalar h = sqrt(hSqr);
+			Scalar sinc = h > EXPMAP_SMALL_ANGLE ? sin(h) / h : 1 - hSqr / 6;
+			d.Set(hx * sinc, hy * sinc, hz * sinc, cos(h));
+		}
+		else
+		{
+			// q + 1/2 (w, 0) q dt = (1 + 1/2 (w dt, 0)) q
+			d.Set(w.x * dt * 0.5, w.y * dt * 0.5, w.z * dt * 0.5, 1);
+		}
+
+		q = QuaternionMul(d, q);
+		QuaternionNormalize(q);
+
+		if (bodies.world)
+			bodies.world[i].Set(q, p);
+	}
+}
+
+void IntegrateEuler(const RigidBodyArrays &bodies, Scalar dt, size_t begin, size_t end)
+{
+	Integrate<false>(bodies, dt, begin, end);
+}
+
+void IntegrateExpMap(const RigidBodyArrays &bodies, Scalar dt, size_t begin, size_t end)
+{
+	Integrate<true>(bodies, dt, begin, end);
+}
+
+}  // namespace mathing
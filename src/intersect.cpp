@@ -0,0 +1,155 @@
+#include "mathing/intersect.h"
+
+#include <math.h>
+
+#define DET_EPSILON 1e-12     // rays closer than this to parallel with a triangle are misses
+
+namespace mathing
+{
+
+// One slab of the box test, narrows [tNear, tFar] to the slab between lo and hi.
+// Written as selects rather than branches, so the packet loops stay vectorizable.
+static inline void Slab(Scalar lo, Scalar hi, Scalar o, Scalar invD, Scalar &tNear, Scalar &tFar)
+{
+	Scalar t0 = (lo - o) * invD;
+	Scalar t1 = (hi - o) * invD;
+	Scalar ta = t0 < t1 ? t0 : t1;
+	Scalar tb = t0 < t1 ? t1 : t0;
+	tNear = ta > tNear ? ta : tNear;
+	tFar = tb < tFar ? tb : tFar;
+}
+
+bool IntersectTriangle(const Vec4 &origin, const Vec4 &dir,
+	const Vec4 &v0, const Vec4 &v1, const Vec4 &v2,
+	Scalar &t, Scalar &u, Scalar &v,
+	Scalar tmin, Scalar tmax)
+{
+	Vec4 e1 = v1 - v0;
+	Vec4 e2 = v2 - v0;
+
+	Vec4 p = Vec4::Cross(dir, e2);
+	Scalar det = Vec4::Dot3(e1, p);
+	if (fabs(det) < DET_EPSILON)
+		return false;
+	Scalar invDet = 1 / det;
+
+	Vec4 s = origin - v0;
+	u = Vec4::Dot3(s, p) * invDet;
+	if (u < 0 || u > 1)
+		return false;
+
+	Vec4 q = Vec4::Cross(s, e1);
+	v = Vec4::Dot3(dir, q) * invDet;
+	if (v < 0 || u + v > 1)
+		return false;
+
+	t = Vec4::Dot3(e2, q) * invDet;
+	return t > tmin && t < tmax;
+}
+
+bool IntersectBox(const Vec4 &origin, const Vec4 &dir,
+	const Vec4 &boxMin, const Vec4 &boxMax,
+	Scalar &tNear, Scalar &tFar,
+	Scalar tmin, Scalar tmax)
+{
+	tNear = tmin;
+	tFar = tmax;
+	Slab(boxMin.x, boxMax.x, origin.x, 1 / dir.x, tNear, tFar);
+	Slab(boxMin.y, boxMax.y, origin.y, 1 / dir.y, tNear, tFar);
+	Slab(boxMin.z, boxMax.z, origin.z, 1 / dir.z, tNear, tFar);
+	return tNear <= tFar;
+}
+
+template <int N>
+unsigned int IntersectTriangle(const RayPacket<N> &rays,
+	const Vec4 &v0, const Vec4 &v1, const Vec4 &v2,
+	PacketHit<N> &hit, int prim)
+{
+	// Everything about the triangle is shared by the lanes, the rest is done per lane
+	// with the cross and dot products expanded, since the lanes aren't Vec4's.
+	Scalar e1x = v1.x - v0.x, e1y = v1.y - v0.y, e1z = v1.z - v0.z;
+	Scalar e2x = v2.x - v0.x, e2y = v2.y - v0.y, e2z = v2.z - v0.z;
+
+	unsigned int mask = 0;
+	for (int i = 0; i < N; ++i)
+	{
+		// p = d x e2
+		Scalar px = rays.dy[i] * e2z - e2y * rays.dz[i];
+		Scalar py = rays.dz[i] * e2x - e2z * rays.dx[i];
+		Scalar pz = rays.dx[i] * e2y - e2x * rays.dy[i];
+		Scalar det = e1x * px + e1y * py + e1z * pz;
+		bool valid = fabs(det) >= DET_EPSILON;
+		Scalar invDet = 1 / (valid ? det : 1);
+
+		// s = o - v0
+		Scalar sx = rays.ox[i] - v0.x;
+		Scalar sy = rays.oy[i] - v0.y;
+		Scalar sz = rays.oz[i] - v0.z;
+		Scalar u = (sx * px + sy * py + sz * pz) * invDet;
+
+		// q = s x e1
+		Scalar qx = sy * e1z - e1y * sz;
+		Scalar qy = sz * e1x - e1z * sx;
+		Scalar qz = sx * e1y - e1x * sy;
+		Scalar v = (rays.dx[i] * qx + rays.dy[i] * qy + rays.dz[i] * qz) * invDet;
+		Scalar t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+		bool accept = valid & (u >= 0) & (v >= 0) & (u + v <= 1) & (t > rays.tMin[i]) & (t < hit.t[i]);
+
+		hit.t[i] = accept ? t : hit.t[i];
+		hit.u[i] = accept ? u : hit.u[i];
+		hit.v[i] = accept ? v : hit.v[i];
+		hit.prim[i] = accept ? prim : hit.prim[i];
+		mask |= (unsigned int)accept << i;
+	}
+	return mask;
+}
+
+template <int N>
+unsigned int IntersectTriangles(const RayPacket<N> &rays,
+	const Vec4 *verts, int triCount,
+	PacketHit<N> &hit)
+{
+	unsigned int mask = 0;
+	for (int tri = 0; tri < triCount; ++tri)
+	{
+		mask |= IntersectTriangle(rays, verts[tri*3], verts[tri*3 + 1], verts[tri*3 + 2], hit, tri);
+	}
+	return mask;
+}
+
+template <int N>
+unsigned int IntersectBox(const RayPacket<N> &rays,
+	const Vec4 &boxMin, const Vec4 &boxMax,
+	Scalar tNear[N])
+{
+	unsigned int mask = 0;
+	for (int i = 0; i < N; ++i)
+	{
+		Scalar tn = rays.tMin[i];
+		Scalar tf = rays.tMax[i];
+		Slab(boxMin.x, boxMax.x, rays.ox[i], rays.idx[i], tn, tf);
+		Slab(boxMin.y, boxMax.y, rays.oy[i], rays.idy[i], tn, tf);
+		Slab(boxMin.z, boxMax.z, rays.oz[i], rays.idz[i], tn, tf);
+		tNear[i] = tn;
+		mask |= (unsigned int)(tn <= tf) << i;
+	}
+	return mask;
+}
+
+// The packet sizes we support. The definitions stay in here, so the header stays light.
+#define MATHING_INSTANTIATE_PACKET(N) \
+	template unsigned int IntersectTriangle<N>(const RayPacket<N> &, \
+		const Vec4 &, const Vec4 &, const Vec4 &, PacketHit<N> &, int); \
+	template unsigned int IntersectTriangles<N>(const RayPacket<N> &, \
+		const Vec4 *, int, PacketHit<N> &); \
+	template unsigned int IntersectBox<N>(const RayPacket<N> &, \
+		const Vec4 &, const Vec4 &, Scalar[N]);
+
+MATHING_INSTANTIATE_PACKET(4)
+MATHING_INSTANTIATE_PACKET(8)
+MATHING_INSTANTIATE_PACKET(16)
+
+#undef MATHING_INSTANTIATE_PACKET
+
+}  // namespace mathing
@@ -1,8 +1,16 @@
 #include "mathing/matrix.h"
 
+#include <math.h>
+
 #include <iostream>
 #include <iomanip>      // std::setprecision
 
+#define MATRIX_POLAR_ITERATIONS 16        // most Newton steps of the polar decomposition
+#define MATRIX_POLAR_EPSILON 1e-28        // squared change in the axes a polar step stops at
+#define MATRIX_SINGULAR_EPSILON 1e-24     // |determinant| under which the axes are dependent
+#define MATRIX_DRIFT_EPSILON 1e-10        // OrthonormalDrift() past which a matrix is drifted
+#define LOOKAT_EPSILON 1e-24              // squared length below which a look direction or side axis is degenerate
+
 using namespace std;
 
 namespace mathing
@@ -12,6 +20,7 @@ static Scalar identity[16] = {1, 0, 0, 0,
 							  0, 0, 1, 0,
 							  0, 0, 0, 1};
 const MatrixCppImpl4x4 MatrixCppImpl4x4::m_Identity(identity);
+const Scalar Matrix::m_DriftEpsilon = MATRIX_DRIFT_EPSILON;
 
 //
 // Constructors
@@ -288,13 +297,302 @@ const MatrixCppImpl4x4 MatrixCppImpl4x4::m_Identity(identity);
 // 	return ret;
 // }
 
+// Packed points or directions through the matrix, Translate is false for directions.
+template <bool Translate, typename T>
+static inline void TransformPacked(const Scalar *m, const Vec3T<T> *in, Vec3T<T> *out, size_t count)
+{
+	// Copied out of the matrix, so the stores to out can't change them.
+	Scalar m0 = m[0], m1 = m[1], m2 = m[2];
+	Scalar m4 = m[4], m5 = m[5], m6 = m[6];
+	Scalar m8 = m[8], m9 = m[9], m10 = m[10];
+	Scalar tx = Translate ? m[12] : 0, ty = Translate ? m[13] : 0, tz = Translate ? m[14] : 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Scalar x = in[i].x, y = in[i].y, z = in[i].z;
+		out[i].x = (T)(x*m0 + y*m4 + z*m8 + tx);
+		out[i].y = (T)(x*m1 + y*m5 + z*m9 + ty);
+		out[i].z = (T)(x*m2 + y*m6 + z*m10 + tz);
+	}
+}
+
+void Matrix::Transform(const Vec3f *in, Vec3f *out, size_t count) const
+{
+	TransformPacked<true>(Buff(), in, out, count);
+}
+
+void Matrix::Transform(const Vec3d *in, Vec3d *out, size_t count) const
+{
+	TransformPacked<true>(Buff(), in, out, count);
+}
+
+void Matrix::Rotate(const Vec3f *in, Vec3f *out, size_t count) const
+{
+	TransformPacked<false>(Buff(), in, out, count);
+}
+
+void Matrix::Rotate(const Vec3d *in, Vec3d *out, size_t count) const
+{
+	TransformPacked<false>(Buff(), in, out, count);
+}
+
+unsigned Matrix::ToClip(const Vec4 *in, Vec4 *out, unsigned char *outcodes, size_t count) const
+{
+	// Copied out of the matrix, so the stores to out can't change them.
+	const Scalar *m = Buff();
+	Scalar m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3];
+	Scalar m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7];
+	Scalar m8 = m[8], m9 = m[9], m10 = m[10], m11 = m[11];
+	Scalar m12 = m[12], m13 = m[13], m14 = m[14], m15 = m[15];
+	unsigned all = CLIP_ALL;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Scalar x = in[i].x, y = in[i].y, z = in[i].z;
+		Scalar cx = x*m0 + y*m4 + z*m8 + m12;
+		Scalar cy = x*m1 + y*m5 + z*m9 + m13;
+		Scalar cz = x*m2 + y*m6 + z*m10 + m14;
+		Scalar cw = x*m3 + y*m7 + z*m11 + m15;
+
+		// One point at a time: across points the interleaved Vec4s cost more in shuffles than the
+		// vector math saves.
+		unsigned code = (cx < -cw ? CLIP_LEFT : 0) | (cx > cw ? CLIP_RIGHT : 0) |
+			(cy < -cw ? CLIP_BOTTOM : 0) | (cy > cw ? CLIP_TOP : 0) |
+			(cz < 0 ? CLIP_NEAR : 0) | (cz > cw ? CLIP_FAR : 0);
+		outcodes[i] = (unsigned char)code;
+		all &= code;
+
+		bool front = cw > 0;
+		Scalar invW = 1 / (front ? cw : 1);
+		Scalar s = front ? invW : 1;
+		out[i].x = cx * s;
+		out[i].y = cy * s;
+		out[i].z = cz * s;
+		out[i].w = front ? invW : cw;
+	}
+	return count ? all : 0;
+}
+
+void MatrixCppImpl4x4::SetLookAt(const Vec4 &eye, const Vec4 &target, const Vec4 &up)
+{
+	Scalar zx = target.x - eye.x;
+	Scalar zy = target.y - eye.y;
+	Scalar zz = target.z - eye.z;
+	Scalar lenSqr = zx*zx + zy*zy + zz*zz;
+	if (lenSqr < LOOKAT_EPSILON)
+	{
+		zx = 0;
+		zy = 0;
+		zz = 1;
+	}
+	else
+	{
+		Scalar invLen = 1 / sqrt(lenSqr);
+		zx *= invLen;
+		zy *= invLen;
+		zz *= invLen;
+	}
+
+	// X = up x Z
+	Scalar xx = up.y*zz - up.z*zy;
+	Scalar xy = up.z*zx - up.x*zz;
+	Scalar xz = up.x*zy - up.y*zx;
+	lenSqr = xx*xx + xy*xy + xz*xz;
+	if (lenSqr < LOOKAT_EPSILON * (up.x*up.x + up.y*up.y + up.z*up.z) || lenSqr == 0)
+	{
+		// Cross with the axis Z has the smallest component along, (1, 0, 0) x Z and so on.
+		Scalar ax = fabs(zx), ay = fabs(zy), az = fabs(zz);
+		if (ax <= ay && ax <= az)
+		{
+			xx = 0;		xy = -zz;	xz = zy;
+		}
+		else if (ay <= az)
+		{
+			xx = zz;	xy = 0;		xz = -zx;
+		}
+		else
+		{
+			xx = -zy;	xy = zx;	xz = 0;
+		}
+		lenSqr = xx*xx + xy*xy + xz*xz;
+	}
+	Scalar invLen = 1 / sqrt(lenSqr);
+	xx *= invLen;
+	xy *= invLen;
+	xz *= invLen;
+
+	// Y = Z x X, already unit length
+	m[ 0] = xx;					m[ 1] = xy;					m[ 2] = xz;					m[ 3] = 0;
+	m[ 4] = zy*xz - zz*xy;		m[ 5] = zz*xx - zx*xz;		m[ 6] = zx*xy - zy*xx;		m[ 7] = 0;
+	m[ 8] = zx;					m[ 9] = zy;					m[10] = zz;					m[11] = 0;
+	m[12] = eye.x;				m[13] = eye.y;				m[14] = eye.z;				m[15] = 1;
+}
+
+void MatrixCppImpl4x4::SetPerspective(Scalar fovY, Scalar aspect, Scalar zNear, Scalar zFar)
+{
+	Scalar f = 1 / tan(fovY * 0.5);
+	Scalar depth = zFar / (zFar - zNear);
+	m[ 0] = f / aspect;	m[ 1] = 0;	m[ 2] = 0;				m[ 3] = 0;
+	m[ 4] = 0;			m[ 5] = f;	m[ 6] = 0;				m[ 7] = 0;
+	m[ 8] = 0;			m[ 9] = 0;	m[10] = depth;			m[11] = 1;
+	m[12] = 0;			m[13] = 0;	m[14] = -zNear * depth;	m[15] = 0;
+}
+
+void Matrix::LookAt(const Vec4 *eyes, const Vec4 *targets, const Vec4 &up, Matrix *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i]._impl.SetLookAt(eyes[i], targets[i], up);
+	}
+}
+
+Matrix Matrix::Inverse() const
+{
+	MATHING_INSTRUMENT_SCOPE(INSTRUMENT_MATRIX_INVERSE);
+	return Matrix(_impl.Inverse());
+}
+
+Matrix Matrix::Transpose() const
+{
+	return Matrix(_impl.Transpose());
+}
+
+Scalar Matrix::OrthonormalDrift() const
+{
+	const Vec4 &x = AxisX(), &y = AxisY(), &z = AxisZ();
+	Scalar drift = fabs(Vec4::Dot3(x, x) - 1);
+	drift = fmax(drift, fabs(Vec4::Dot3(y, y) - 1));
+	drift = fmax(drift, fabs(Vec4::Dot3(z, z) - 1));
+	drift = fmax(drift, fabs(Vec4::Dot3(x, y)));
+	drift = fmax(drift, fabs(Vec4::Dot3(y, z)));
+	drift = fmax(drift, fabs(Vec4::Dot3(z, x)));
+	return drift;
+}
+
+void Matrix::OrthonormalizeGramSchmidt()
+{
+	Vec4 &x = AxisX(), &y = AxisY(), &z = AxisZ();
+	x.w = 0;
+	x.Normalize3();
+	y = y - x * Vec4::Dot3(x, y);
+	y.w = 0;
+	y.Normalize3();
+	z = Vec4::Cross(x, y);
+}
+
+// Polar decomposition of the axes (rows) a, b, c, by the scaled Newton iteration
+// R = (g R + R^-T / g) / 2, where R^-T has the rows (b x c, c x a, a x b) / det and g is
+// |det|^-1/3. Returns false, leaving them alone, if they're nearly dependent.
+static bool PolarRotation(Vec4 &a, Vec4 &b, Vec4 &c)
+{
+	for (int i = 0; i < MATRIX_POLAR_ITERATIONS; ++i)
+	{
+		Vec4 ca = Vec4::Cross(b, c), cb = Vec4::Cross(c, a), cc = Vec4::Cross(a, b);
+		Scalar det = Vec4::Dot3(a, ca);
+		if (fabs(det) < MATRIX_SINGULAR_EPSILON)
+			return false;
+		Scalar g = 1 / cbrt(fabs(det));
+		Scalar h = 1 / (g * det);
+		Vec4 na = (a * g + ca * h) * 0.5;
+		Vec4 nb = (b * g + cb * h) * 0.5;
+		Vec4 nc = (c * g + cc * h) * 0.5;
+		Vec4 da = na - a, db = nb - b, dc = nc - c;
+		Scalar change = Vec4::Dot3(da, da) + Vec4::Dot3(db, db) + Vec4::Dot3(dc, dc);
+		a = na;
+		b = nb;
+		c = nc;
+		a.w = b.w = c.w = 0;
+		if (change < MATRIX_POLAR_EPSILON)
+			break;
+	}
+	return true;
+}
+
+void Matrix::OrthonormalizePolar()
+{
+	Vec4 x = AxisX(), y = AxisY(), z = AxisZ();
+	if (!PolarRotation(x, y, z))
+	{
+		OrthonormalizeGramSchmidt();
+		return;
+	}
+	AxisX() = x;
+	AxisY() = y;
+	AxisZ() = z;
+}
+
+size_t Matrix::OrthonormalizeGramSchmidt(Matrix *m, size_t count, Scalar epsilon)
+{
+	size_t fixed = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (m[i].IsDrifted(epsilon))
+		{
+			m[i].OrthonormalizeGramSchmidt();
+			++fixed;
+		}
+	}
+	return fixed;
+}
+
+size_t Matrix::OrthonormalizePolar(Matrix *m, size_t count, Scalar epsilon)
+{
+	size_t fixed = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (m[i].IsDrifted(epsilon))
+		{
+			m[i].OrthonormalizePolar();
+			++fixed;
+		}
+	}
+	return fixed;
+}
+
+bool Matrix::Decompose(Quaternion &rotation, Vec4 &scale, Vec4 &position) const
+{
+	position = Pos();
+	Vec4 x = AxisX(), y = AxisY(), z = AxisZ();
+
+	// A reflection is taken out as a flip of Z, so what's left is a rotation.
+	Scalar flip = Vec4::Dot3(Vec4::Cross(x, y), z) < 0 ? -1 : 1;
+	z = z * flip;
+	Vec4 rx = x, ry = y, rz = z;
+	if (!PolarRotation(rx, ry, rz))
+	{
+		rotation = Quaternion();
+		scale.Set(x.Length3(), y.Length3(), z.Length3() * flip, 0);
+		return false;
+	}
+
+	// The scale along each axis is how much of it lies along its rotated axis.
+	scale.Set(Vec4::Dot3(x, rx), Vec4::Dot3(y, ry), Vec4::Dot3(z, rz) * flip, 0);
+	rotation.FromMatrix(Matrix(rx, ry, rz));
+	rotation.Normalize();
+	return true;
+}
+
+size_t Matrix::Decompose(const Matrix *m, Quaternion *rotation, Vec4 *scale, Vec4 *position, size_t count)
+{
+	size_t decomposed = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (m[i].Decompose(rotation[i], scale[i], position[i]))
+			++decomposed;
+	}
+	return decomposed;
+}
+
 ostream &operator<<(ostream &os, const MatrixCppImpl4x4 &m)
 {
+	// Put the stream back the way it was after, the fixed 2 decimals are only for this.
+	std::ios_base::fmtflags flags = os.flags();
+	std::streamsize precision = os.precision();
 	os << std::fixed << std::setprecision(2);
     os << "[" << std::setw(5) << m.AxisX().x << ", " << std::setw(5) << m.AxisX().y << ", " << std::setw(5) << m.AxisX().z << ", " << std::setw(5) << m.AxisX().w << "]\n";
     os << "[" << std::setw(5) << m.AxisY().x << ", " << std::setw(5) << m.AxisY().y << ", " << std::setw(5) << m.AxisY().z << ", " << std::setw(5) << m.AxisY().w << "]\n";
     os << "[" << std::setw(5) << m.AxisZ().x << ", " << std::setw(5) << m.AxisZ().y << ", " << std::setw(5) << m.AxisZ().z << ", " << std::setw(5) << m.AxisZ().w << "]\n";
     os << "[" << std::setw(5) << m.Pos().x << ", "   << std::setw(5) << m.Pos().y << ", "   << std::setw(5) << m.Pos().z << ", "   << std::setw(5) << m.Pos().w << "]";
+	os.flags(flags);
+	os.precision(precision);
 	return os;
 }
 
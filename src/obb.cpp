@@ -0,0 +1,165 @@
+#include "mathing/obb.h"
+
+#include <math.h>
+
+#define OBB_BLOCK 8           // pairs tested together in the batch versions
+#define OBB_EPSILON 1e-9      // keeps the edge axes of near parallel edges from separating falsely
+
+namespace mathing
+{
+
+// The 15 axis test for a block of box pairs, in structure-of-arrays so each step of the test
+// runs across all the lanes. Everything is in the frame of box A, from Ericson's
+// "Real-Time Collision Detection", 4.4.1.
+struct ObbBlock
+{
+	Scalar R[3][3][OBB_BLOCK];      // B's axes in A's frame, R[i][j] = A_i . B_j
+	Scalar absR[3][3][OBB_BLOCK];
+	Scalar t[3][OBB_BLOCK];         // B's center in A's frame
+	Scalar a[3][OBB_BLOCK];
+	Scalar b[3][OBB_BLOCK];
+	int separated[OBB_BLOCK];
+	int lanes;
+
+	inline void Load(int k, const Matrix &poseA, const Vec4 &halfA, const Matrix &poseB, const Vec4 &halfB)
+	{
+		const Scalar *mA = poseA.Buff();
+		const Scalar *mB = poseB.Buff();
+		Scalar dx = mB[12] - mA[12];
+		Scalar dy = mB[13] - mA[13];
+		Scalar dz = mB[14] - mA[14];
+		for (int i = 0; i < 3; ++i)
+		{
+			const Scalar *ai = mA + i*4;
+			for (int j = 0; j < 3; ++j)
+			{
+				const Scalar *bj = mB + j*4;
+				R[i][j][k] = ai[0]*bj[0] + ai[1]*bj[1] + ai[2]*bj[2];
+				absR[i][j][k] = fabs(R[i][j][k]) + OBB_EPSILON;
+			}
+			t[i][k] = dx*ai[0] + dy*ai[1] + dz*ai[2];
+		}
+		a[0][k] = halfA.x;	a[1][k] = halfA.y;	a[2][k] = halfA.z;
+		b[0][k] = halfB.x;	b[1][k] = halfB.y;	b[2][k] = halfB.z;
+	}
+
+	// Returns true if every lane is separated.
+	inline bool FaceAxes()
+	{
+		int all = 1;
+		for (int k = 0; k < lanes; ++k)
+		{
+			int sep = 0;
+			for (int i = 0; i < 3; ++i)
+			{
+				Scalar ra = a[i][k];
+				Scalar rb = b[0][k]*absR[i][0][k] + b[1][k]*absR[i][1][k] + b[2][k]*absR[i][2][k];
+				sep |= fabs(t[i][k]) > ra + rb;
+			}
+			for (int j = 0; j < 3; ++j)
+			{
+				Scalar ra = a[0][k]*absR[0][j][k] + a[1][k]*absR[1][j][k] + a[2][k]*absR[2][j][k];
+				Scalar rb = b[j][k];
+				Scalar d = t[0][k]*R[0][j][k] + t[1][k]*R[1][j][k] + t[2][k]*R[2][j][k];
+				sep |= fabs(d) > ra + rb;
+			}
+			separated[k] = sep;
+			all &= sep;
+		}
+		return all != 0;
+	}
+
+	inline void EdgeAxes()
+	{
+		for (int k = 0; k < lanes; ++k)
+		{
+			int sep = separated[k];
+			for (int i = 0; i < 3; ++i)
+			{
+				int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+				for (int j = 0; j < 3; ++j)
+				{
+					int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+					// L = A_i x B_j
+					Scalar ra = a[i1][k]*absR[i2][j][k] + a[i2][k]*absR[i1][j][k];
+					Scalar rb = b[j1][k]*absR[i][j2][k] + b[j2][k]*absR[i][j1][k];
+					Scalar d = t[i2][k]*R[i1][j][k] - t[i1][k]*R[i2][j][k];
+					sep |= fabs(d) > ra + rb;
+				}
+			}
+			separated[k] = sep;
+		}
+	}
+};
+
+bool ObbOverlap(const Matrix &poseA, const Vec4 &halfA, const Matrix &poseB, const Vec4 &halfB)
+{
+	ObbBlock block;
+	block.lanes = 1;
+	block.Load(0, poseA, halfA, poseB, halfB);
+	if (block.FaceAxes())
+		return false;
+	block.EdgeAxes();
+	return !block.separated[0];
+}
+
+bool ObbSphereOverlap(const Matrix &pose, const Vec4 &half, const Vec4 &center, Scalar radius)
+{
+	// Distance from the center to the closest point in the box, along each box axis.
+	const Scalar *m = pose.Buff();
+	Scalar dx = center.x - m[12];
+	Scalar dy = center.y - m[13];
+	Scalar dz = center.z - m[14];
+	const Scalar h[3] = {half.x, half.y, half.z};
+
+	Scalar distSqr = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		const Scalar *axis = m + i*4;
+		Scalar d = fabs(dx*axis[0] + dy*axis[1] + dz*axis[2]) - h[i];
+		d = d > 0 ? d : 0;
+		distSqr += d*d;
+	}
+	return distSqr <= radius*radius;
+}
+
+size_t ObbOverlap(const Matrix *poses, const Vec4 *halfExtents,
+	const uint32_t *pairs, size_t pairCount, bool *overlaps)
+{
+	size_t count = 0;
+	ObbBlock block;
+	for (size_t start = 0; start < pairCount; start += OBB_BLOCK)
+	{
+		block.lanes = pairCount - start < OBB_BLOCK ? (int)(pairCount - start) : OBB_BLOCK;
+		for (int k = 0; k < block.lanes; ++k)
+		{
+			uint32_t ia = pairs[(start + k)*2];
+			uint32_t ib = pairs[(start + k)*2 + 1];
+			block.Load(k, poses[ia], halfExtents[ia], poses[ib], halfExtents[ib]);
+		}
+
+		if (!block.FaceAxes())
+			block.EdgeAxes();
+
+		for (int k = 0; k < block.lanes; ++k)
+		{
+			overlaps[start + k] = !block.separated[k];
+			count += !block.separated[k];
+		}
+	}
+	return count;
+}
+
+size_t ObbSphereOverlap(const Matrix *poses, const Vec4 *halfExtents,
+	const Vec4 *centers, const Scalar *radii, size_t count, bool *overlaps)
+{
+	size_t found = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		overlaps[i] = ObbSphereOverlap(poses[i], halfExtents[i], centers[i], radii[i]);
+		found += overlaps[i];
+	}
+	return found;
+}
+
+}  // namespace mathing
@@ -0,0 +1,241 @@
+#include "mathing/point_stream.h"
+
+#include <string.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "mathing/vec3.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MATHING_HAVE_MMAP
+#endif
+
+namespace mathing
+{
+
+template <typename From, typename To>
+static inline void Convert(const Vec3T<From> *in, Vec3T<To> *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		out[i].Set((To)in[i].x, (To)in[i].y, (To)in[i].z);
+}
+
+// Reads a FILE a chunk at a time on its own thread, for the whole run, into two buffers that it
+// takes turns with: while one is processed, the next chunk is read into the other.
+class ReadAhead
+{
+public:
+	ReadAhead(FILE *in, size_t chunkBytes)
+		: m_In(in), m_ChunkBytes(chunkBytes), m_Stop(false)
+	{
+		for (int k = 0; k < 2; ++k)
+		{
+			m_Buffer[k].resize(chunkBytes);
+			m_Got[k] = 0;
+			m_Full[k] = false;
+		}
+		m_Thread = std::thread(&ReadAhead::Read, this);
+	}
+
+	~ReadAhead()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_Changed.notify_all();
+		m_Thread.join();
+	}
+
+	// Waits for buffer \p k to be read, and returns it with the bytes in it, 0 at the end.
+	const char *Take(int k, size_t &got)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Changed.wait(lock, [this, k]() { return m_Full[k]; });
+		got = m_Got[k];
+		return &m_Buffer[k][0];
+	}
+
+	// Hands buffer \p k back to be read into again.
+	void Release(int k)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Full[k] = false;
+		}
+		m_Changed.notify_all();
+	}
+
+private:
+	ReadAhead(const ReadAhead &);
+	ReadAhead &operator=(const ReadAhead &);
+
+	void Read()
+	{
+		// A short read is the end of the file, and nothing is read after it.
+		size_t got = m_ChunkBytes;
+		for (int k = 0; got == m_ChunkBytes; k ^= 1)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Changed.wait(lock, [this, k]() { return m_Stop || !m_Full[k]; });
+				if (m_Stop)
+					return;
+			}
+			got = fread(&m_Buffer[k][0], 1, m_ChunkBytes, m_In);
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Got[k] = got;
+				m_Full[k] = true;
+			}
+			m_Changed.notify_all();
+		}
+	}
+
+	FILE *m_In;
+	size_t m_ChunkBytes;
+	std::vector<char> m_Buffer[2];
+	size_t m_Got[2];
+	bool m_Full[2];
+	bool m_Stop;
+	std::mutex m_Mutex;
+	std::condition_variable m_Changed;
+	std::thread m_Thread;
+};
+
+PointTransformer::PointTransformer(const Matrix &transform, Type inType, Type outType, size_t chunkPoints)
+	: m_Transform(transform), m_InType(inType), m_OutType(outType),
+	m_ChunkPoints(chunkPoints ? chunkPoints : 1), m_PointCount(0),
+	m_Out(m_ChunkPoints * PointBytes(outType))
+{
+}
+
+bool PointTransformer::Process(const char *in, size_t count, FILE *out)
+{
+	// The same type goes straight through the transform, otherwise it's converted in the output
+	// buffer and transformed there.
+	if (m_OutType == FLOAT32)
+	{
+		Vec3f *dst = (Vec3f *)&m_Out[0];
+		if (m_InType == FLOAT32)
+		{
+			m_Transform.Transform((const Vec3f *)in, dst, count);
+		}
+		else
+		{
+			Convert((const Vec3d *)in, dst, count);
+			m_Transform.Transform(dst, dst, count);
+		}
+	}
+	else
+	{
+		Vec3d *dst = (Vec3d *)&m_Out[0];
+		if (m_InType == FLOAT64)
+		{
+			m_Transform.Transform((const Vec3d *)in, dst, count);
+		}
+		else
+		{
+			Convert((const Vec3f *)in, dst, count);
+			m_Transform.Transform(dst, dst, count);
+		}
+	}
+	m_PointCount += count;
+	size_t bytes = count * PointBytes(m_OutType);
+	return fwrite(&m_Out[0], 1, bytes, out) == bytes;
+}
+
+bool PointTransformer::Run(FILE *in, FILE *out)
+{
+	m_PointCount = 0;
+	size_t pointBytes = PointBytes(m_InType);
+	size_t chunkBytes = m_ChunkPoints * pointBytes;
+	bool ok = true;
+	{
+		ReadAhead ahead(in, chunkBytes);
+		size_t got = chunkBytes;
+		for (int k = 0; ok && got == chunkBytes; k ^= 1)
+		{
+			const char *chunk = ahead.Take(k, got);
+			if (got % pointBytes != 0)
+				ok = false;
+			else if (got > 0)
+				ok = Process(chunk, got / pointBytes, out);
+			ahead.Release(k);
+		}
+	}
+	return ok && !ferror(in);
+}
+
+bool PointTransformer::RunMapped(const char *inPath, FILE *out)
+{
+#ifdef MATHING_HAVE_MMAP
+	m_PointCount = 0;
+	int fd = open(inPath, O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return false;
+	}
+	size_t size = (size_t)st.st_size;
+	if (size == 0)
+	{
+		close(fd);
+		return true;
+	}
+	char *map = (char *)mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return false;
+	madvise(map, size, MADV_SEQUENTIAL);
+
+	size_t pointBytes = PointBytes(m_InType);
+	size_t chunkBytes = m_ChunkPoints * pointBytes;
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t released = 0;
+	bool ok = size % pointBytes == 0;
+	for (size_t offset = 0; ok && offset < size; offset += chunkBytes)
+	{
+		size_t bytes = size - offset < chunkBytes ? size - offset : chunkBytes;
+
+		// Start the next chunk coming in while this one is transformed.
+		size_t ahead = offset + bytes;
+		if (ahead < size)
+		{
+			size_t start = ahead & ~(page - 1);
+			size_t length = size - ahead < chunkBytes ? size - ahead : chunkBytes;
+			madvise(map + start, ahead - start + length, MADV_WILLNEED);
+		}
+
+		ok = Process(map + offset, bytes / pointBytes, out);
+
+		// Let go of the whole pages that are done.
+		size_t done = (offset + bytes) & ~(page - 1);
+		if (done > released)
+		{
+			madvise(map + released, done - released, MADV_DONTNEED);
+			released = done;
+		}
+	}
+	munmap(map, size);
+	return ok;
+#else
+	FILE *in = fopen(inPath, "rb");
+	if (!in)
+		return false;
+	bool ok = Run(in, out);
+	fclose(in);
+	return ok;
+#endif
+}
+
+}  // namespace mathing
@@ -0,0 +1,232 @@
+#include "mathing/quantize.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+#define SNORM16_MAX 32767     // snorm16 1.0
+#define UNORM16_MAX 65535     // unorm16 1.0
+
+namespace mathing
+{
+
+static inline uint32_t FloatBits(float f)
+{
+	uint32_t u;
+	memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+static inline float BitsFloat(uint32_t u)
+{
+	float f;
+	memcpy(&f, &u, sizeof(f));
+	return f;
+}
+
+uint16_t FloatToHalf(float f)
+{
+	uint32_t u = FloatBits(f);
+	uint32_t sign = (u >> 16) & 0x8000;
+	u &= 0x7fffffff;
+
+	uint32_t h;
+	if (u >= (uint32_t)(127 + 16) << 23)
+	{
+		// Too big for a half, or infinity or NaN already.
+		h = u > (uint32_t)255 << 23 ? 0x7e00 : 0x7c00;
+	}
+	else if (u < (uint32_t)113 << 23)
+	{
+		// Subnormal as a half. Adding a float whose ulp is the half's smallest subnormal
+		// rounds the mantissa into place, to even, and the bits are the half's.
+		const uint32_t magic = (uint32_t)((127 - 15) + (23 - 10) + 1) << 23;
+		h = FloatBits(BitsFloat(u) + BitsFloat(magic)) - magic;
+	}
+	else
+	{
+		// Rebias the exponent and round the 13 dropped mantissa bits to even.
+		uint32_t odd = (u >> 13) & 1;
+		u += ((uint32_t)(15 - 127) << 23) + 0xfff + odd;
+		h = u >> 13;
+	}
+	return (uint16_t)(h | sign);
+}
+
+float HalfToFloat(uint16_t h)
+{
+	const uint32_t shiftedExp = 0x7c00 << 13;
+	uint32_t u = (uint32_t)(h & 0x7fff) << 13;
+	uint32_t exp = u & shiftedExp;
+	u += (uint32_t)(127 - 15) << 23;
+	if (exp == shiftedExp)
+	{
+		// Infinity or NaN.
+		u += (uint32_t)(128 - 16) << 23;
+	}
+	else if (exp == 0)
+	{
+		// Zero or subnormal, renormalized by a float subtract.
+		u += 1 << 23;
+		u = FloatBits(BitsFloat(u) - BitsFloat((uint32_t)113 << 23));
+	}
+	return BitsFloat(u | (uint32_t)(h & 0x8000) << 16);
+}
+
+void EncodeHalf4(const Vec4 *in, Half4 *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+#ifdef __F16C__
+		__m128 v = _mm_set_ps((float)in[i].w, (float)in[i].z, (float)in[i].y, (float)in[i].x);
+		_mm_storel_epi64((__m128i *)&out[i], _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+#else
+		out[i].x = FloatToHalf((float)in[i].x);
+		out[i].y = FloatToHalf((float)in[i].y);
+		out[i].z = FloatToHalf((float)in[i].z);
+		out[i].w = FloatToHalf((float)in[i].w);
+#endif
+	}
+}
+
+void DecodeHalf4(const Half4 *in, Vec4 *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+#ifdef __F16C__
+		float f[4];
+		_mm_storeu_ps(f, _mm_cvtph_ps(_mm_loadl_epi64((const __m128i *)&in[i])));
+		out[i].Set(f[0], f[1], f[2], f[3]);
+#else
+		out[i].Set(HalfToFloat(in[i].x), HalfToFloat(in[i].y), HalfToFloat(in[i].z), HalfToFloat(in[i].w));
+#endif
+	}
+}
+
+// [-1, 1] to snorm16, rounded to nearest.
+static inline int16_t ToSnorm16(Scalar v)
+{
+	v = v < -1 ? -1 : v > 1 ? 1 : v;
+	return (int16_t)floor(v * SNORM16_MAX + 0.5);
+}
+
+static inline Scalar FromSnorm16(int16_t v)
+{
+	// -32768 is also -1.
+	return v < -SNORM16_MAX ? -1 : (Scalar)v / SNORM16_MAX;
+}
+
+static inline Scalar SignNotZero(Scalar v)
+{
+	return v < 0 ? -1 : 1;
+}
+
+void EncodeOctNormal(const Vec4 *in, OctNormal *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Vec4 &n = in[i];
+		Scalar sum = fabs(n.x) + fabs(n.y) + fabs(n.z);
+		Scalar x = 0, y = 0;
+		if (sum > 0)
+		{
+			// Onto the octahedron |x| + |y| + |z| = 1, and the lower half folded out over the corners.
+			x = n.x / sum;
+			y = n.y / sum;
+			if (n.z < 0)
+			{
+				Scalar fx = (1 - fabs(y)) * SignNotZero(x);
+				y = (1 - fabs(x)) * SignNotZero(y);
+				x = fx;
+			}
+		}
+		out[i].x = ToSnorm16(x);
+		out[i].y = ToSnorm16(y);
+	}
+}
+
+void DecodeOctNormal(const OctNormal *in, Vec4 *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Scalar x = FromSnorm16(in[i].x);
+		Scalar y = FromSnorm16(in[i].y);
+		Scalar z = 1 - fabs(x) - fabs(y);
+		if (z < 0)
+		{
+			Scalar fx = (1 - fabs(y)) * SignNotZero(x);
+			y = (1 - fabs(x)) * SignNotZero(y);
+			x = fx;
+		}
+		Scalar invLen = 1 / sqrt(x*x + y*y + z*z);
+		out[i].Set(x * invLen, y * invLen, z * invLen, 0);
+	}
+}
+
+void EncodeSnormQuaternion(const Quaternion *in, SnormQuaternion *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i].x = ToSnorm16(in[i].x);
+		out[i].y = ToSnorm16(in[i].y);
+		out[i].z = ToSnorm16(in[i].z);
+		out[i].w = ToSnorm16(in[i].w);
+	}
+}
+
+void DecodeSnormQuaternion(const SnormQuaternion *in, Quaternion *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Scalar x = FromSnorm16(in[i].x);
+		Scalar y = FromSnorm16(in[i].y);
+		Scalar z = FromSnorm16(in[i].z);
+		Scalar w = FromSnorm16(in[i].w);
+		Scalar lenSq = x*x + y*y + z*z + w*w;
+		if (lenSq > 0)
+		{
+			Scalar invLen = 1 / sqrt(lenSq);
+			out[i].Set(x * invLen, y * invLen, z * invLen, w * invLen);
+		}
+		else
+		{
+			out[i].Set(0, 0, 0, 1);
+		}
+	}
+}
+
+// (v - min) / (max - min) to unorm16, clamped and rounded to nearest.
+static inline uint16_t ToUnorm16(Scalar v, Scalar min, Scalar scale)
+{
+	Scalar f = (v - min) * scale;
+	f = f < 0 ? 0 : f > UNORM16_MAX ? UNORM16_MAX : f;
+	return (uint16_t)(f + 0.5);
+}
+
+void EncodeFixedPosition(const Vec4 *in, FixedPosition *out, size_t count, const Vec4 &boxMin, const Vec4 &boxMax)
+{
+	// A flat box has one value on that axis, which encodes as 0.
+	Scalar sx = boxMax.x > boxMin.x ? UNORM16_MAX / (boxMax.x - boxMin.x) : 0;
+	Scalar sy = boxMax.y > boxMin.y ? UNORM16_MAX / (boxMax.y - boxMin.y) : 0;
+	Scalar sz = boxMax.z > boxMin.z ? UNORM16_MAX / (boxMax.z - boxMin.z) : 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i].x = ToUnorm16(in[i].x, boxMin.x, sx);
+		out[i].y = ToUnorm16(in[i].y, boxMin.y, sy);
+		out[i].z = ToUnorm16(in[i].z, boxMin.z, sz);
+	}
+}
+
+void DecodeFixedPosition(const FixedPosition *in, Vec4 *out, size_t count, const Vec4 &boxMin, const Vec4 &boxMax)
+{
+	Scalar sx = (boxMax.x - boxMin.x) / UNORM16_MAX;
+	Scalar sy = (boxMax.y - boxMin.y) / UNORM16_MAX;
+	Scalar sz = (boxMax.z - boxMin.z) / UNORM16_MAX;
+	for (size_t i = 0; i < count; ++i)
+		out[i].Set(boxMin.x + in[i].x * sx, boxMin.y + in[i].y * sy, boxMin.z + in[i].z * sz, 1);
+}
+
+}  // namespace mathing
@@ -1,10 +1,15 @@
 #include "mathing/quaternion.h"
+#include "mathing/instrument.h"
 #include "mathing/matrix.h"
+#include "mathing/vector.h"
 
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <iostream>
 
+#include "quaternion_ops.h"
+#include "rsqrt.h"
+
 #define DELTA 1e-10     // error tolerance used by quaternions
 
 using namespace std;
@@ -58,6 +63,7 @@ void Quaternion::Set(Scalar x_arg, Scalar y_arg, Scalar z_arg, Scalar w_arg)
 
 void Quaternion::FromMatrix(const Matrix &mat)
 {
+	MATHING_INSTRUMENT_SCOPE(INSTRUMENT_QUATERNION_FROM_MATRIX);
 	Scalar trace = mat.AxisX().x + mat.AxisY().y + mat.AxisZ().z + 1.0;
 	if( trace > DELTA )
 	{
@@ -72,7 +78,7 @@ void Quaternion::FromMatrix(const Matrix &mat)
 		if ( mat.AxisX().x > mat.AxisY().y && mat.AxisX().x > mat.AxisZ().z )
 		{
 			Scalar s = 2.0 * sqrt( 1.0 + mat.AxisX().x - mat.AxisY().y - mat.AxisZ().z);
-			w = (mat.AxisZ().y - mat.AxisY().z ) / s;
+			w = (mat.AxisY().z - mat.AxisZ().y ) / s;
 			x = 0.25 * s;
 			y = (mat.AxisY().x + mat.AxisX().y ) / s;
 			z = (mat.AxisZ().x + mat.AxisX().z ) / s;
@@ -88,7 +94,7 @@ void Quaternion::FromMatrix(const Matrix &mat)
 		else
 		{
 			Scalar s = 2.0 * sqrt( 1.0f + mat.AxisZ().z - mat.AxisX().x - mat.AxisY().y );
-			w = (mat.AxisY().x - mat.AxisX().y ) / s;
+			w = (mat.AxisX().y - mat.AxisY().x ) / s;
 			x = (mat.AxisZ().x + mat.AxisX().z ) / s;
 			y = (mat.AxisZ().y + mat.AxisY().z ) / s;
 			z = 0.25 * s;
@@ -104,6 +110,52 @@ void Quaternion::FromAxisAndAngle(Scalar xarg, Scalar yarg, Scalar zarg, Scalar
 	w=cos(theta/2);
 }
 
+/** Uses the half way vector, the rotation by 2a about n is (n sin(a), cos(a)), and
+(from x to, |from||to| + from.to) is that, scaled by 2 |from||to| cos(a), so normalizing it
+is all there is to it.
+*/
+void Quaternion::FromTo(const Vec4 &from, const Vec4 &to)
+{
+	Scalar fromLenSqr = from.x*from.x + from.y*from.y + from.z*from.z;
+	Scalar toLenSqr = to.x*to.x + to.y*to.y + to.z*to.z;
+	Scalar lens = sqrt(fromLenSqr * toLenSqr);
+	if (lens < DELTA)
+	{
+		Set(0, 0, 0, 1);
+		return;
+	}
+
+	x = from.y*to.z - from.z*to.y;
+	y = from.z*to.x - from.x*to.z;
+	z = from.x*to.y - from.y*to.x;
+	w = lens + from.x*to.x + from.y*to.y + from.z*to.z;
+	if (x*x + y*y + z*z + w*w < DELTA*DELTA * lens*lens)
+	{
+		// Opposite, any perpendicular axis will do, so take the one across the smallest component.
+		Scalar ax = fabs(from.x), ay = fabs(from.y), az = fabs(from.z);
+		if (ax <= ay && ax <= az)
+			Set(0, -from.z, from.y, 0);
+		else if (ay <= az)
+			Set(from.z, 0, -from.x, 0);
+		else
+			Set(-from.y, from.x, 0, 0);
+	}
+
+	Scalar invLen = 1 / sqrt(x*x + y*y + z*z + w*w);
+	x *= invLen;
+	y *= invLen;
+	z *= invLen;
+	w *= invLen;
+}
+
+void Quaternion::FromTo(const Vec4 *from, const Vec4 *to, Quaternion *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i].FromTo(from[i], to[i]);
+	}
+}
+
 void Quaternion::FromEuler(Scalar yaw, Scalar pitch, Scalar roll)
 {
 // Assuming the angles are in radians.
@@ -125,6 +177,73 @@ void Quaternion::FromEuler(Scalar yaw, Scalar pitch, Scalar roll)
 	w = c1c2*c3 - s1s2*s3;
 }
 
+Scalar Quaternion::Normalize()
+{
+	Scalar len = sqrt(x*x + y*y + z*z + w*w);
+	Scalar invLen = 1 / len;
+	x *= invLen;
+	y *= invLen;
+	z *= invLen;
+	w *= invLen;
+	return len;
+}
+
+Scalar Quaternion::NormalizeFast()
+{
+	Scalar lenSqr = x*x + y*y + z*z + w*w;
+	Scalar invLen = RsqrtFast(lenSqr);
+	x *= invLen;
+	y *= invLen;
+	z *= invLen;
+	w *= invLen;
+	return lenSqr * invLen;
+}
+
+void Quaternion::Normalize(Quaternion *q, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		QuaternionNormalize(q[i]);
+	}
+}
+
+void Quaternion::NormalizeFast(Quaternion *q, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Quaternion &a = q[i];
+		Scalar invLen = RsqrtFast(a.x*a.x + a.y*a.y + a.z*a.z + a.w*a.w);
+		a.x *= invLen;
+		a.y *= invLen;
+		a.z *= invLen;
+		a.w *= invLen;
+	}
+}
+
+Vec4 Quaternion::Rotate(const Vec4 &v) const
+{
+	MATHING_INSTRUMENT_SCOPE(INSTRUMENT_QUATERNION_ROTATE);
+	return QuaternionRotate(*this, v);
+}
+
+void Quaternion::Rotate(const Vec4 *v, Vec4 *out, size_t count) const
+{
+	// A local copy, so the compiler knows the stores to out can't change it, and keeps it in registers.
+	Quaternion q(*this);
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i] = QuaternionRotate(q, v[i]);
+	}
+}
+
+void Quaternion::Rotate(const Quaternion *q, const Vec4 *v, Vec4 *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i] = QuaternionRotate(q[i], v[i]);
+	}
+}
+
 /** assumes q1 is a normalised quaternion */
 void Quaternion::GetEuler(Scalar &yaw, Scalar &pitch, Scalar &roll)
 {
@@ -167,6 +286,7 @@ void Quaternion::GetEuler(Scalar &yaw, Scalar &pitch, Scalar &roll)
 
 	Quaternion &Quaternion::operator*=(const Quaternion &q)
 {
+	MATHING_INSTRUMENT_SCOPE(INSTRUMENT_QUATERNION_MULTIPLY);
 	Scalar tw = w;
 	Scalar tx = x;
 	Scalar ty = y;
@@ -191,6 +311,7 @@ void Quaternion::GetEuler(Scalar &yaw, Scalar &pitch, Scalar &roll)
 
 	Quaternion Quaternion::operator*(const Quaternion &q)
 {
+	MATHING_INSTRUMENT_SCOPE(INSTRUMENT_QUATERNION_MULTIPLY);
 	Quaternion ret;
 
 	Scalar E, F, G, H;
@@ -221,6 +342,7 @@ void Quaternion::GetEuler(Scalar &yaw, Scalar &pitch, Scalar &roll)
 */
 Quaternion Quaternion::Slerp(const Quaternion &from, const Quaternion &to, Scalar t)
 {
+	MATHING_INSTRUMENT_SCOPE(INSTRUMENT_QUATERNION_SLERP);
 	// Most of this code is optimized for speed and not for readability
 	// slerp(p,q,t) = (p*sin((1-t)*omega) + q*sin(t*omega)) / sin(omega)
 	Quaternion ret;
@@ -314,6 +436,13 @@ Quaternion Quaternion::Lerp(const Quaternion &from, const Quaternion &to, Scalar
 	return ret;
 }
 
+Quaternion Quaternion::Nlerp(const Quaternion &from, const Quaternion &to, Scalar t)
+{
+	Quaternion ret = Lerp(from, to, t);
+	ret.NormalizeFast();
+	return ret;
+}
+
 ostream &operator<<(ostream &os, const Quaternion &q)
 {
 	os << "(" << q.x << ", " << q.y << ", " << q.z << ", " << q.w << ")";
@@ -0,0 +1,68 @@
+#ifndef MATHING_QUATERNION_OPS_H
+#define MATHING_QUATERNION_OPS_H
+
+#include <math.h>
+
+#include "mathing/quaternion.h"
+#include "mathing/scalar.h"
+#include "mathing/vector.h"
+
+namespace mathing
+{
+
+// Quaternion math on plain components, for the inner loops that shouldn't go through the out of
+// line (and instrumented) operators.
+
+// a * b
+static inline Quaternion QuaternionMul(const Quaternion &a, const Quaternion &b)
+{
+	return Quaternion(
+		a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
+		a.w*b.y + a.y*b.w + a.z*b.x - a.x*b.z,
+		a.w*b.z + a.z*b.w + a.x*b.y - a.y*b.x,
+		a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z);
+}
+
+// The inverse of a unit quaternion.
+static inline Quaternion QuaternionConjugate(const Quaternion &q)
+{
+	return Quaternion(-q.x, -q.y, -q.z, q.w);
+}
+
+// v rotated by the unit quaternion q: v + w t + q.xyz x t, with t = 2 (q.xyz x v), which is
+// q v q* multiplied out and simplified. v.w passes through.
+static inline Vec4 QuaternionRotate(const Quaternion &q, const Vec4 &v)
+{
+	Scalar tx = 2 * (q.y*v.z - q.z*v.y);
+	Scalar ty = 2 * (q.z*v.x - q.x*v.z);
+	Scalar tz = 2 * (q.x*v.y - q.y*v.x);
+	return Vec4(
+		v.x + q.w*tx + q.y*tz - q.z*ty,
+		v.y + q.w*ty + q.z*tx - q.x*tz,
+		v.z + q.w*tz + q.x*ty - q.y*tx,
+		v.w);
+}
+
+static inline void QuaternionNormalize(Quaternion &q)
+{
+	Scalar invLen = 1 / sqrt(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w);
+	q.x *= invLen;
+	q.y *= invLen;
+	q.z *= invLen;
+	q.w *= invLen;
+}
+
+// Normalized lerp from \p a to \p b by \p t, with b flipped onto a's hemisphere so it takes the
+// shorter arc.
+static inline Quaternion QuaternionNlerp(const Quaternion &a, const Quaternion &b, Scalar t)
+{
+	Scalar tb = a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w < 0 ? -t : t;
+	Scalar ta = 1 - t;
+	Quaternion q(a.x*ta + b.x*tb, a.y*ta + b.y*tb, a.z*ta + b.z*tb, a.w*ta + b.w*tb);
+	QuaternionNormalize(q);
+	return q;
+}
+
+}  // namespace mathing
+
+#endif  // MATHING_QUATERNION_OPS_H
@@ -0,0 +1,254 @@
+#include "mathing/registration.h"
+
+#include <math.h>
+
+#define REGISTRATION_BLOCK 64            // pairs summed plainly before going into the compensated sums
+#define REGISTRATION_JACOBI_SWEEPS 32    // most Jacobi sweeps to find the eigenvectors
+#define REGISTRATION_JACOBI_EPSILON 1e-30  // squared off diagonal, relative to the diagonal, that's done
+
+namespace mathing
+{
+
+// Indices into the sums.
+enum
+{
+	SUM_W = 0,
+	SUM_S = 1,      // 3, w s
+	SUM_T = 4,      // 3, w t
+	SUM_ST = 7      // 9, w s_i t_j at 3 i + j
+};
+
+RegistrationSums::RegistrationSums()
+	: m_HasRef(false)
+{
+}
+
+void RegistrationSums::Clear()
+{
+	m_HasRef = false;
+	for (int k = 0; k < 16; ++k)
+		m_Sum[k] = CompensatedSum();
+}
+
+void RegistrationSums::Add(const Vec4 *source, const Vec4 *target, const Scalar *weights, size_t count)
+{
+	if (count == 0)
+		return;
+	if (!m_HasRef)
+	{
+		m_SourceRef = source[0];
+		m_TargetRef = target[0];
+		m_HasRef = true;
+	}
+	const Scalar sx0 = m_SourceRef.x, sy0 = m_SourceRef.y, sz0 = m_SourceRef.z;
+	const Scalar tx0 = m_TargetRef.x, ty0 = m_TargetRef.y, tz0 = m_TargetRef.z;
+
+	for (size_t begin = 0; begin < count; begin += REGISTRATION_BLOCK)
+	{
+		size_t end = count - begin < REGISTRATION_BLOCK ? count : begin + REGISTRATION_BLOCK;
+		Scalar block[16] = {0};
+		for (size_t i = begin; i < end; ++i)
+		{
+			Scalar w = weights ? weights[i] : 1;
+			Scalar sx = source[i].x - sx0, sy = source[i].y - sy0, sz = source[i].z - sz0;
+			Scalar tx = target[i].x - tx0, ty = target[i].y - ty0, tz = target[i].z - tz0;
+			Scalar wsx = w * sx, wsy = w * sy, wsz = w * sz;
+			block[SUM_W] += w;
+			block[SUM_S] += wsx;
+			block[SUM_S + 1] += wsy;
+			block[SUM_S + 2] += wsz;
+			block[SUM_T] += w * tx;
+			block[SUM_T + 1] += w * ty;
+			block[SUM_T + 2] += w * tz;
+			block[SUM_ST] += wsx * tx;
+			block[SUM_ST + 1] += wsx * ty;
+			block[SUM_ST + 2] += wsx * tz;
+			block[SUM_ST + 3] += wsy * tx;
+			block[SUM_ST + 4] += wsy * ty;
+			block[SUM_ST + 5] += wsy * tz;
+			block[SUM_ST + 6] += wsz * tx;
+			block[SUM_ST + 7] += wsz * ty;
+			block[SUM_ST + 8] += wsz * tz;
+		}
+		for (int k = 0; k < 16; ++k)
+			m_Sum[k].Add(block[k]);
+	}
+}
+
+void RegistrationSums::Merge(const RegistrationSums &other)
+{
+	if (!other.m_HasRef)
+		return;
+	if (!m_HasRef)
+	{
+		*this = other;
+		return;
+	}
+
+	// Moving other's sums from its references to these: with d = its reference - this one,
+	// w (s + ds)(t + dt) = w s t + ds (w t) + (w s) dt + w ds dt, per component.
+	const Scalar ds[3] = {
+		other.m_SourceRef.x - m_SourceRef.x,
+		other.m_SourceRef.y - m_SourceRef.y,
+		other.m_SourceRef.z - m_SourceRef.z};
+	const Scalar dt[3] = {
+		other.m_TargetRef.x - m_TargetRef.x,
+		other.m_TargetRef.y - m_TargetRef.y,
+		other.m_TargetRef.z - m_TargetRef.z};
+	Scalar w = other.m_Sum[SUM_W].Value();
+	Scalar s[3], t[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		s[i] = other.m_Sum[SUM_S + i].Value();
+		t[i] = other.m_Sum[SUM_T + i].Value();
+	}
+
+	m_Sum[SUM_W].Add(other.m_Sum[SUM_W].sum);
+	m_Sum[SUM_W].Add(other.m_Sum[SUM_W].error);
+	for (int i = 0; i < 3; ++i)
+	{
+		m_Sum[SUM_S + i].Add(other.m_Sum[SUM_S + i].sum);
+		m_Sum[SUM_S + i].Add(other.m_Sum[SUM_S + i].error);
+		m_Sum[SUM_S + i].Add(w * ds[i]);
+		m_Sum[SUM_T + i].Add(other.m_Sum[SUM_T + i].sum);
+		m_Sum[SUM_T + i].Add(other.m_Sum[SUM_T + i].error);
+		m_Sum[SUM_T + i].Add(w * dt[i]);
+	}
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			CompensatedSum &sum = m_Sum[SUM_ST + 3*i + j];
+			sum.Add(other.m_Sum[SUM_ST + 3*i + j].sum);
+			sum.Add(other.m_Sum[SUM_ST + 3*i + j].error);
+			sum.Add(ds[i] * t[j] + s[i] * dt[j] + w * ds[i] * dt[j]);
+		}
+	}
+}
+
+Vec4 RegistrationSums::SourceCentroid() const
+{
+	Scalar w = Weight();
+	if (!(w > 0))
+		return m_SourceRef;
+	return Vec4(
+		m_SourceRef.x + m_Sum[SUM_S].Value() / w,
+		m_SourceRef.y + m_Sum[SUM_S + 1].Value() / w,
+		m_SourceRef.z + m_Sum[SUM_S + 2].Value() / w,
+		1);
+}
+
+Vec4 RegistrationSums::TargetCentroid() const
+{
+	Scalar w = Weight();
+	if (!(w > 0))
+		return m_TargetRef;
+	return Vec4(
+		m_TargetRef.x + m_Sum[SUM_T].Value() / w,
+		m_TargetRef.y + m_Sum[SUM_T + 1].Value() / w,
+		m_TargetRef.z + m_Sum[SUM_T + 2].Value() / w,
+		1);
+}
+
+// Eigenvectors of the symmetric 4x4 a, by cyclic Jacobi rotations. a ends up diagonal, with
+// the eigenvalues, and the columns of v are the eigenvectors.
+static void Jacobi4(Scalar a[4][4], Scalar v[4][4])
+{
+	for (int i = 0; i < 4; ++i)
+		for (int j = 0; j < 4; ++j)
+			v[i][j] = i == j ? 1 : 0;
+
+	for (int sweep = 0; sweep < REGISTRATION_JACOBI_SWEEPS; ++sweep)
+	{
+		Scalar off = 0, diag = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			diag += a[i][i] * a[i][i];
+			for (int j = i + 1; j < 4; ++j)
+				off += a[i][j] * a[i][j];
+		}
+		if (off <= REGISTRATION_JACOBI_EPSILON * diag)
+			break;
+
+		for (int p = 0; p < 3; ++p)
+		{
+			for (int q = p + 1; q < 4; ++q)
+			{
+				if (a[p][q] == 0)
+					continue;
+				// The rotation that zeroes a[p][q], t = tan of its angle, the smaller root.
+				Scalar theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+				Scalar t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta * theta + 1));
+				Scalar c = 1 / sqrt(t * t + 1);
+				Scalar s = t * c;
+				for (int k = 0; k < 4; ++k)
+				{
+					Scalar akp = a[k][p], akq = a[k][q];
+					a[k][p] = c * akp - s * akq;
+					a[k][q] = s * akp + c * akq;
+				}
+				for (int k = 0; k < 4; ++k)
+				{
+					Scalar apk = a[p][k], aqk = a[q][k];
+					a[p][k] = c * apk - s * aqk;
+					a[q][k] = s * apk + c * aqk;
+				}
+				for (int k = 0; k < 4; ++k)
+				{
+					Scalar vkp = v[k][p], vkq = v[k][q];
+					v[k][p] = c * vkp - s * vkq;
+					v[k][q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+}
+
+bool RegistrationSums::Solve(Quaternion &rotation, Vec4 &translation) const
+{
+	Scalar w = Weight();
+	if (!(w > 0))
+		return false;
+
+	// Cross covariance about the centroids, S = sum w s t^T - (sum w s)(sum w t)^T / W, and the
+	// references drop out.
+	Scalar S[3][3];
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			S[i][j] = m_Sum[SUM_ST + 3*i + j].Value() - m_Sum[SUM_S + i].Value() * m_Sum[SUM_T + j].Value() / w;
+
+	// Horn's matrix, in w, x, y, z order. Its top eigenvector is the rotation.
+	Scalar N[4][4] = {
+		{S[0][0] + S[1][1] + S[2][2], S[1][2] - S[2][1], S[2][0] - S[0][2], S[0][1] - S[1][0]},
+		{S[1][2] - S[2][1], S[0][0] - S[1][1] - S[2][2], S[0][1] + S[1][0], S[2][0] + S[0][2]},
+		{S[2][0] - S[0][2], S[0][1] + S[1][0], -S[0][0] + S[1][1] - S[2][2], S[1][2] + S[2][1]},
+		{S[0][1] - S[1][0], S[2][0] + S[0][2], S[1][2] + S[2][1], -S[0][0] - S[1][1] + S[2][2]}};
+	Scalar V[4][4];
+	Jacobi4(N, V);
+	int best = 0;
+	for (int k = 1; k < 4; ++k)
+	{
+		if (N[k][k] > N[best][best])
+			best = k;
+	}
+	rotation.Set(V[1][best], V[2][best], V[3][best], V[0][best]);
+	rotation.Normalize();
+	if (rotation.w < 0)
+		rotation.Set(-rotation.x, -rotation.y, -rotation.z, -rotation.w);
+
+	translation = TargetCentroid() - rotation.Rotate(SourceCentroid());
+	translation.w = 1;
+	return true;
+}
+
+bool RegistrationSums::Solve(Matrix &transform) const
+{
+	Quaternion rotation;
+	Vec4 translation;
+	if (!Solve(rotation, translation))
+		return false;
+	transform.Set(rotation, translation);
+	return true;
+}
+
+}  // namespace mathing
@@ -0,0 +1,31 @@
+#ifndef MATHING_RSQRT_H
+#define MATHING_RSQRT_H
+
+#include <math.h>
+
+#include "mathing/scalar.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MATHING_HAVE_RSQRTSS
+#endif
+
+namespace mathing
+{
+
+// 1/sqrt(x), from the single precision estimate, which is off by at most 1.5 * 2^-12, then one
+// Newton step in Scalar, which squares that, to a relative error of at most 2.1e-7. x has to be
+// positive, and in float range.
+static inline Scalar RsqrtFast(Scalar x)
+{
+#ifdef MATHING_HAVE_RSQRTSS
+	Scalar y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss((float)x)));
+#else
+	Scalar y = 1.0f / sqrtf((float)x);
+#endif
+	return y * (1.5 - 0.5 * x * y * y);
+}
+
+}  // namespace mathing
+
+#endif  // MATHING_RSQRT_H
@@ -0,0 +1,304 @@
+#include "mathing/snapshot.h"
+
+#include <assert.h>
+#include <math.h>
+
+#include "mathing/allocator.h"
+
+#define SNAPSHOT_COUNT_BITS 32       // bits for the entity count at the start
+#define SNAPSHOT_MASK_BITS 7         // bits for which components of an entity changed
+#define SNAPSHOT_ROTATION_WIDTH_BITS 5   // bits for the width of rotation differences, up to 17
+#define SNAPSHOT_POSITION_WIDTH_BITS 6   // bits for the width of position differences, up to 33
+#define SNAPSHOT_ROTATION_WIDTH_MAX 17   // widest zigzagged difference of two int16 components
+#define SNAPSHOT_POSITION_WIDTH_MAX 33   // widest zigzagged difference of two int32 components
+
+namespace mathing
+{
+
+// Appends bits to a byte buffer, from the low bit of each byte up.
+struct BitWriter
+{
+	BitWriter(std::vector<uint8_t> &out) : m_Out(out), m_Bits(0), m_Count(0) {}
+
+	// Up to 33 bits, on top of the at most 7 waiting.
+	inline void Write(uint64_t value, unsigned width)
+	{
+		m_Bits |= value << m_Count;
+		m_Count += width;
+		while (m_Count >= 8)
+		{
+			m_Out.push_back((uint8_t)m_Bits);
+			m_Bits >>= 8;
+			m_Count -= 8;
+		}
+	}
+
+	inline void Flush()
+	{
+		if (m_Count > 0)
+			m_Out.push_back((uint8_t)m_Bits);
+		m_Bits = 0;
+		m_Count = 0;
+	}
+
+	std::vector<uint8_t> &m_Out;
+	uint64_t m_Bits;
+	unsigned m_Count;
+};
+
+struct BitReader
+{
+	BitReader(const uint8_t *data, size_t size) : m_Data(data), m_Size(size), m_Pos(0), m_Bits(0), m_Count(0) {}
+
+	// Up to 57 bits, so the at most 7 left over and the new bytes fit in 64.
+	// Returns false if the bytes run out first.
+	inline bool Read(unsigned width, uint64_t &value)
+	{
+		assert(width <= 57);
+		while (m_Count < width)
+		{
+			if (m_Pos >= m_Size)
+				return false;
+			m_Bits |= (uint64_t)m_Data[m_Pos++] << m_Count;
+			m_Count += 8;
+		}
+		value = m_Bits & (((uint64_t)1 << width) - 1);
+		m_Bits >>= width;
+		m_Count -= width;
+		return true;
+	}
+
+	const uint8_t *m_Data;
+	size_t m_Size;
+	size_t m_Pos;
+	uint64_t m_Bits;
+	unsigned m_Count;
+};
+
+// Small differences of either sign to small unsigned numbers, 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+static inline uint64_t ZigZag(int64_t v)
+{
+	return v < 0 ? ((uint64_t)-(v + 1) << 1) | 1 : (uint64_t)v << 1;
+}
+
+static inline int64_t UnZigZag(uint64_t u)
+{
+	return u & 1 ? -(int64_t)(u >> 1) - 1 : (int64_t)(u >> 1);
+}
+
+static inline unsigned BitWidth(uint64_t v)
+{
+	unsigned n = 0;
+	for (; v; v >>= 1)
+		++n;
+	return n;
+}
+
+// The baseline components of entity i, or identity at the origin past its end.
+static inline void BaselineOf(const std::vector<SnormQuaternion> &rotations, const std::vector<int32_t> &positions,
+	size_t i, int64_t base[7])
+{
+	if (i < rotations.size())
+	{
+		const SnormQuaternion &q = rotations[i];
+		base[0] = q.x;
+		base[1] = q.y;
+		base[2] = q.z;
+		base[3] = q.w;
+		base[4] = positions[i*3];
+		base[5] = positions[i*3 + 1];
+		base[6] = positions[i*3 + 2];
+	}
+	else
+	{
+		SnormQuaternion identity;
+		Quaternion q;
+		EncodeSnormQuaternion(&q, &identity, 1);
+		base[0] = identity.x;
+		base[1] = identity.y;
+		base[2] = identity.z;
+		base[3] = identity.w;
+		base[4] = base[5] = base[6] = 0;
+	}
+}
+
+Snapshot::Snapshot(Scalar positionStep)
+	: m_PositionStep(positionStep)
+{
+}
+
+void Snapshot::Set(const Quaternion *rotations, const Vec4 *positions, size_t count)
+{
+	m_Rotations.resize(count);
+	m_Positions.resize(count * 3);
+	if (count == 0)
+		return;
+	EncodeSnormQuaternion(rotations, &m_Rotations[0], count);
+
+	Scalar scale = 1 / m_PositionStep;
+	for (size_t i = 0; i < count; ++i)
+	{
+		// q and -q are the same rotation, so pick the one with positive w, or the baseline
+		// would see a change whenever the sign flips.
+		SnormQuaternion &q = m_Rotations[i];
+		if (q.w < 0)
+		{
+			q.x = -q.x;
+			q.y = -q.y;
+			q.z = -q.z;
+			q.w = -q.w;
+		}
+
+		const Scalar p[3] = {positions[i].x, positions[i].y, positions[i].z};
+		for (int k = 0; k < 3; ++k)
+		{
+			Scalar steps = floor(p[k] * scale + 0.5);
+			steps = steps < INT32_MIN ? INT32_MIN : steps > INT32_MAX ? INT32_MAX : steps;
+			m_Positions[i*3 + k] = (int32_t)steps;
+		}
+	}
+}
+
+void Snapshot::Set(const Matrix *transforms, size_t count)
+{
+	AlignedVector<Quaternion> rotations(count);
+	AlignedVector<Vec4> positions(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		rotations[i].FromMatrix(transforms[i]);
+		positions[i] = transforms[i].Pos();
+	}
+	Set(count ? &rotations[0] : 0, count ? &positions[0] : 0, count);
+}
+
+void Snapshot::Get(Quaternion *rotations, Vec4 *positions) const
+{
+	size_t count = Count();
+	if (count == 0)
+		return;
+	DecodeSnormQuaternion(&m_Rotations[0], rotations, count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		positions[i].Set(
+			m_Positions[i*3] * m_PositionStep,
+			m_Positions[i*3 + 1] * m_PositionStep,
+			m_Positions[i*3 + 2] * m_PositionStep,
+			1);
+	}
+}
+
+void Snapshot::Get(Matrix *transforms) const
+{
+	size_t count = Count();
+	if (count == 0)
+		return;
+	AlignedVector<Quaternion> rotations(count);
+	AlignedVector<Vec4> positions(count);
+	Get(&rotations[0], &positions[0]);
+	for (size_t i = 0; i < count; ++i)
+		transforms[i].Set(rotations[i], positions[i]);
+}
+
+void Snapshot::Encode(const Snapshot &baseline, std::vector<uint8_t> &out) const
+{
+	BitWriter writer(out);
+	size_t count = Count();
+	writer.Write(count, SNAPSHOT_COUNT_BITS);
+	for (size_t i = 0; i < count; ++i)
+	{
+		int64_t base[7];
+		BaselineOf(baseline.m_Rotations, baseline.m_Positions, i, base);
+		const SnormQuaternion &q = m_Rotations[i];
+		const int64_t value[7] = {q.x, q.y, q.z, q.w, m_Positions[i*3], m_Positions[i*3 + 1], m_Positions[i*3 + 2]};
+
+		uint64_t delta[7];
+		unsigned mask = 0, rotationWidth = 0, positionWidth = 0;
+		for (int k = 0; k < 7; ++k)
+		{
+			delta[k] = ZigZag(value[k] - base[k]);
+			if (delta[k] == 0)
+				continue;
+			mask |= 1 << k;
+			unsigned width = BitWidth(delta[k]);
+			unsigned &kindWidth = k < 4 ? rotationWidth : positionWidth;
+			kindWidth = width > kindWidth ? width : kindWidth;
+		}
+
+		writer.Write(mask != 0, 1);
+		if (mask == 0)
+			continue;
+		writer.Write(mask, SNAPSHOT_MASK_BITS);
+		if (rotationWidth)
+			writer.Write(rotationWidth - 1, SNAPSHOT_ROTATION_WIDTH_BITS);
+		if (positionWidth)
+			writer.Write(positionWidth - 1, SNAPSHOT_POSITION_WIDTH_BITS);
+		for (int k = 0; k < 7; ++k)
+		{
+			if (mask & (1 << k))
+				writer.Write(delta[k], k < 4 ? rotationWidth : positionWidth);
+		}
+	}
+	writer.Flush();
+}
+
+bool Snapshot::Decode(const Snapshot &baseline, const uint8_t *data, size_t size)
+{
+	m_Rotations.clear();
+	m_Positions.clear();
+
+	BitReader reader(data, size);
+	uint64_t count;
+	// Every entity takes at least a bit, which bounds the count before anything is allocated.
+	if (!reader.Read(SNAPSHOT_COUNT_BITS, count) || count > (uint64_t)size * 8)
+		return false;
+	m_Rotations.resize((size_t)count);
+	m_Positions.resize((size_t)count * 3);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		int64_t value[7];
+		BaselineOf(baseline.m_Rotations, baseline.m_Positions, i, value);
+
+		uint64_t changed, mask = 0, rotationWidth = 0, positionWidth = 0;
+		bool ok = reader.Read(1, changed);
+		if (ok && changed)
+		{
+			ok = reader.Read(SNAPSHOT_MASK_BITS, mask);
+			if (ok && (mask & 0xf))
+				ok = reader.Read(SNAPSHOT_ROTATION_WIDTH_BITS, rotationWidth);
+			if (ok && (mask & 0x70))
+				ok = reader.Read(SNAPSHOT_POSITION_WIDTH_BITS, positionWidth);
+			// The width fields can say more than the encoder ever writes, so a bad packet is
+			// caught here, before it gets to a read.
+			ok = ok && rotationWidth < SNAPSHOT_ROTATION_WIDTH_MAX && positionWidth < SNAPSHOT_POSITION_WIDTH_MAX;
+			for (int k = 0; ok && k < 7; ++k)
+			{
+				uint64_t delta = 0;
+				if (mask & (1 << k))
+				{
+					ok = reader.Read((unsigned)(k < 4 ? rotationWidth : positionWidth) + 1, delta);
+					if (ok)
+						value[k] += UnZigZag(delta);
+				}
+			}
+		}
+		if (!ok)
+		{
+			m_Rotations.clear();
+			m_Positions.clear();
+			return false;
+		}
+
+		SnormQuaternion &q = m_Rotations[i];
+		q.x = (int16_t)value[0];
+		q.y = (int16_t)value[1];
+		q.z = (int16_t)value[2];
+		q.w = (int16_t)value[3];
+		m_Positions[i*3] = (int32_t)value[4];
+		m_Positions[i*3 + 1] = (int32_t)value[5];
+		m_Positions[i*3 + 2] = (int32_t)value[6];
+	}
+	return true;
+}
+
+}  // namespace mathing
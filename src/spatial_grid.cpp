@@ -0,0 +1,188 @@
+#include "mathing/spatial_grid.h"
+
+namespace mathing
+{
+
+SpatialHashGrid::SpatialHashGrid()
+	: m_CellSize(1), m_InvCellSize(1), m_BucketMask(0)
+{
+	m_CellMin.x = m_CellMin.y = m_CellMin.z = 0;
+	m_CellMax.x = m_CellMax.y = m_CellMax.z = -1;
+}
+
+void SpatialHashGrid::Build(const Vec4 *positions, size_t count, Scalar cellSize)
+{
+	m_CellSize = cellSize;
+	m_InvCellSize = 1 / cellSize;
+
+	// About one bucket per point keeps the buckets short without wasting much on empty ones.
+	uint32_t buckets = 1;
+	while (buckets < count)
+		buckets <<= 1;
+	m_BucketMask = buckets - 1;
+
+	m_BucketStart.assign(buckets + 1, 0);
+	m_Scratch.resize(count);
+	m_Indices.resize(count);
+	m_Points.resize(count);
+	m_Cells.resize(count);
+
+	if (count == 0)
+	{
+		m_CellMin.x = m_CellMin.y = m_CellMin.z = 0;
+		m_CellMax.x = m_CellMax.y = m_CellMax.z = -1;
+		return;
+	}
+
+	// Count the points per bucket, offset by one, so the prefix sum leaves the start of each bucket.
+	m_CellMin = m_CellMax = CellOf(positions[0].x, positions[0].y, positions[0].z);
+	for (size_t i = 0; i < count; ++i)
+	{
+		Cell c = CellOf(positions[i].x, positions[i].y, positions[i].z);
+		m_CellMin.x = c.x < m_CellMin.x ? c.x : m_CellMin.x;
+		m_CellMin.y = c.y < m_CellMin.y ? c.y : m_CellMin.y;
+		m_CellMin.z = c.z < m_CellMin.z ? c.z : m_CellMin.z;
+		m_CellMax.x = c.x > m_CellMax.x ? c.x : m_CellMax.x;
+		m_CellMax.y = c.y > m_CellMax.y ? c.y : m_CellMax.y;
+		m_CellMax.z = c.z > m_CellMax.z ? c.z : m_CellMax.z;
+
+		uint32_t b = Bucket(c);
+		m_Scratch[i] = b;
+		++m_BucketStart[b + 1];
+	}
+
+	for (uint32_t b = 0; b < buckets; ++b)
+	{
+		m_BucketStart[b + 1] += m_BucketStart[b];
+	}
+
+	// Scatter, using the scratch as the write cursor per bucket. Points keep their input order
+	// within a bucket.
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t b = m_Scratch[i];
+		m_Scratch[i] = m_BucketStart[b];
+		++m_BucketStart[b];
+	}
+	for (uint32_t b = buckets; b > 0; --b)
+	{
+		m_BucketStart[b] = m_BucketStart[b - 1];
+	}
+	m_BucketStart[0] = 0;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t p = m_Scratch[i];
+		m_Indices[p] = (uint32_t)i;
+		m_Points[p] = positions[i];
+		m_Cells[p] = CellOf(positions[i].x, positions[i].y, positions[i].z);
+	}
+}
+
+size_t SpatialHashGrid::QueryRadius(const Vec4 &center, Scalar radius, uint32_t *results, size_t maxResults) const
+{
+	if (m_Points.empty())
+		return 0;
+
+	Scalar radiusSqr = radius * radius;
+	Cell lo = CellOf(center.x - radius, center.y - radius, center.z - radius);
+	Cell hi = CellOf(center.x + radius, center.y + radius, center.z + radius);
+	// No need to look at cells that nothing is in.
+	lo.x = lo.x > m_CellMin.x ? lo.x : m_CellMin.x;
+	lo.y = lo.y > m_CellMin.y ? lo.y : m_CellMin.y;
+	lo.z = lo.z > m_CellMin.z ? lo.z : m_CellMin.z;
+	hi.x = hi.x < m_CellMax.x ? hi.x : m_CellMax.x;
+	hi.y = hi.y < m_CellMax.y ? hi.y : m_CellMax.y;
+	hi.z = hi.z < m_CellMax.z ? hi.z : m_CellMax.z;
+
+	size_t found = 0;
+	Cell c;
+	for (c.z = lo.z; c.z <= hi.z; ++c.z)
+	for (c.y = lo.y; c.y <= hi.y; ++c.y)
+	for (c.x = lo.x; c.x <= hi.x; ++c.x)
+	{
+		uint32_t b = Bucket(c);
+		for (uint32_t p = m_BucketStart[b]; p < m_BucketStart[b + 1]; ++p)
+		{
+			if (!(m_Cells[p] == c))
+				continue;
+			Scalar dx = m_Points[p].x - center.x;
+			Scalar dy = m_Points[p].y - center.y;
+			Scalar dz = m_Points[p].z - center.z;
+			if (dx*dx + dy*dy + dz*dz <= radiusSqr)
+			{
+				if (found < maxResults)
+					results[found] = m_Indices[p];
+				++found;
+			}
+		}
+	}
+	return found;
+}
+
+size_t SpatialHashGrid::QueryKNearest(const Vec4 &center, size_t k, uint32_t *results, Scalar *distSqr,
+	Scalar maxRadius) const
+{
+	if (m_Points.empty() || k == 0)
+		return 0;
+
+	Scalar maxRadiusSqr = maxRadius * maxRadius;
+	Cell home = CellOf(center.x, center.y, center.z);
+	size_t found = 0;
+
+	// Search outwards one ring of cells at a time. After ring r, everything closer than r cells
+	// has been seen, so we can stop once the k-th best is closer than that.
+	for (int32_t ring = 0; ; ++ring)
+	{
+		Cell c;
+		for (c.z = home.z - ring; c.z <= home.z + ring; ++c.z)
+		for (c.y = home.y - ring; c.y <= home.y + ring; ++c.y)
+		{
+			// Inside the ring only the two end cells along x are on the ring's shell.
+			bool shell = c.z == home.z - ring || c.z == home.z + ring || c.y == home.y - ring || c.y == home.y + ring;
+			int32_t step = (shell || ring == 0) ? 1 : 2 * ring;
+			for (c.x = home.x - ring; c.x <= home.x + ring; c.x += step)
+			{
+				if (c.x < m_CellMin.x || c.y < m_CellMin.y || c.z < m_CellMin.z ||
+					c.x > m_CellMax.x || c.y > m_CellMax.y || c.z > m_CellMax.z)
+					continue;
+
+				uint32_t b = Bucket(c);
+				for (uint32_t p = m_BucketStart[b]; p < m_BucketStart[b + 1]; ++p)
+				{
+					if (!(m_Cells[p] == c))
+						continue;
+					Scalar dx = m_Points[p].x - center.x;
+					Scalar dy = m_Points[p].y - center.y;
+					Scalar dz = m_Points[p].z - center.z;
+					Scalar d = dx*dx + dy*dy + dz*dz;
+					if (d > maxRadiusSqr || (found == k && d >= distSqr[k - 1]))
+						continue;
+
+					// Insertion into the sorted results, k is expected to be small.
+					size_t slot = found < k ? found++ : k - 1;
+					while (slot > 0 && distSqr[slot - 1] > d)
+					{
+						distSqr[slot] = distSqr[slot - 1];
+						results[slot] = results[slot - 1];
+						--slot;
+					}
+					distSqr[slot] = d;
+					results[slot] = m_Indices[p];
+				}
+			}
+		}
+
+		Scalar reached = ring * m_CellSize;
+		if (found == k && distSqr[k - 1] <= reached * reached)
+			break;
+		if (reached >= maxRadius)
+			break;
+		if (home.x - ring <= m_CellMin.x && home.y - ring <= m_CellMin.y && home.z - ring <= m_CellMin.z &&
+			home.x + ring >= m_CellMax.x && home.y + ring >= m_CellMax.y && home.z + ring >= m_CellMax.z)
+			break;
+	}
+	return found;
+}
+
+}  // namespace mathing
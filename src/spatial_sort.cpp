@@ -0,0 +1,362 @@
+#include "mathing/spatial_sort.h"
+
+#include <string.h>
+
+#include <vector>
+
+namespace mathing
+{
+
+// Maps points onto the integer grid of the curve, one cell per (1 << bits) along each axis.
+// Degenerate (flat) bounds put everything in cell 0 for that axis.
+struct GridQuantizer
+{
+	Scalar minX, minY, minZ;
+	Scalar scaleX, scaleY, scaleZ;
+	Scalar maxCell;
+
+	GridQuantizer(const Vec4 &boundsMin, const Vec4 &boundsMax, int bits)
+		: minX(boundsMin.x), minY(boundsMin.y), minZ(boundsMin.z)
+	{
+		maxCell = (Scalar)((1u << bits) - 1);
+		Vec4 extent = boundsMax - boundsMin;
+		scaleX = extent.x > 0 ? maxCell / extent.x : 0;
+		scaleY = extent.y > 0 ? maxCell / extent.y : 0;
+		scaleZ = extent.z > 0 ? maxCell / extent.z : 0;
+	}
+
+	inline uint32_t Cell(Scalar v, Scalar min, Scalar scale) const
+	{
+		Scalar q = (v - min) * scale;
+		q = q < 0 ? 0 : q;
+		q = q > maxCell ? maxCell : q;
+		return (uint32_t)q;
+	}
+
+	inline void Quantize(const Vec4 &p, uint32_t &x, uint32_t &y, uint32_t &z) const
+	{
+		x = Cell(p.x, minX, scaleX);
+		y = Cell(p.y, minY, scaleY);
+		z = Cell(p.z, minZ, scaleZ);
+	}
+};
+
+// Spread the low 10 bits out so there are two 0 bits between each.
+static inline uint32_t Spread10(uint32_t x)
+{
+	x &= 0x000003ff;
+	x = (x | (x << 16)) & 0x030000ff;
+	x = (x | (x <<  8)) & 0x0300f00f;
+	x = (x | (x <<  4)) & 0x030c30c3;
+	x = (x | (x <<  2)) & 0x09249249;
+	return x;
+}
+
+// Spread the low 21 bits out so there are two 0 bits between each.
+static inline uint64_t Spread21(uint64_t x)
+{
+	x &= 0x00000000001fffffull;
+	x = (x | (x << 32)) & 0x001f00000000ffffull;
+	x = (x | (x << 16)) & 0x001f0000ff0000ffull;
+	x = (x | (x <<  8)) & 0x100f00f00f00f00full;
+	x = (x | (x <<  4)) & 0x10c30c30c30c30c3ull;
+	x = (x | (x <<  2)) & 0x1249249249249249ull;
+	return x;
+}
+
+// Skilling's transform ("Programming the Hilbert curve", 2004) from grid coordinates to the
+// "transposed" Hilbert index, where the index bits are spread across the 3 coordinates.
+// Interleaving the transposed coordinates gives the index, with x as the highest bit of each triple.
+static inline void AxesToTranspose(uint32_t X[3], int bits)
+{
+	uint32_t M = 1u << (bits - 1);
+
+	// Inverse undo
+	for (uint32_t Q = M; Q > 1; Q >>= 1)
+	{
+		uint32_t P = Q - 1;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (X[i] & Q)
+			{
+				X[0] ^= P;
+			}
+			else
+			{
+				uint32_t t = (X[0] ^ X[i]) & P;
+				X[0] ^= t;
+				X[i] ^= t;
+			}
+		}
+	}
+
+	// Gray encode
+	X[1] ^= X[0];
+	X[2] ^= X[1];
+	uint32_t t = 0;
+	for (uint32_t Q = M; Q > 1; Q >>= 1)
+	{
+		if (X[2] & Q)
+			t ^= Q - 1;
+	}
+	X[0] ^= t;
+	X[1] ^= t;
+	X[2] ^= t;
+}
+
+void MortonKeys30(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint32_t *keys)
+{
+	GridQuantizer grid(boundsMin, boundsMax, 10);
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t x, y, z;
+		grid.Quantize(points[i], x, y, z);
+		keys[i] = Spread10(x) | (Spread10(y) << 1) | (Spread10(z) << 2);
+	}
+}
+
+void MortonKeys63(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint64_t *keys)
+{
+	GridQuantizer grid(boundsMin, boundsMax, 21);
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t x, y, z;
+		grid.Quantize(points[i], x, y, z);
+		keys[i] = Spread21(x) | (Spread21(y) << 1) | (Spread21(z) << 2);
+	}
+}
+
+void HilbertKeys30(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint32_t *keys)
+{
+	GridQuantizer grid(boundsMin, boundsMax, 10);
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t X[3];
+		grid.Quantize(points[i], X[0], X[1], X[2]);
+		AxesToTranspose(X, 10);
+		keys[i] = (Spread10(X[0]) << 2) | (Spread10(X[1]) << 1) | Spread10(X[2]);
+	}
+}
+
+void HilbertKeys63(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint64_t *keys)
+{
+	GridQuantizer grid(boundsMin, boundsMax, 21);
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t X[3];
+		grid.Quantize(points[i], X[0], X[1], X[2]);
+		AxesToTranspose(X, 21);
+		keys[i] = (Spread21(X[0]) << 2) | (Spread21(X[1]) << 1) | Spread21(X[2]);
+	}
+}
+
+// LSD radix sort, 8 bits per pass. The histograms for every pass are built in one read of
+// the keys, and passes where every key has the same digit are skipped entirely, which is
+// common for the high bits of the keys when the points don't fill the bounds.
+template <typename Key>
+static void RadixSort(Key *keys, size_t count, uint32_t *perm)
+{
+	const int passes = sizeof(Key);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		perm[i] = (uint32_t)i;
+	}
+	if (count < 2)
+		return;
+
+	std::vector<size_t> hist(passes * 256, 0);
+	for (size_t i = 0; i < count; ++i)
+	{
+		Key k = keys[i];
+		for (int p = 0; p < passes; ++p)
+		{
+			++hist[p * 256 + ((k >> (p * 8)) & 0xff)];
+		}
+	}
+
+	std::vector<Key> keyScratch(count);
+	std::vector<uint32_t> permScratch(count);
+	Key *srcKeys = keys, *dstKeys = &keyScratch[0];
+	uint32_t *srcPerm = perm, *dstPerm = &permScratch[0];
+
+	for (int p = 0; p < passes; ++p)
+	{
+		size_t *h = &hist[p * 256];
+		if (h[keys[0] >> (p * 8) & 0xff] == count)
+			continue;
+
+		// Counts to offsets
+		size_t sum = 0;
+		for (int d = 0; d < 256; ++d)
+		{
+			size_t c = h[d];
+			h[d] = sum;
+			sum += c;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t dst = h[(srcKeys[i] >> (p * 8)) & 0xff]++;
+			dstKeys[dst] = srcKeys[i];
+			dstPerm[dst] = srcPerm[i];
+		}
+
+		Key *tk = srcKeys; srcKeys = dstKeys; dstKeys = tk;
+		uint32_t *tp = srcPerm; srcPerm = dstPerm; dstPerm = tp;
+	}
+
+	if (srcKeys != keys)
+	{
+		memcpy(keys, srcKeys, sizeof(Key) * count);
+		memcpy(perm, srcPerm, sizeof(uint32_t) * count);
+	}
+}
+
+void SortKeys(uint32_t *keys, size_t count, uint32_t *perm)
+{
+	RadixSort(keys, count, perm);
+}
+
+void SortKeys(uint64_t *keys, size_t count, uint32_t *perm)
+{
+	RadixSort(keys, count, perm);
+}
+
+template <typename Key>
+ParallelKeySort<Key>::ParallelKeySort()
+	: m_Keys(0), m_Perm(0), m_Count(0), m_Ranges(1),
+	m_SrcKeys(0), m_FromKeys(0), m_ToKeys(0), m_SrcPerm(0), m_FromPerm(0), m_ToPerm(0), m_Skip(true)
+{
+}
+
+template <typename Key>
+void ParallelKeySort<Key>::Begin(Key *keys, size_t count, uint32_t *perm, size_t ranges)
+{
+	m_Keys = keys;
+	m_Perm = perm;
+	m_Count = count;
+	m_Ranges = ranges > 0 ? ranges : 1;
+	m_KeyScratch.resize(count);
+	m_PermScratch.resize(count);
+	m_Hist.assign(m_Ranges * 256, 0);
+	m_SrcKeys = m_FromKeys = keys;
+	m_SrcPerm = m_FromPerm = perm;
+	m_ToKeys = count ? &m_KeyScratch[0] : 0;
+	m_ToPerm = count ? &m_PermScratch[0] : 0;
+	m_Skip = true;
+}
+
+template <typename Key>
+inline void ParallelKeySort<Key>::RangeOf(size_t range, size_t &begin, size_t &end) const
+{
+	begin = m_Count * range / m_Ranges;
+	end = m_Count * (range + 1) / m_Ranges;
+}
+
+template <typename Key>
+void ParallelKeySort<Key>::Count(int pass, size_t range)
+{
+	size_t begin, end;
+	RangeOf(range, begin, end);
+	if (pass == 0)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			m_Perm[i] = (uint32_t)i;
+		}
+	}
+
+	size_t *h = &m_Hist[range * 256];
+	memset(h, 0, sizeof(size_t) * 256);
+	for (size_t i = begin; i < end; ++i)
+	{
+		++h[(m_SrcKeys[i] >> (pass * 8)) & 0xff];
+	}
+}
+
+template <typename Key>
+void ParallelKeySort<Key>::Offsets(int)
+{
+	// Skipped when every key has the same digit, which is when some digit has all of them.
+	m_Skip = m_Count < 2;
+	for (int d = 0; d < 256 && !m_Skip; ++d)
+	{
+		size_t total = 0;
+		for (size_t r = 0; r < m_Ranges; ++r)
+		{
+			total += m_Hist[r * 256 + d];
+		}
+		m_Skip = total == m_Count;
+	}
+	if (m_Skip)
+		return;
+
+	// Every digit in order, and within a digit, every range in order, keeps it stable.
+	size_t sum = 0;
+	for (int d = 0; d < 256; ++d)
+	{
+		for (size_t r = 0; r < m_Ranges; ++r)
+		{
+			size_t c = m_Hist[r * 256 + d];
+			m_Hist[r * 256 + d] = sum;
+			sum += c;
+		}
+	}
+
+	m_FromKeys = m_SrcKeys;
+	m_FromPerm = m_SrcPerm;
+	m_ToKeys = m_SrcKeys == m_Keys ? &m_KeyScratch[0] : m_Keys;
+	m_ToPerm = m_SrcPerm == m_Perm ? &m_PermScratch[0] : m_Perm;
+	m_SrcKeys = m_ToKeys;
+	m_SrcPerm = m_ToPerm;
+}
+
+template <typename Key>
+void ParallelKeySort<Key>::Scatter(int pass, size_t range)
+{
+	if (m_Skip)
+		return;
+	size_t begin, end;
+	RangeOf(range, begin, end);
+	size_t *h = &m_Hist[range * 256];
+	for (size_t i = begin; i < end; ++i)
+	{
+		size_t dst = h[(m_FromKeys[i] >> (pass * 8)) & 0xff]++;
+		m_ToKeys[dst] = m_FromKeys[i];
+		m_ToPerm[dst] = m_FromPerm[i];
+	}
+}
+
+template <typename Key>
+void ParallelKeySort<Key>::Finish(size_t range)
+{
+	if (m_SrcKeys == m_Keys)
+		return;
+	size_t begin, end;
+	RangeOf(range, begin, end);
+	memcpy(m_Keys + begin, m_SrcKeys + begin, sizeof(Key) * (end - begin));
+	memcpy(m_Perm + begin, m_SrcPerm + begin, sizeof(uint32_t) * (end - begin));
+}
+
+template class ParallelKeySort<uint32_t>;
+template class ParallelKeySort<uint64_t>;
+
+void SpatialSort(const Vec4 *points, size_t count,
+	const Vec4 &boundsMin, const Vec4 &boundsMax, uint32_t *perm, bool hilbert)
+{
+	std::vector<uint32_t> keys(count);
+	if (count == 0)
+		return;
+	if (hilbert)
+		HilbertKeys30(points, count, boundsMin, boundsMax, &keys[0]);
+	else
+		MortonKeys30(points, count, boundsMin, boundsMax, &keys[0]);
+	SortKeys(&keys[0], count, perm);
+}
+
+}  // namespace mathing
@@ -0,0 +1,271 @@
+#include "mathing/spline.h"
+
+#include <math.h>
+
+#include "quaternion_ops.h"
+
+#define SPLINE_SLERP_EPSILON 1e-6     // below this 1 - cos, slerp is replaced by a lerp
+
+namespace mathing
+{
+
+// Adds a segment from its coefficients, in (a, b, c, d) order.
+static void AddSegment(AlignedVector<Vec4> &coeff, const Vec4 &a, const Vec4 &b, const Vec4 &c, const Vec4 &d)
+{
+	coeff.push_back(a);
+	coeff.push_back(b);
+	coeff.push_back(c);
+	coeff.push_back(d);
+}
+
+Spline::Spline()
+	: m_Length(0)
+{
+}
+
+void Spline::SetCatmullRom(const Vec4 *points, size_t count)
+{
+	m_Coeff.clear();
+	m_ArcParam.clear();
+	m_Length = 0;
+	for (size_t i = 0; i + 1 < count; ++i)
+	{
+		const Vec4 &p1 = points[i];
+		const Vec4 &p2 = points[i + 1];
+		Vec4 p0 = i > 0 ? points[i - 1] : p1 * 2 - p2;
+		Vec4 p3 = i + 2 < count ? points[i + 2] : p2 * 2 - p1;
+
+		// 1/2 [(2 p1) + (p2 - p0) t + (2 p0 - 5 p1 + 4 p2 - p3) t^2 + (3 p1 - p0 - 3 p2 + p3) t^3]
+		AddSegment(m_Coeff,
+			(p1 * 3 - p0 - p2 * 3 + p3) * 0.5,
+			(p0 * 2 - p1 * 5 + p2 * 4 - p3) * 0.5,
+			(p2 - p0) * 0.5,
+			p1);
+	}
+}
+
+void Spline::SetHermite(const Vec4 *points, size_t count)
+{
+	m_Coeff.clear();
+	m_ArcParam.clear();
+	m_Length = 0;
+	for (size_t i = 0; i + 1 < count; ++i)
+	{
+		const Vec4 &p0 = points[i*2];
+		const Vec4 &m0 = points[i*2 + 1];
+		const Vec4 &p1 = points[i*2 + 2];
+		const Vec4 &m1 = points[i*2 + 3];
+		AddSegment(m_Coeff,
+			p0 * 2 + m0 - p1 * 2 + m1,
+			p1 * 3 - p0 * 3 - m0 * 2 - m1,
+			m0,
+			p0);
+	}
+}
+
+void Spline::SetBezier(const Vec4 *points, size_t count)
+{
+	m_Coeff.clear();
+	m_ArcParam.clear();
+	m_Length = 0;
+	for (size_t i = 0; i + 3 < count; i += 3)
+	{
+		const Vec4 &p0 = points[i];
+		const Vec4 &p1 = points[i + 1];
+		const Vec4 &p2 = points[i + 2];
+		const Vec4 &p3 = points[i + 3];
+		AddSegment(m_Coeff,
+			p1 * 3 - p0 - p2 * 3 + p3,
+			(p0 - p1 * 2 + p2) * 3,
+			(p1 - p0) * 3,
+			p0);
+	}
+}
+
+inline const Vec4 *Spline::Segment(Scalar u, Scalar &t) const
+{
+	size_t segments = SegmentCount();
+	if (!(u > 0))
+	{
+		t = 0;
+		return &m_Coeff[0];
+	}
+	size_t s = (size_t)u;
+	if (s >= segments)
+	{
+		t = 1;
+		return &m_Coeff[(segments - 1) * 4];
+	}
+	t = u - s;
+	return &m_Coeff[s * 4];
+}
+
+Vec4 Spline::Evaluate(Scalar u) const
+{
+	Vec4 out;
+	Evaluate(&u, &out, 1);
+	return out;
+}
+
+void Spline::Evaluate(const Scalar *u, Vec4 *out, size_t count) const
+{
+	if (m_Coeff.empty())
+		return;
+	for (size_t i = 0; i < count; ++i)
+	{
+		Scalar t;
+		const Vec4 *c = Segment(u[i], t);
+		out[i].Set(
+			((c[0].x*t + c[1].x)*t + c[2].x)*t + c[3].x,
+			((c[0].y*t + c[1].y)*t + c[2].y)*t + c[3].y,
+			((c[0].z*t + c[1].z)*t + c[2].z)*t + c[3].z,
+			((c[0].w*t + c[1].w)*t + c[2].w)*t + c[3].w);
+	}
+}
+
+void Spline::BuildArcLength(size_t samplesPerSegment)
+{
+	m_ArcParam.clear();
+	m_Length = 0;
+	if (m_Coeff.empty() || samplesPerSegment < 1)
+		return;
+
+	// Distance along the curve at every sample.
+	size_t samples = SegmentCount() * samplesPerSegment;
+	std::vector<Scalar> distance(samples + 1);
+	Vec4 prev = Evaluate(0);
+	distance[0] = 0;
+	for (size_t k = 1; k <= samples; ++k)
+	{
+		Vec4 p = Evaluate((Scalar)k / samplesPerSegment);
+		m_Length += (p - prev).Length3();
+		distance[k] = m_Length;
+		prev = p;
+	}
+
+	// Turn it around, the parameter at equal steps of distance, with as many steps as samples.
+	m_ArcParam.resize(samples + 1);
+	size_t k = 0;
+	for (size_t j = 0; j <= samples; ++j)
+	{
+		Scalar d = m_Length * j / samples;
+		while (k + 1 < samples && distance[k + 1] < d)
+			++k;
+		Scalar span = distance[k + 1] - distance[k];
+		Scalar f = span > 0 ? (d - distance[k]) / span : 0;
+		f = f < 0 ? 0 : f > 1 ? 1 : f;
+		m_ArcParam[j] = (k + f) / samplesPerSegment;
+	}
+}
+
+Scalar Spline::ParamAtDistance(Scalar distance) const
+{
+	if (m_ArcParam.empty() || !(m_Length > 0))
+		return 0;
+	size_t steps = m_ArcParam.size() - 1;
+	Scalar x = distance / m_Length * steps;
+	if (!(x > 0))
+		return m_ArcParam[0];
+	size_t j = (size_t)x;
+	if (j >= steps)
+		return m_ArcParam[steps];
+	Scalar f = x - j;
+	return m_ArcParam[j] + (m_ArcParam[j + 1] - m_ArcParam[j]) * f;
+}
+
+void Spline::EvaluateAtDistance(const Scalar *distances, Vec4 *out, size_t count) const
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Scalar u = ParamAtDistance(distances[i]);
+		Evaluate(&u, &out[i], 1);
+	}
+}
+
+// Log of a unit quaternion, the axis times half the angle, in x, y, z.
+static inline Vec4 Log(const Quaternion &q)
+{
+	Scalar len = sqrt(q.x*q.x + q.y*q.y + q.z*q.z);
+	Scalar s = len > 0 ? atan2(len, q.w) / len : 1;
+	return Vec4(q.x * s, q.y * s, q.z * s);
+}
+
+static inline Quaternion Exp(const Vec4 &v)
+{
+	Scalar angle = v.Length3();
+	Scalar s = angle > 0 ? sin(angle) / angle : 1;
+	return Quaternion(v.x * s, v.y * s, v.z * s, cos(angle));
+}
+
+// Slerp that doesn't take the short way around, which SQUAD needs between its two curves.
+static inline Quaternion Slerp(const Quaternion &a, const Quaternion &b, Scalar t)
+{
+	Scalar cosom = a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+	Scalar sa = 1 - t, sb = t;
+	if (1 - fabs(cosom) > SPLINE_SLERP_EPSILON)
+	{
+		Scalar omega = acos(cosom);
+		Scalar invSin = 1 / sin(omega);
+		sa = sin(sa * omega) * invSin;
+		sb = sin(sb * omega) * invSin;
+	}
+	return Quaternion(a.x*sa + b.x*sb, a.y*sa + b.y*sb, a.z*sa + b.z*sb, a.w*sa + b.w*sb);
+}
+
+void QuaternionSpline::Set(const Quaternion *rotations, size_t count)
+{
+	m_Rotation.assign(rotations, rotations + count);
+	for (size_t i = 1; i < count; ++i)
+	{
+		Quaternion &q = m_Rotation[i];
+		const Quaternion &p = m_Rotation[i - 1];
+		if (p.x*q.x + p.y*q.y + p.z*q.z + p.w*q.w < 0)
+			q.Set(-q.x, -q.y, -q.z, -q.w);
+	}
+
+	// a_i = q_i exp(-(log(q_i^-1 q_i+1) + log(q_i^-1 q_i-1)) / 4), and the ends are their own controls.
+	m_Control = m_Rotation;
+	for (size_t i = 1; i + 1 < count; ++i)
+	{
+		const Quaternion &q = m_Rotation[i];
+		Quaternion inv = QuaternionConjugate(q);
+		Vec4 next = Log(QuaternionMul(inv, m_Rotation[i + 1]));
+		Vec4 prev = Log(QuaternionMul(inv, m_Rotation[i - 1]));
+		m_Control[i] = QuaternionMul(q, Exp((next + prev) * -0.25));
+	}
+}
+
+Quaternion QuaternionSpline::Evaluate(Scalar u) const
+{
+	Quaternion out;
+	Evaluate(&u, &out, 1);
+	return out;
+}
+
+void QuaternionSpline::Evaluate(const Scalar *u, Quaternion *out, size_t count) const
+{
+	if (m_Rotation.empty())
+		return;
+	size_t segments = SegmentCount();
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (segments == 0 || !(u[i] > 0))
+		{
+			out[i] = m_Rotation[0];
+			continue;
+		}
+		size_t s = (size_t)u[i];
+		Scalar t = u[i] - s;
+		if (s >= segments)
+		{
+			s = segments - 1;
+			t = 1;
+		}
+		// squad = slerp(slerp(q_s, q_s+1, t), slerp(a_s, a_s+1, t), 2t(1 - t))
+		Quaternion outer = Slerp(m_Rotation[s], m_Rotation[s + 1], t);
+		Quaternion inner = Slerp(m_Control[s], m_Control[s + 1], t);
+		out[i] = Slerp(outer, inner, 2 * t * (1 - t));
+	}
+}
+
+}  // namespace mathing
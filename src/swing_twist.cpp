@@ -0,0 +1,150 @@
+#include "mathing/swing_twist.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include "quaternion_ops.h"
+
+#define SWING_TWIST_EPSILON 1e-24     // squared length of the twist part below which the twist is undefined
+
+namespace mathing
+{
+
+SwingTwistLimit::SwingTwistLimit()
+{
+	Set(Vec4(1, 0, 0), M_PI, -M_PI, M_PI);
+}
+
+SwingTwistLimit::SwingTwistLimit(const Vec4 &axis, Scalar coneAngle, Scalar twistMin, Scalar twistMax)
+{
+	Set(axis, coneAngle, twistMin, twistMax);
+}
+
+void SwingTwistLimit::Set(const Vec4 &axis, Scalar coneAngle, Scalar twistMin, Scalar twistMax)
+{
+	this->axis = axis;
+	swingCos = cos(coneAngle / 2);
+	swingSin = sin(coneAngle / 2);
+	twistMinCos = cos(twistMin / 2);
+	twistMinSin = sin(twistMin / 2);
+	twistMaxCos = cos(twistMax / 2);
+	twistMaxSin = sin(twistMax / 2);
+}
+
+// The twist comes out as its signed sine along the axis, \p tSin, and its cosine, \p tCos >= 0,
+// so the clamp can compare it without building the quaternion.
+static inline void Decompose(const Quaternion &q, const Vec4 &a, Quaternion &swing, Scalar &tSin, Scalar &tCos)
+{
+	Scalar p = q.x*a.x + q.y*a.y + q.z*a.z;
+	Scalar lenSqr = p*p + q.w*q.w;
+	if (lenSqr < SWING_TWIST_EPSILON)
+	{
+		// A half turn swing, any twist fits, so take none.
+		tSin = 0;
+		tCos = 1;
+		swing = q;
+	}
+	else
+	{
+		Scalar invLen = (q.w < 0 ? -1 : 1) / sqrt(lenSqr);
+		tSin = p * invLen;
+		tCos = q.w * invLen;
+
+		// swing = q * conj(twist), with conj(twist) = (-a tSin, tCos)
+		swing = QuaternionMul(q, Quaternion(-a.x * tSin, -a.y * tSin, -a.z * tSin, tCos));
+	}
+
+	if (swing.w < 0)
+		swing.Set(-swing.x, -swing.y, -swing.z, -swing.w);
+}
+
+// swing * twist, with the twist given as its sine and cosine about the axis.
+static inline Quaternion Compose(const Quaternion &s, const Vec4 &a, Scalar tSin, Scalar tCos)
+{
+	return QuaternionMul(s, Quaternion(a.x * tSin, a.y * tSin, a.z * tSin, tCos));
+}
+
+void SwingTwistDecompose(const Quaternion &q, const Vec4 &axis, Quaternion &swing, Quaternion &twist)
+{
+	Scalar tSin, tCos;
+	Decompose(q, axis, swing, tSin, tCos);
+	twist.Set(axis.x * tSin, axis.y * tSin, axis.z * tSin, tCos);
+}
+
+void SwingTwistDecompose(const Quaternion *q, const Vec4 &axis,
+	Quaternion *swing, Quaternion *twist, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		SwingTwistDecompose(q[i], axis, swing[i], twist[i]);
+	}
+}
+
+void SwingTwistDecompose(const Quaternion *q, const Vec4 *axes,
+	Quaternion *swing, Quaternion *twist, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		SwingTwistDecompose(q[i], axes[i], swing[i], twist[i]);
+	}
+}
+
+void SwingTwistCompose(const Quaternion *swing, const Quaternion *twist, Quaternion *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i] = QuaternionMul(swing[i], twist[i]);
+	}
+}
+
+bool ClampSwingTwist(Quaternion &q, const SwingTwistLimit &limit)
+{
+	Quaternion swing;
+	Scalar tSin, tCos;
+	Decompose(q, limit.axis, swing, tSin, tCos);
+
+	// With the cosines >= 0 the half angles are within +-90 degrees, where the sine only grows,
+	// so the twist range is a range of sines.
+	bool clamped = false;
+	if (tSin < limit.twistMinSin)
+	{
+		tSin = limit.twistMinSin;
+		tCos = limit.twistMinCos;
+		clamped = true;
+	}
+	else if (tSin > limit.twistMaxSin)
+	{
+		tSin = limit.twistMaxSin;
+		tCos = limit.twistMaxCos;
+		clamped = true;
+	}
+
+	// And the swing's cosine only shrinks as it swings further.
+	if (swing.w < limit.swingCos)
+	{
+		Scalar s = limit.swingSin / sqrt(swing.x*swing.x + swing.y*swing.y + swing.z*swing.z);
+		swing.Set(swing.x * s, swing.y * s, swing.z * s, limit.swingCos);
+		clamped = true;
+	}
+
+	if (!clamped)
+		return false;
+
+	Quaternion r = Compose(swing, limit.axis, tSin, tCos);
+	if (r.x*q.x + r.y*q.y + r.z*q.z + r.w*q.w < 0)
+		r.Set(-r.x, -r.y, -r.z, -r.w);
+	q = r;
+	return true;
+}
+
+size_t ClampSwingTwist(Quaternion *q, const SwingTwistLimit *limits, size_t count)
+{
+	size_t clamped = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		clamped += ClampSwingTwist(q[i], limits[i]);
+	}
+	return clamped;
+}
+
+}  // namespace mathing
@@ -0,0 +1,160 @@
+#include "mathing/text.h"
+
+#include <charconv>
+
+namespace mathing
+{
+
+// Writes n Scalars separated by spaces.
+static inline char *WriteScalars(char *first, char *last, const Scalar *s, int n)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		if (i > 0)
+		{
+			if (first == last)
+				return 0;
+			*first++ = ' ';
+		}
+		std::to_chars_result result = std::to_chars(first, last, s[i]);
+		if (result.ec != std::errc())
+			return 0;
+		first = result.ptr;
+	}
+	return first;
+}
+
+static inline bool IsSeparator(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' ||
+		c == '(' || c == ')' || c == '[' || c == ']';
+}
+
+static inline const char *ReadScalars(const char *first, const char *last, Scalar *s, int n)
+{
+	for (int i = 0; i < n; ++i)
+	{
+		while (first != last && IsSeparator(*first))
+			++first;
+		std::from_chars_result result = std::from_chars(first, last, s[i]);
+		if (result.ec != std::errc())
+			return 0;
+		first = result.ptr;
+	}
+	return first;
+}
+
+char *ToChars(char *first, char *last, Scalar s)
+{
+	return WriteScalars(first, last, &s, 1);
+}
+
+char *ToChars(char *first, char *last, const Vec4 &v)
+{
+	const Scalar s[4] = {v.x, v.y, v.z, v.w};
+	return WriteScalars(first, last, s, 4);
+}
+
+char *ToChars(char *first, char *last, const Quaternion &q)
+{
+	const Scalar s[4] = {q.x, q.y, q.z, q.w};
+	return WriteScalars(first, last, s, 4);
+}
+
+char *ToChars(char *first, char *last, const Matrix &m)
+{
+	return WriteScalars(first, last, m.Buff(), 16);
+}
+
+const char *FromChars(const char *first, const char *last, Scalar &s)
+{
+	return ReadScalars(first, last, &s, 1);
+}
+
+const char *FromChars(const char *first, const char *last, Vec4 &v)
+{
+	Scalar s[4];
+	first = ReadScalars(first, last, s, 4);
+	if (first)
+		v.Set(s[0], s[1], s[2], s[3]);
+	return first;
+}
+
+const char *FromChars(const char *first, const char *last, Quaternion &q)
+{
+	Scalar s[4];
+	first = ReadScalars(first, last, s, 4);
+	if (first)
+		q.Set(s[0], s[1], s[2], s[3]);
+	return first;
+}
+
+const char *FromChars(const char *first, const char *last, Matrix &m)
+{
+	Scalar s[16];
+	first = ReadScalars(first, last, s, 16);
+	if (first)
+		m = Matrix(s);
+	return first;
+}
+
+// Grows out by the most count values of n Scalars can take, writes them, and trims it back.
+template <typename T>
+static void Append(const T *in, size_t count, int n, std::string &out)
+{
+	size_t start = out.size();
+	out.resize(start + count * n * (TEXT_SCALAR_CHARS + 1));
+	char *first = &out[0] + start;
+	char *last = &out[0] + out.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		first = ToChars(first, last, in[i]);
+		*first++ = '\n';
+	}
+	out.resize(first - &out[0]);
+}
+
+void AppendText(const Vec4 *in, size_t count, std::string &out)
+{
+	Append(in, count, 4, out);
+}
+
+void AppendText(const Quaternion *in, size_t count, std::string &out)
+{
+	Append(in, count, 4, out);
+}
+
+void AppendText(const Matrix *in, size_t count, std::string &out)
+{
+	Append(in, count, 16, out);
+}
+
+template <typename T>
+static size_t Parse(const char *first, const char *last, T *out, size_t count)
+{
+	size_t i = 0;
+	for (; i < count; ++i)
+	{
+		first = FromChars(first, last, out[i]);
+		if (!first)
+			break;
+	}
+	return i;
+}
+
+size_t ParseText(const char *first, const char *last, Vec4 *out, size_t count)
+{
+	return Parse(first, last, out, count);
+}
+
+size_t ParseText(const char *first, const char *last, Quaternion *out, size_t count)
+{
+	return Parse(first, last, out, count);
+}
+
+size_t ParseText(const char *first, const char *last, Matrix *out, size_t count)
+{
+	return Parse(first, last, out, count);
+}
+
+}  // namespace mathing
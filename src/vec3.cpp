@@ -0,0 +1,49 @@
+#include "mathing/vec3.h"
+
+namespace mathing
+{
+
+template <typename T>
+static inline void Widen(const Vec3T<T> *in, Vec4 *out, size_t count, Scalar w)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i].x = in[i].x;
+		out[i].y = in[i].y;
+		out[i].z = in[i].z;
+		out[i].w = w;
+	}
+}
+
+template <typename T>
+static inline void Narrow(const Vec4 *in, Vec3T<T> *out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		out[i].x = (T)in[i].x;
+		out[i].y = (T)in[i].y;
+		out[i].z = (T)in[i].z;
+	}
+}
+
+void Vec3ToVec4(const Vec3f *in, Vec4 *out, size_t count, Scalar w)
+{
+	Widen(in, out, count, w);
+}
+
+void Vec3ToVec4(const Vec3d *in, Vec4 *out, size_t count, Scalar w)
+{
+	Widen(in, out, count, w);
+}
+
+void Vec4ToVec3(const Vec4 *in, Vec3f *out, size_t count)
+{
+	Narrow(in, out, count);
+}
+
+void Vec4ToVec3(const Vec4 *in, Vec3d *out, size_t count)
+{
+	Narrow(in, out, count);
+}
+
+}  // namespace mathing
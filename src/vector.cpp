@@ -1,6 +1,8 @@
 #include "mathing/vector.h"
 #include <math.h>
 
+#include "rsqrt.h"
+
 #include <iostream>
 
 using namespace std;
@@ -178,6 +180,51 @@ Scalar Vec4::Normalize4()
 	return dist;
 }
 
+Scalar Vec4::Normalize3Fast()
+{
+	Scalar lenSqr = x*x + y*y + z*z;
+	Scalar invLen = RsqrtFast(lenSqr);
+	x *= invLen;
+	y *= invLen;
+	z *= invLen;
+	return lenSqr * invLen;
+}
+
+Scalar Vec4::Normalize4Fast()
+{
+	Scalar lenSqr = x*x + y*y + z*z + w*w;
+	Scalar invLen = RsqrtFast(lenSqr);
+	x *= invLen;
+	y *= invLen;
+	z *= invLen;
+	w *= invLen;
+	return lenSqr * invLen;
+}
+
+void Vec4::Normalize3(Vec4 *v, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vec4 &a = v[i];
+		Scalar invLen = 1 / sqrt(a.x*a.x + a.y*a.y + a.z*a.z);
+		a.x *= invLen;
+		a.y *= invLen;
+		a.z *= invLen;
+	}
+}
+
+void Vec4::Normalize3Fast(Vec4 *v, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Vec4 &a = v[i];
+		Scalar invLen = RsqrtFast(a.x*a.x + a.y*a.y + a.z*a.z);
+		a.x *= invLen;
+		a.y *= invLen;
+		a.z *= invLen;
+	}
+}
+
 Vec4 Vec4::Cross(const Vec4 &v1, const Vec4 &v2)
 {
 	Vec4 ret;
@@ -0,0 +1,68 @@
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+#include "mathing/allocator.h"
+#include "mathing/matrix.h"
+
+using namespace mathing;
+
+static bool IsAligned(const void *p, size_t align) {
+  return ((uintptr_t)p & (align - 1)) == 0;
+}
+
+TEST(Allocator, TypesAreAligned) {
+  EXPECT_EQ(alignof(Vec4), MATHING_ALIGN);
+  EXPECT_EQ(alignof(Quaternion), MATHING_ALIGN);
+  EXPECT_EQ(alignof(Matrix), MATHING_ALIGN);
+  EXPECT_EQ(sizeof(Vec4), 4 * sizeof(Scalar));
+  EXPECT_EQ(sizeof(Matrix), 16 * sizeof(Scalar));
+}
+
+TEST(Allocator, AlignedVector) {
+  AlignedVector<Vec4> points;
+  AlignedVector<Matrix> matrices(3);
+  for (int i = 0; i < 100; ++i) {
+    points.push_back(Vec4(i, 0, 0, 1));
+    EXPECT_TRUE(IsAligned(&points[0], MATHING_ALIGN));
+  }
+  EXPECT_EQ(points[99].x, 99);
+  EXPECT_TRUE(IsAligned(&matrices[1].AxisY(), MATHING_ALIGN));
+
+  void *p = AlignedAlloc(100, 64);
+  EXPECT_TRUE(IsAligned(p, 64));
+  AlignedFree(p);
+
+  // count * sizeof(T) doesn't fit in a size_t.
+  AlignedAllocator<Vec4> allocator;
+  EXPECT_THROW(allocator.allocate(SIZE_MAX / 2), std::bad_array_new_length);
+}
+
+TEST(Allocator, FrameArena) {
+  FrameArena arena(1024);
+  EXPECT_EQ(arena.Capacity(), 1024u);
+
+  char *bytes = (char *)arena.Allocate(3, 1);
+  ASSERT_TRUE(bytes != NULL);
+  Vec4 *v = arena.Allocate<Vec4>(4);
+  ASSERT_TRUE(v != NULL);
+  EXPECT_TRUE(IsAligned(v, MATHING_ALIGN));
+  EXPECT_EQ(v[3].x, 0);
+  EXPECT_EQ(arena.Used(), MATHING_ALIGN + 4 * sizeof(Vec4));
+
+  size_t mark = arena.Mark();
+  Quaternion *q = arena.Allocate<Quaternion>(2);
+  ASSERT_TRUE(q != NULL);
+  EXPECT_EQ(q[1].w, 1);
+  arena.Rewind(mark);
+  EXPECT_EQ(arena.Used(), mark);
+
+  // Out of room.
+  EXPECT_TRUE(arena.Allocate<Matrix>(8) == NULL);
+  EXPECT_EQ(arena.Used(), mark);
+  EXPECT_TRUE(arena.Allocate<Vec4>(SIZE_MAX / 2) == NULL);
+  EXPECT_EQ(arena.Used(), mark);
+
+  arena.Reset();
+  EXPECT_TRUE(arena.Allocate<Matrix>(8) != NULL);
+  EXPECT_EQ(arena.Used(), 1024u);
+}
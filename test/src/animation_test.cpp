@@ -0,0 +1,100 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/animation.h"
+
+#define ANIMATION_EPSILON 1.0e-12
+
+using namespace mathing;
+
+// Track 0 spins about z at 1 radian per second with a key every 0.1s, and moves along x at 2 per
+// second. Track 1 has a single key. Track 2 has keys at uneven times.
+static void BuildClip(AnimationClip &clip) {
+  size_t t = clip.AddTrack(11);
+  for (int k = 0; k < 11; ++k) {
+    Scalar time = k * 0.1;
+    clip.Times(t)[k] = time;
+    clip.Rotations(t)[k].FromAxisAndAngle(0, 0, 1, time);
+    clip.Positions(t)[k].Set(2 * time, 0, 0, 1);
+  }
+
+  t = clip.AddTrack(1);
+  clip.Positions(t)[0].Set(0, 5, 0, 1);
+
+  t = clip.AddTrack(3);
+  Scalar times[3] = {0.2, 0.25, 0.9};
+  for (int k = 0; k < 3; ++k) {
+    clip.Times(t)[k] = times[k];
+    clip.Positions(t)[k].Set(0, 0, k, 1);
+  }
+}
+
+TEST(Animation, SampleForwardAndBack) {
+  AnimationClip clip;
+  BuildClip(clip);
+  EXPECT_NEAR(clip.Duration(), 1, ANIMATION_EPSILON);
+
+  AnimationCursor cursor;
+  cursor.Reset(clip);
+  Quaternion rot[3];
+  Vec4 pos[3];
+
+  // Forward in small steps, a big skip, then back to the start, then past the end.
+  Scalar times[] = {0, 0.01, 0.05, 0.1, 0.22, 0.31, 0.87, 0.12, -1, 0.575, 2};
+  for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); ++i) {
+    Scalar time = times[i];
+    clip.Sample(cursor, time, rot, pos);
+
+    Scalar held = time < 0 ? 0 : time > 1 ? 1 : time;
+    EXPECT_NEAR(pos[0].x, 2 * held, ANIMATION_EPSILON) << time;
+    // Normalized lerp across 0.1 radians stays well within 1e-4 of the exact angle.
+    EXPECT_NEAR(2 * atan2(rot[0].z, rot[0].w), held, 1e-4) << time;
+    EXPECT_NEAR(pos[1].y, 5, ANIMATION_EPSILON);
+    EXPECT_EQ(rot[1].w, 1);
+  }
+}
+
+TEST(Animation, UnevenKeysAndMatrices) {
+  AnimationClip clip;
+  BuildClip(clip);
+  AnimationCursor cursor;
+  cursor.Reset(clip);
+  Quaternion rot[3];
+  Vec4 pos[3];
+
+  clip.Sample(cursor, 0.1, rot, pos);
+  EXPECT_NEAR(pos[2].z, 0, ANIMATION_EPSILON);
+  clip.Sample(cursor, 0.225, rot, pos);
+  EXPECT_NEAR(pos[2].z, 0.5, ANIMATION_EPSILON);
+  clip.Sample(cursor, 0.575, rot, pos);
+  EXPECT_NEAR(pos[2].z, 1.5, ANIMATION_EPSILON);
+
+  Matrix transforms[3];
+  clip.Sample(cursor, 0.55, transforms);
+  clip.Sample(cursor, 0.55, rot, pos);
+  for (int t = 0; t < 3; ++t) {
+    Matrix expected;
+    expected.Set(rot[t], pos[t]);
+    for (int i = 0; i < 16; ++i) {
+      EXPECT_EQ(transforms[t].Buff()[i], expected.Buff()[i]);
+    }
+  }
+}
+
+TEST(Animation, ShortestArc) {
+  AnimationClip clip;
+  size_t t = clip.AddTrack(2);
+  clip.Times(t)[1] = 1;
+  clip.Rotations(t)[0].FromAxisAndAngle(0, 0, 1, 0.2);
+  clip.Rotations(t)[1].FromAxisAndAngle(0, 0, 1, 0.4);
+  // The same rotation, from the other side.
+  Quaternion &q = clip.Rotations(t)[1];
+  q.Set(-q.x, -q.y, -q.z, -q.w);
+
+  AnimationCursor cursor;
+  cursor.Reset(clip);
+  Quaternion rot;
+  Vec4 pos;
+  clip.Sample(cursor, 0.5, &rot, &pos);
+  EXPECT_NEAR(2 * atan2(rot.z, rot.w), 0.3, ANIMATION_EPSILON);
+}
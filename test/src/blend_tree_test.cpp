@@ -0,0 +1,114 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/blend_tree.h"
+
+#define BLEND_TREE_EPSILON 1.0e-12
+
+using namespace mathing;
+
+static const int kBones = 3;
+
+// A pose with every bone turned by \p angle about z, and at \p x along x.
+struct TestPose {
+  Quaternion rot[kBones];
+  Vec4 pos[kBones];
+
+  TestPose(Scalar angle = 0, Scalar x = 0) {
+    for (int i = 0; i < kBones; ++i) {
+      rot[i].FromAxisAndAngle(0, 0, 1, angle);
+      pos[i].Set(x, 0, 0, 1);
+    }
+  }
+  PoseBuffer Buffer() { return PoseBuffer(rot, pos); }
+};
+
+static Scalar AngleZ(const Quaternion &q) {
+  return 2 * atan2(q.z, q.w);
+}
+
+TEST(BlendTree, MaskedBlend) {
+  TestPose a(0.2, 1), b(0.6, 3), out;
+  PoseBuffer inputs[2] = {a.Buffer(), b.Buffer()};
+
+  BlendTree tree(kBones);
+  Scalar upperBody[kBones] = {0, 1, 0.5};
+  int mask = tree.AddMask(upperBody);
+  size_t root = tree.AddBlend(tree.AddInput(0), tree.AddInput(1), 0, mask);
+  ASSERT_TRUE(tree.Compile(root));
+  EXPECT_EQ(tree.ArenaPoses(), 0u);
+
+  PoseArena arena(kBones);
+  Scalar params[1] = {0.5};
+  ASSERT_TRUE(tree.Evaluate(arena, inputs, params, out.Buffer()));
+  // The root goes straight to out.
+  EXPECT_EQ(arena.Used(), 0u);
+
+  Scalar expected[kBones] = {0.2, 0.4, 0.3};
+  for (int i = 0; i < kBones; ++i) {
+    // Both keys are symmetric about the result, so nlerp lands on it exactly.
+    EXPECT_NEAR(AngleZ(out.rot[i]), expected[i], 1e-3) << i;
+    EXPECT_NEAR(out.pos[i].x, 1 + 2 * upperBody[i] * 0.5, BLEND_TREE_EPSILON) << i;
+  }
+  EXPECT_NEAR(AngleZ(out.rot[1]), 0.4, BLEND_TREE_EPSILON);
+}
+
+TEST(BlendTree, NestedAdditive) {
+  // (walk blended to run) with a lean added on top, then blended to an override pose.
+  TestPose walk(0.1, 1), run(0.3, 2), lean(0.4, 0.5), aim(-1, 0), out;
+  PoseBuffer inputs[4] = {walk.Buffer(), run.Buffer(), lean.Buffer(), aim.Buffer()};
+
+  BlendTree tree(kBones);
+  size_t locomotion = tree.AddBlend(tree.AddInput(0), tree.AddInput(1), 0);
+  size_t leaning = tree.AddAdditive(locomotion, tree.AddInput(2), 1);
+  Scalar aimBones[kBones] = {0, 0, 1};
+  size_t root = tree.AddBlend(leaning, tree.AddInput(3), 2, tree.AddMask(aimBones));
+  ASSERT_TRUE(tree.Compile(root));
+  EXPECT_EQ(tree.ArenaPoses(), 1u);
+
+  Scalar params[3] = {0.5, 0.5, 1};
+
+  // Not enough room.
+  PoseArena small(kBones - 1);
+  EXPECT_FALSE(tree.Evaluate(small, inputs, params, out.Buffer()));
+
+  PoseArena arena(kBones * tree.ArenaPoses());
+  for (int frame = 0; frame < 2; ++frame) {
+    arena.Reset();
+    ASSERT_TRUE(tree.Evaluate(arena, inputs, params, out.Buffer()));
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    // 0.2 from the blend, plus half the lean.
+    EXPECT_NEAR(AngleZ(out.rot[i]), 0.4, BLEND_TREE_EPSILON) << i;
+    EXPECT_NEAR(out.pos[i].x, 1.5 + 0.25, BLEND_TREE_EPSILON) << i;
+  }
+  EXPECT_NEAR(AngleZ(out.rot[2]), -1, BLEND_TREE_EPSILON);
+  EXPECT_NEAR(out.pos[2].x, 0, BLEND_TREE_EPSILON);
+}
+
+TEST(BlendTree, SingleInput) {
+  TestPose a(0.7, 2), out;
+  PoseBuffer input = a.Buffer();
+  BlendTree tree(kBones);
+  ASSERT_TRUE(tree.Compile(tree.AddInput(0)));
+  PoseArena arena;
+  ASSERT_TRUE(tree.Evaluate(arena, &input, 0, out.Buffer()));
+  EXPECT_NEAR(AngleZ(out.rot[2]), 0.7, BLEND_TREE_EPSILON);
+  EXPECT_EQ(out.pos[2].x, 2);
+}
+
+TEST(BlendTree, NoBones) {
+  BlendTree tree(0);
+  Scalar none[1] = {0};
+  EXPECT_EQ(tree.AddMask(none), 0);
+  int mask = tree.AddMask(none);
+  EXPECT_EQ(mask, 1);
+  size_t root = tree.AddBlend(tree.AddInput(0), tree.AddInput(1), 0, mask);
+  ASSERT_TRUE(tree.Compile(root));
+
+  PoseBuffer inputs[2] = {PoseBuffer(), PoseBuffer()};
+  PoseArena arena;
+  Scalar params[1] = {0.5};
+  EXPECT_TRUE(tree.Evaluate(arena, inputs, params, PoseBuffer()));
+}
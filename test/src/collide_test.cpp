@@ -0,0 +1,139 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/collide.h"
+
+#define COLLIDE_EPSILON 1.0e-6
+
+#define EXPECT_VEC3_NEAR(a, b, eps) \
+  EXPECT_NEAR(a.x, b.x, eps) << a; \
+  EXPECT_NEAR(a.y, b.y, eps) << a; \
+  EXPECT_NEAR(a.z, b.z, eps) << a;
+
+using namespace mathing;
+
+static Quaternion AboutZ(Scalar radians) {
+  Quaternion q;
+  q.FromAxisAndAngle(0, 0, 1, radians);
+  return q;
+}
+
+TEST(ShapeQuery, SpheresSeparated) {
+  ConvexShape a = ConvexShape::Sphere(1);
+  ConvexShape b = ConvexShape::Sphere(0.5);
+  ShapeQueryResult r;
+  EXPECT_TRUE(ShapeDistance(a, Matrix(), b, Matrix(Quaternion(), Vec4(3, 0, 0, 1)), r));
+  EXPECT_NEAR(r.distance, 1.5, COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(r.normal, Vec4(1, 0, 0), COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(r.pointA, Vec4(1, 0, 0), COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(r.pointB, Vec4(2.5, 0, 0), COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, SpheresOverlapByRadius) {
+  ConvexShape s = ConvexShape::Sphere(1);
+  ShapeQueryResult r;
+  EXPECT_TRUE(ShapeQuery(s, Matrix(), s, Matrix(Quaternion(), Vec4(0, 1.5, 0, 1)), r));
+  EXPECT_NEAR(r.distance, -0.5, COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(r.normal, Vec4(0, 1, 0), COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, BoxesSeparatedRotated) {
+  // B is turned 45 degrees, so its edge points at A's face.
+  ConvexShape box = ConvexShape::Box(Vec4(1, 1, 1));
+  ShapeQueryResult r;
+  EXPECT_TRUE(ShapeDistance(box, Quaternion(), Vec4(0, 0, 0, 1),
+                            box, AboutZ(M_PI / 4), Vec4(3, 0, 0, 1), r));
+  EXPECT_NEAR(r.distance, 2 - sqrt(2.0), COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(r.normal, Vec4(1, 0, 0), COLLIDE_EPSILON);
+  EXPECT_NEAR(r.pointB.x, 3 - sqrt(2.0), COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, BoxesPenetrating) {
+  ConvexShape box = ConvexShape::Box(Vec4(1, 1, 1));
+  ShapeQueryResult r;
+  EXPECT_TRUE(ShapeQuery(box, Matrix(), box, Matrix(Quaternion(), Vec4(1.5, 0.2, 0.1, 1)), r));
+  EXPECT_NEAR(r.distance, -0.5, COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(r.normal, Vec4(1, 0, 0), COLLIDE_EPSILON);
+  EXPECT_NEAR(r.pointA.x - r.pointB.x, 0.5, COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, HullMatchesBox) {
+  Vec4 corners[8];
+  for (int i = 0; i < 8; ++i) {
+    corners[i].Set(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1, 1);
+  }
+  ConvexShape hull = ConvexShape::Hull(corners, 8);
+  ConvexShape box = ConvexShape::Box(Vec4(1, 1, 1));
+  Matrix pose(AboutZ(0.3), Vec4(0.4, 1.6, 0.2, 1));
+
+  ShapeQueryResult rHull, rBox;
+  EXPECT_TRUE(ShapeQuery(hull, Matrix(), box, pose, rHull));
+  EXPECT_TRUE(ShapeQuery(box, Matrix(), box, pose, rBox));
+  EXPECT_LT(rBox.distance, 0);
+  EXPECT_NEAR(rHull.distance, rBox.distance, COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, CapsuleAndSphereInside) {
+  // Capsule lying along x, with the sphere center right on its core segment.
+  ConvexShape capsule = ConvexShape::Capsule(1, 0.5);
+  ConvexShape sphere = ConvexShape::Sphere(0.25);
+  ShapeQueryResult r;
+  EXPECT_TRUE(ShapeQuery(capsule, AboutZ(M_PI / 2), Vec4(0, 0, 0, 1),
+                         sphere, Quaternion(), Vec4(0.5, 0, 0, 1), r));
+  EXPECT_NEAR(r.distance, -0.75, COLLIDE_EPSILON);
+  EXPECT_NEAR(r.normal.x, 0, COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, Batch) {
+  ConvexShape box = ConvexShape::Box(Vec4(1, 1, 1));
+  ConvexShape capsule = ConvexShape::Capsule(1, 0.5);
+  Matrix origin;
+  Matrix near(Quaternion(), Vec4(0, 2.2, 0, 1));
+  Matrix far(Quaternion(), Vec4(0, 9, 0, 1));
+
+  ShapePair pairs[3] = {
+    {&box, &origin, &capsule, &near},
+    {&box, &origin, &capsule, &far},
+    {&capsule, &near, &box, &origin},
+  };
+  ShapeQueryResult results[3];
+  EXPECT_EQ(ShapeQuery(pairs, 3, results), 2u);
+  EXPECT_NEAR(results[0].distance, -0.3, COLLIDE_EPSILON);
+  EXPECT_NEAR(results[1].distance, 6.5, COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(results[1].normal, Vec4(0, 1, 0), COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(results[2].normal, Vec4(0, -1, 0), COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, FlatBoxes) {
+  // Zero thickness, so EPA gets a polytope with no depth in z.
+  ConvexShape flat = ConvexShape::Box(Vec4(1, 1, 0));
+  ConvexShape box = ConvexShape::Box(Vec4(1, 1, 1));
+  ShapeQueryResult r;
+  EXPECT_TRUE(ShapeQuery(flat, Matrix(), box, Matrix(Quaternion(), Vec4(0.2, 0.1, 0.5, 1)), r));
+  EXPECT_NEAR(r.distance, -0.5, COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(r.normal, Vec4(0, 0, 1), COLLIDE_EPSILON);
+
+  // Both flat and in the same plane.
+  EXPECT_TRUE(ShapeQuery(flat, Matrix(), flat, Matrix(AboutZ(0.3), Vec4(0.5, 0.2, 0, 1)), r));
+  EXPECT_TRUE(isfinite(r.distance));
+  EXPECT_LE(r.distance, 0);
+  EXPECT_NEAR(r.normal.Length3(), 1, COLLIDE_EPSILON);
+}
+
+TEST(ShapeQuery, DegenerateHull) {
+  // A box with repeated corners and points on its edges, which leaves sliver faces in EPA.
+  Vec4 points[16];
+  for (int i = 0; i < 8; ++i) {
+    points[i].Set(i & 1 ? 1 : -1, i & 2 ? 1 : -1, i & 4 ? 1 : -1, 1);
+    points[8 + i] = i < 4 ? points[i] : Vec4(0, i & 1 ? 1 : -1, i & 2 ? 1 : -1, 1);
+  }
+  ConvexShape hull = ConvexShape::Hull(points, 16);
+  ConvexShape box = ConvexShape::Box(Vec4(1, 1, 1));
+  Matrix pose(AboutZ(0.3), Vec4(0.4, 1.6, 0.2, 1));
+
+  ShapeQueryResult rHull, rBox;
+  EXPECT_TRUE(ShapeQuery(hull, Matrix(), box, pose, rHull));
+  EXPECT_TRUE(ShapeQuery(box, Matrix(), box, pose, rBox));
+  EXPECT_NEAR(rHull.distance, rBox.distance, COLLIDE_EPSILON);
+  EXPECT_VEC3_NEAR(rHull.normal, rBox.normal, COLLIDE_EPSILON);
+}
@@ -0,0 +1,130 @@
+#include <string.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mathing/gpu_pack.h"
+#include "mathing/quantize.h"
+
+using namespace mathing;
+
+namespace {
+
+Matrix MakeMatrix(int i) {
+  Quaternion q;
+  q.FromAxisAndAngle(0, 1, 0, 0.3 * i);
+  return Matrix(q, Vec4(i, 2 * i, -i, 1));
+}
+
+}  // namespace
+
+TEST(GpuPack, Layouts) {
+  Matrix m = MakeMatrix(3);
+  const Scalar *s = m.Buff();
+
+  float out[16];
+  PackMatrices(&m, 1, PackLayout(PackLayout::COLUMN_MAJOR), out);
+  for (int k = 0; k < 16; ++k) {
+    EXPECT_EQ(out[k], (float)s[k]) << k;
+  }
+
+  PackMatrices(&m, 1, PackLayout(PackLayout::ROW_MAJOR), out);
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_EQ(out[r * 4 + c], (float)s[c * 4 + r]) << r << c;
+    }
+  }
+
+  // 3 rows of the transpose, the last is the position.
+  PackMatrices(&m, 1, PackLayout(PackLayout::ROW_MAJOR, 3), out);
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_EQ(out[r * 4 + c], (float)s[c * 4 + r]) << r << c;
+    }
+  }
+  EXPECT_EQ(out[3], 3);
+  EXPECT_EQ(out[7], 6);
+  EXPECT_EQ(out[11], -3);
+
+  PackMatrices(&m, 1, PackLayout(PackLayout::COLUMN_MAJOR, 3), out);
+  for (int c = 0; c < 4; ++c) {
+    for (int r = 0; r < 3; ++r) {
+      EXPECT_EQ(out[c * 3 + r], (float)s[c * 4 + r]) << r << c;
+    }
+  }
+}
+
+TEST(GpuPack, HalfAndStride) {
+  const int count = 5;
+  Matrix in[count];
+  Quaternion rotations[count];
+  Vec4 positions[count];
+  for (int i = 0; i < count; ++i) {
+    in[i] = MakeMatrix(i);
+    rotations[i].FromMatrix(in[i]);
+    positions[i] = in[i].Pos();
+  }
+
+  // 24 bytes of halves in a 40 byte stride, leaving the rest alone.
+  PackLayout layout(PackLayout::ROW_MAJOR, 3, PackLayout::FLOAT16, 40);
+  EXPECT_EQ(layout.MatrixBytes(), 24u);
+  std::vector<uint8_t> buffer(count * 40 + 1, 0xab);
+  PackMatrices(in, count, layout, &buffer[0]);
+  for (int i = 0; i < count; ++i) {
+    uint16_t halves[12];
+    memcpy(halves, &buffer[i * 40], sizeof(halves));
+    const Scalar *s = in[i].Buff();
+    for (int r = 0; r < 3; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_EQ(halves[r * 4 + c], FloatToHalf((float)s[c * 4 + r])) << i;
+      }
+    }
+    for (int b = 24; b < 40; ++b) {
+      EXPECT_EQ(buffer[i * 40 + b], 0xab);
+    }
+  }
+
+  // From rotations and positions, the same, give or take rounding of the rebuilt matrix.
+  std::vector<uint8_t> other(buffer.size(), 0xab);
+  PackTransforms(rotations, positions, count, layout, &other[0]);
+  for (int i = 0; i < count; ++i) {
+    for (int b = 0; b < 24; b += 2) {
+      uint16_t x, y;
+      memcpy(&x, &buffer[i * 40 + b], 2);
+      memcpy(&y, &other[i * 40 + b], 2);
+      EXPECT_NEAR(HalfToFloat(x), HalfToFloat(y), 1e-3) << i << " " << b;
+    }
+  }
+  EXPECT_EQ(other[count * 40], 0xab);
+}
+
+TEST(GpuPack, TransformsMatchMatrices) {
+  Quaternion q;
+  q.FromAxisAndAngle(0.6, 0, 0.8, 1.1);
+  Vec4 p(4, -5, 6, 1);
+  Matrix m(q, p);
+
+  const PackLayout::Order orders[2] = {PackLayout::ROW_MAJOR, PackLayout::COLUMN_MAJOR};
+  for (int o = 0; o < 2; ++o) {
+    for (int rows = 3; rows <= 4; ++rows) {
+      PackLayout layout(orders[o], rows);
+      float a[16], b[16];
+      PackMatrices(&m, 1, layout, a);
+      PackTransforms(&q, &p, 1, layout, b);
+      for (size_t k = 0; k < layout.ElementCount(); ++k) {
+        EXPECT_EQ(a[k], b[k]) << o << " " << rows << " " << k;
+      }
+    }
+  }
+}
+
+TEST(GpuPack, Unaligned) {
+  Matrix m = MakeMatrix(1);
+  alignas(16) uint8_t buffer[4 + 64];
+  PackMatrices(&m, 1, PackLayout(), buffer + 4);
+  float out[16];
+  memcpy(out, buffer + 4, sizeof(out));
+  for (int k = 0; k < 16; ++k) {
+    EXPECT_EQ(out[k], (float)m.Buff()[k]) << k;
+  }
+}
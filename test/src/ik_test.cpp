@@ -0,0 +1,88 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/ik.h"
+
+using namespace mathing;
+
+// An arm of 3 unit bones along x.
+static size_t AddArm(IKChains &chains, const Vec4 &target) {
+  size_t c = chains.AddChain(3);
+  for (int j = 0; j < 3; ++j) {
+    chains.Offsets(c)[j].Set(1, 0, 0);
+  }
+  chains.Target(c) = target;
+  return c;
+}
+
+TEST(IKChains, ForwardKinematics) {
+  IKChains chains;
+  size_t c = AddArm(chains, Vec4());
+  chains.RootPosition(c).Set(1, 2, 3, 1);
+  chains.LocalRotations(c)[1].FromAxisAndAngle(0, 0, 1, M_PI / 2);
+  chains.UpdateWorld();
+
+  const Vec4 *pos = chains.WorldPositions(c);
+  // Joint 1 turns its own bone, so the arm bends at joint 1.
+  EXPECT_NEAR(pos[1].x, 2, 1e-12);
+  EXPECT_NEAR(pos[2].x, 2, 1e-12);
+  EXPECT_NEAR(pos[2].y, 3, 1e-12);
+  EXPECT_NEAR(pos[3].x, 2, 1e-12);
+  EXPECT_NEAR(pos[3].y, 4, 1e-12);
+  EXPECT_NEAR(pos[3].z, 3, 1e-12);
+}
+
+TEST(IKChains, SolversReachTarget) {
+  IKChains chains;
+  Vec4 targets[3] = {Vec4(1, 1.5, 0.5, 1), Vec4(-1, 1, 1, 1), Vec4(0.5, -2, 0, 1)};
+  for (int i = 0; i < 3; ++i) {
+    AddArm(chains, targets[i]);
+  }
+  IKSettings settings(64, 1e-6);
+
+  // As if on two threads.
+  chains.SolveCCD(settings, 0, 2);
+  chains.SolveCCD(settings, 2);
+  for (size_t c = 0; c < 3; ++c) {
+    EXPECT_LT(chains.Error(c), 1e-6) << "CCD chain " << c;
+  }
+
+  IKChains fabrik;
+  for (int i = 0; i < 3; ++i) {
+    AddArm(fabrik, targets[i]);
+  }
+  fabrik.SolveFABRIK(settings);
+  for (size_t c = 0; c < 3; ++c) {
+    EXPECT_LT(fabrik.Error(c), 1e-5) << "FABRIK chain " << c;
+    // The bones keep their lengths, the rotations do all the work.
+    const Vec4 *pos = fabrik.WorldPositions(c);
+    for (int j = 0; j < 3; ++j) {
+      EXPECT_NEAR((pos[j + 1] - pos[j]).Length3(), 1, 1e-12);
+    }
+  }
+}
+
+TEST(IKChains, UnreachableStretchesOut) {
+  IKChains chains;
+  size_t c = AddArm(chains, Vec4(0, 10, 0, 1));
+  chains.SolveFABRIK(IKSettings(8, 1e-6));
+  EXPECT_EQ(chains.Iterations(c), 8);
+  EXPECT_NEAR(chains.WorldPositions(c)[3].y, 3, 1e-9);
+  EXPECT_NEAR(chains.Error(c), 7, 1e-9);
+}
+
+TEST(IKChains, JointLimits) {
+  IKChains chains;
+  size_t c = AddArm(chains, Vec4(-1, 0.5, 0, 1));
+  for (int j = 0; j < 3; ++j) {
+    chains.SetJointLimit(c, j, M_PI / 4);
+  }
+  chains.SolveCCD(IKSettings(32, 1e-6));
+
+  Scalar cosHalf = cos(M_PI / 8);
+  for (int j = 0; j < 3; ++j) {
+    EXPECT_GE(fabs(chains.LocalRotations(c)[j].w), cosHalf - 1e-12);
+  }
+  // It can't fold back far enough.
+  EXPECT_GT(chains.Error(c), 0.1);
+}
@@ -0,0 +1,53 @@
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "mathing/instrument.h"
+#include "mathing/matrix.h"
+
+using namespace mathing;
+
+TEST(Instrument, Counts) {
+  InstrumentReset();
+  Quaternion q;
+  q.FromAxisAndAngle(0, 1, 0, 0.5);
+  Matrix m(q, Vec4(1, 2, 3, 1));
+  Matrix product = Matrix::Identity();
+  for (int i = 0; i < 1000; ++i) {
+    product *= m;
+  }
+  std::thread other([&m]() {
+    for (int i = 0; i < 100; ++i) {
+      m.Inverse();
+    }
+  });
+  other.join();
+
+  InstrumentCounts counts;
+  InstrumentSnapshot(counts);
+  if (!InstrumentEnabled()) {
+    // Nothing is counted, and nothing is left behind in the code either.
+    EXPECT_EQ(counts.calls[INSTRUMENT_MATRIX_MULTIPLY], 0u);
+    return;
+  }
+  EXPECT_EQ(counts.calls[INSTRUMENT_MATRIX_MULTIPLY], 1000u);
+  EXPECT_EQ(counts.sampledCalls[INSTRUMENT_MATRIX_MULTIPLY], 1000u / INSTRUMENT_SAMPLE_PERIOD);
+  // From a thread that's finished.
+  EXPECT_EQ(counts.calls[INSTRUMENT_MATRIX_INVERSE], 100u);
+
+  std::ostringstream os;
+  InstrumentReport(os, counts);
+  EXPECT_NE(os.str().find("Matrix::operator*"), std::string::npos);
+  EXPECT_NE(os.str().find("1000"), std::string::npos);
+  EXPECT_EQ(os.str().find("Quaternion::Slerp"), std::string::npos);
+
+  InstrumentReset();
+  InstrumentSnapshot(counts);
+  EXPECT_EQ(counts.calls[INSTRUMENT_MATRIX_MULTIPLY], 0u);
+}
+
+TEST(Instrument, Names) {
+  EXPECT_STREQ(InstrumentOpName(INSTRUMENT_QUATERNION_SLERP), "Quaternion::Slerp");
+  EXPECT_STREQ(InstrumentOpName(INSTRUMENT_OP_COUNT), "");
+}
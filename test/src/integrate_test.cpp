@@ -0,0 +1,105 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/integrate.h"
+
+#define INTEGRATE_EPSILON 1.0e-12
+
+#define EXPECT_QUAT_NEAR(a, b, eps) \
+  EXPECT_NEAR(a.x, b.x, eps) << a; \
+  EXPECT_NEAR(a.y, b.y, eps) << a; \
+  EXPECT_NEAR(a.z, b.z, eps) << a; \
+  EXPECT_NEAR(a.w, b.w, eps) << a;
+
+using namespace mathing;
+
+TEST(Integrate, ExpMapIsExactForConstantSpin) {
+  const int bodies = 3;
+  Vec4 pos[bodies], vel[bodies], angVel[bodies];
+  Quaternion rot[bodies];
+  Matrix world[bodies];
+  for (int i = 0; i < bodies; ++i) {
+    vel[i].Set(1, 0, 0);
+    angVel[i].Set(0, 0, M_PI / 2 * (i + 1));
+  }
+  Vec4 gravity[bodies] = {Vec4(0, -10, 0), Vec4(0, -10, 0), Vec4(0, -10, 0)};
+
+  RigidBodyArrays arrays;
+  arrays.position = pos;
+  arrays.velocity = vel;
+  arrays.orientation = rot;
+  arrays.angularVelocity = angVel;
+  arrays.acceleration = gravity;
+  arrays.world = world;
+  arrays.count = bodies;
+
+  for (int step = 0; step < 100; ++step) {
+    IntegrateExpMap(arrays, 0.01);
+  }
+
+  for (int i = 0; i < bodies; ++i) {
+    Quaternion expected;
+    expected.FromAxisAndAngle(0, 0, 1, M_PI / 2 * (i + 1));
+    // Either sign is the same rotation.
+    if (expected.w * rot[i].w + expected.z * rot[i].z < 0) {
+      expected.Set(-expected.x, -expected.y, -expected.z, -expected.w);
+    }
+    EXPECT_QUAT_NEAR(rot[i], expected, 1e-9);
+
+    // Semi-implicit Euler on the position: v is updated first.
+    EXPECT_NEAR(pos[i].x, 1, INTEGRATE_EPSILON);
+    EXPECT_NEAR(pos[i].y, -10 * 0.01 * 0.01 * 100 * 101 / 2, 1e-9);
+    Matrix m(rot[i], pos[i]);
+    for (int k = 0; k < 16; ++k) {
+      EXPECT_EQ(world[i].Buff()[k], m.Buff()[k]);
+    }
+  }
+}
+
+TEST(Integrate, WorldSpaceAngularVelocity) {
+  // Turned 90 about x first, then spun 90 about world z.
+  Vec4 pos, vel, angVel(0, 0, M_PI / 2);
+  Quaternion rot;
+  rot.FromAxisAndAngle(1, 0, 0, M_PI / 2);
+  Quaternion start = rot;
+
+  RigidBodyArrays arrays;
+  arrays.position = &pos;
+  arrays.velocity = &vel;
+  arrays.orientation = &rot;
+  arrays.angularVelocity = &angVel;
+  arrays.count = 1;
+  IntegrateExpMap(arrays, 1);
+
+  Quaternion spin;
+  spin.FromAxisAndAngle(0, 0, 1, M_PI / 2);
+  Matrix expected = Matrix(start) * Matrix(spin);
+  Matrix m(rot);
+  for (int k = 0; k < 16; ++k) {
+    EXPECT_NEAR(m.Buff()[k], expected.Buff()[k], INTEGRATE_EPSILON);
+  }
+}
+
+TEST(Integrate, EulerStaysNormalized) {
+  Vec4 pos, vel, angVel(3, -2, 5);
+  Quaternion rot;
+  RigidBodyArrays arrays;
+  arrays.position = &pos;
+  arrays.velocity = &vel;
+  arrays.orientation = &rot;
+  arrays.angularVelocity = &angVel;
+  arrays.count = 1;
+
+  Vec4 exactVel = angVel;
+  Quaternion exact;
+  RigidBodyArrays exactArrays = arrays;
+  exactArrays.orientation = &exact;
+  exactArrays.angularVelocity = &exactVel;
+
+  for (int step = 0; step < 1000; ++step) {
+    IntegrateEuler(arrays, 0.001);
+    IntegrateExpMap(exactArrays, 0.001);
+    EXPECT_NEAR(rot.x * rot.x + rot.y * rot.y + rot.z * rot.z + rot.w * rot.w, 1, INTEGRATE_EPSILON);
+  }
+  EXPECT_QUAT_NEAR(rot, exact, 1e-2);
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "mathing/intersect.h"
+
+#define HIT_EPSILON 1.0e-12
+
+using namespace mathing;
+
+// Triangle in the z=0 plane.
+static const Vec4 g_v0(0, 0, 0, 1);
+static const Vec4 g_v1(1, 0, 0, 1);
+static const Vec4 g_v2(0, 1, 0, 1);
+
+TEST(IntersectTriangle, Single) {
+  Scalar t, u, v;
+  EXPECT_TRUE(IntersectTriangle(Vec4(0.25, 0.5, 2, 1), Vec4(0, 0, -1), g_v0, g_v1, g_v2, t, u, v));
+  EXPECT_NEAR(t, 2, HIT_EPSILON);
+  EXPECT_NEAR(u, 0.25, HIT_EPSILON);
+  EXPECT_NEAR(v, 0.5, HIT_EPSILON);
+
+  EXPECT_FALSE(IntersectTriangle(Vec4(0.75, 0.5, 2, 1), Vec4(0, 0, -1), g_v0, g_v1, g_v2, t, u, v));
+  EXPECT_FALSE(IntersectTriangle(Vec4(0.25, 0.5, 2, 1), Vec4(0, 0, 1), g_v0, g_v1, g_v2, t, u, v));
+}
+
+TEST(IntersectTriangle, Packet4) {
+  RayPacket4 rays;
+  rays.Set(0, Vec4(0.25, 0.25, 1, 1), Vec4(0, 0, -1));
+  rays.Set(1, Vec4(2, 2, 1, 1), Vec4(0, 0, -1));       // misses
+  rays.Set(2, Vec4(0.5, 0.25, -3, 1), Vec4(0, 0, 1));   // from behind
+  rays.Set(3, Vec4(0.1, 0.1, 5, 1), Vec4(0, 0, -1), 0, 4);  // out of range
+
+  PacketHit4 hit;
+  hit.Reset(rays);
+  EXPECT_EQ(IntersectTriangle(rays, g_v0, g_v1, g_v2, hit, 7), 0x5u);
+  EXPECT_NEAR(hit.t[0], 1, HIT_EPSILON);
+  EXPECT_NEAR(hit.t[2], 3, HIT_EPSILON);
+  EXPECT_NEAR(hit.u[2], 0.5, HIT_EPSILON);
+  EXPECT_NEAR(hit.v[2], 0.25, HIT_EPSILON);
+  EXPECT_EQ(hit.prim[0], 7);
+  EXPECT_EQ(hit.prim[1], -1);
+  EXPECT_EQ(hit.prim[3], -1);
+}
+
+TEST(IntersectTriangle, PacketClosestHit) {
+  // Two stacked triangles, the nearer one wins regardless of order.
+  Vec4 verts[6] = {
+    Vec4(0, 0, -1, 1), Vec4(1, 0, -1, 1), Vec4(0, 1, -1, 1),
+    g_v0, g_v1, g_v2,
+  };
+  RayPacket16 rays;
+  for (int i = 0; i < 16; ++i) {
+    rays.Set(i, Vec4(0.05 * (i % 4), 0.05 * (i / 4), 2, 1), Vec4(0, 0, -1));
+  }
+  PacketHit16 hit;
+  hit.Reset(rays);
+  EXPECT_EQ(IntersectTriangles(rays, verts, 2, hit), 0xFFFFu);
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_NEAR(hit.t[i], 2, HIT_EPSILON);
+    EXPECT_EQ(hit.prim[i], 1);
+  }
+}
+
+TEST(IntersectBox, PacketMatchesSingle) {
+  Vec4 boxMin(-1, -1, -1, 1);
+  Vec4 boxMax(1, 1, 1, 1);
+
+  RayPacket8 rays;
+  for (int i = 0; i < 8; ++i) {
+    // Fan of rays from outside the box, some of which miss, one axis aligned.
+    rays.Set(i, Vec4(-3, 0.5 * i - 1.75, 0.25, 1), Vec4(1, 0.1 * (i - 4), 0));
+  }
+  Scalar tNear[8];
+  unsigned int mask = IntersectBox(rays, boxMin, boxMax, tNear);
+
+  for (int i = 0; i < 8; ++i) {
+    Scalar tn, tf;
+    Vec4 o(rays.ox[i], rays.oy[i], rays.oz[i], 1);
+    Vec4 d(rays.dx[i], rays.dy[i], rays.dz[i]);
+    bool single = IntersectBox(o, d, boxMin, boxMax, tn, tf);
+    EXPECT_EQ(single, ((mask >> i) & 1) != 0) << "lane " << i;
+    if (single) {
+      EXPECT_NEAR(tNear[i], tn, HIT_EPSILON);
+    }
+  }
+  // The axis aligned lane goes straight through from x=-3.
+  EXPECT_TRUE(mask & (1 << 4));
+  EXPECT_NEAR(tNear[4], 2, HIT_EPSILON);
+}
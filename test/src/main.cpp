@@ -1,3 +1,5 @@
+#include <math.h>
+
 #include "gtest/gtest.h"
 #include "mathing/matrix.h"
 #include "mathing/util.h"
@@ -76,6 +78,210 @@ TEST(MatrixConstruct, FromQuat90AxisAngle) {
   EXPECT_MATRIX_ARY_EQ(m, g_ary_z90);
 }
 
+TEST(MatrixConstruct, LookAt) {
+  // Looking down +x from (1, 2, 3), with y up, gives X = up x Z = -z.
+  Matrix m = Matrix::LookAt(Vec4(1, 2, 3, 1), Vec4(5, 2, 3, 1));
+  Scalar expected[16] = {
+    0, 0, -1, 0,
+    0, 1, 0, 0,
+    1, 0, 0, 0,
+    1, 2, 3, 1,
+  };
+  EXPECT_MATRIX_ARY_EQ(m, expected);
+}
+
+TEST(MatrixConstruct, LookAtDegenerate) {
+  const int count = 4;
+  Vec4 eyes[count] = {Vec4(0, 0, 0, 1), Vec4(0, 0, 0, 1), Vec4(1, 1, 1, 1), Vec4(0, 0, 0, 1)};
+  // Straight up, straight down, at the eye, and along a skewed direction.
+  Vec4 targets[count] = {Vec4(0, 3, 0, 1), Vec4(0, -2, 0, 1), Vec4(1, 1, 1, 1), Vec4(1, 2, -3, 1)};
+  Matrix out[count];
+  Matrix::LookAt(eyes, targets, Vec4::m_UnitY, out, count);
+
+  for (int i = 0; i < count; ++i) {
+    const Vec4 &x = out[i].AxisX(), &y = out[i].AxisY(), &z = out[i].AxisZ();
+    EXPECT_NEAR(x.Length3(), 1, MAT_EPSILON) << i;
+    EXPECT_NEAR(y.Length3(), 1, MAT_EPSILON) << i;
+    EXPECT_NEAR(z.Length3(), 1, MAT_EPSILON) << i;
+    EXPECT_NEAR(Vec4::Dot3(x, y), 0, MAT_EPSILON) << i;
+    EXPECT_NEAR(Vec4::Dot3(y, z), 0, MAT_EPSILON) << i;
+    // Right handed
+    EXPECT_NEAR(Vec4::Dot3(Vec4::Cross(x, y), z), 1, MAT_EPSILON) << i;
+    EXPECT_EQ(out[i].Pos().x, eyes[i].x);
+  }
+  EXPECT_NEAR(out[0].AxisZ().y, 1, MAT_EPSILON);
+  EXPECT_NEAR(out[1].AxisZ().y, -1, MAT_EPSILON);
+  EXPECT_NEAR(out[2].AxisZ().z, 1, MAT_EPSILON);
+  EXPECT_NEAR(out[3].AxisZ().z, -3 / sqrt(14.0), MAT_EPSILON);
+  EXPECT_GT(out[3].AxisY().y, 0);
+}
+
+TEST(MatrixMultiply, FullProduct) {
+  // Every element different, and none of the last column 0,0,0,1, so a wrong index shows.
+  Scalar a[16], b[16], expected[16];
+  for (int i = 0; i < 16; ++i) {
+    a[i] = i + 1;
+    b[i] = (i * 7) % 16 - 8;
+  }
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      expected[r * 4 + c] = 0;
+      for (int k = 0; k < 4; ++k) {
+        expected[r * 4 + c] += a[r * 4 + k] * b[k * 4 + c];
+      }
+    }
+  }
+  Matrix ma(a), mb(b);
+  Matrix product = ma * mb;
+  EXPECT_MATRIX_ARY_EQ(product, expected);
+  ma *= mb;
+  EXPECT_MATRIX_ARY_EQ(ma, expected);
+}
+
+TEST(MatrixOrthonormalize, Drift) {
+  // A long chain of small rotations, with a little error in each, drifts.
+  Quaternion q;
+  q.FromAxisAndAngle(0.6, 0, 0.8, 0.001);
+  Matrix step(q, Vec4(0.01, 0, 0, 1));
+  step.AxisX().x += 1e-12;
+  Matrix chain[2];
+  chain[0] = chain[1] = Matrix::Identity();
+  for (int i = 0; i < 10000; ++i) {
+    chain[0] *= step;
+    chain[1] *= step;
+  }
+  EXPECT_TRUE(chain[0].IsDrifted());
+  Vec4 pos = chain[0].Pos();
+
+  // Only the drifted ones are fixed.
+  Matrix matrices[3] = {chain[0], Matrix::Identity(), chain[1]};
+  EXPECT_EQ(Matrix::OrthonormalizeGramSchmidt(matrices, 2), 1u);
+  EXPECT_EQ(Matrix::OrthonormalizePolar(matrices + 1, 2), 1u);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_LT(matrices[i].OrthonormalDrift(), 1e-15) << i;
+    Matrix ident = matrices[i] * matrices[i].Inverse();
+    EXPECT_MATRIX_ARY_EQ(ident, g_ident);
+  }
+  EXPECT_EQ(matrices[0].Pos().x, pos.x);
+  EXPECT_NEAR(Vec4::Dot3(Vec4::Cross(matrices[2].AxisX(), matrices[2].AxisY()), matrices[2].AxisZ()), 1, MAT_EPSILON);
+}
+
+TEST(MatrixOrthonormalize, GramSchmidtAndPolar) {
+  Quaternion q;
+  q.FromAxisAndAngle(0, 0, 1, 0.5);
+  Matrix rotation(q);
+  Matrix skewed = rotation;
+  skewed.AxisX() = skewed.AxisX() + Vec4(0, 1e-6, 0, 0);
+  skewed.AxisY() = skewed.AxisY() + Vec4(1e-6, 0, 0, 0);
+
+  // Gram-Schmidt keeps the direction of X.
+  Matrix gs = skewed;
+  gs.OrthonormalizeGramSchmidt();
+  Vec4 x = skewed.AxisX();
+  x.Normalize3();
+  EXPECT_NEAR(gs.AxisX().x, x.x, MAT_EPSILON);
+  EXPECT_NEAR(gs.AxisX().y, x.y, MAT_EPSILON);
+
+  // Polar is the closest rotation, and an error symmetric across the axes leaves the rotation
+  // to first order.
+  Matrix polar = skewed;
+  polar.OrthonormalizePolar();
+  EXPECT_LT(polar.OrthonormalDrift(), 1e-15);
+  for (int i = 0; i < 12; ++i) {
+    EXPECT_NEAR(polar.Buff()[i], rotation.Buff()[i], 1e-11) << i;
+  }
+}
+
+TEST(MatrixDecompose, ScaleRotationPosition) {
+  const int count = 3;
+  Quaternion q[count];
+  q[0].FromAxisAndAngle(0, 1, 0, 1.2);
+  q[1].FromAxisAndAngle(1 / sqrt(2.0), 0, -1 / sqrt(2.0), 3.1);
+  q[2].FromAxisAndAngle(0, 0, 1, M_PI);
+  Vec4 scales[count] = {Vec4(2, 3, 0.5, 0), Vec4(1, 1, 1, 0), Vec4(4, 0.25, -2, 0)};
+  Matrix m[count];
+  for (int i = 0; i < count; ++i) {
+    Matrix r(q[i], Vec4(i, -i, 10, 1));
+    m[i].Set(r.AxisX() * scales[i].x, r.AxisY() * scales[i].y, r.AxisZ() * scales[i].z, r.Pos());
+  }
+
+  Quaternion rotation[count];
+  Vec4 scale[count], position[count];
+  EXPECT_EQ(Matrix::Decompose(m, rotation, scale, position, count), (size_t)count);
+  for (int i = 0; i < count; ++i) {
+    Scalar dot = rotation[i].x * q[i].x + rotation[i].y * q[i].y + rotation[i].z * q[i].z + rotation[i].w * q[i].w;
+    EXPECT_NEAR(fabs(dot), 1, 1e-14) << i;
+    EXPECT_NEAR(scale[i].x, scales[i].x, 1e-14) << i;
+    EXPECT_NEAR(scale[i].y, scales[i].y, 1e-14) << i;
+    EXPECT_NEAR(scale[i].z, scales[i].z, 1e-14) << i;
+    EXPECT_EQ(position[i].x, i);
+  }
+
+  Matrix flat(Vec4(1, 0, 0, 0), Vec4(2, 0, 0, 0), Vec4(0, 0, 1, 0));
+  EXPECT_FALSE(flat.Decompose(rotation[0], scale[0], position[0]));
+  EXPECT_EQ(rotation[0].w, 1);
+}
+
+TEST(MatrixProjection, Perspective) {
+  Matrix proj = Matrix::Perspective(M_PI / 2, 2, 1, 101);
+  Vec4 nearCorner = proj.Project(Vec4(2, 1, 1, 1));
+  EXPECT_NEAR(nearCorner.x / nearCorner.w, 1, 1e-15);
+  EXPECT_NEAR(nearCorner.y / nearCorner.w, 1, 1e-15);
+  EXPECT_NEAR(nearCorner.z / nearCorner.w, 0, 1e-15);
+  EXPECT_EQ(nearCorner.w, 1);
+  Vec4 farCenter = proj.Project(Vec4(0, 0, 101, 1));
+  EXPECT_NEAR(farCenter.z / farCenter.w, 1, 1e-15);
+  EXPECT_EQ(farCenter.w, 101);
+}
+
+TEST(MatrixProjection, Orthographic) {
+  Matrix proj = Matrix::Orthographic(-4, 2, -1, 3, 2, 10);
+  Vec4 low = proj.Project(Vec4(-4, -1, 2, 1));
+  Vec4 high = proj.Project(Vec4(2, 3, 10, 1));
+  Scalar expectLow[4] = {-1, -1, 0, 1}, expectHigh[4] = {1, 1, 1, 1};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR((&low.x)[i], expectLow[i], 1e-15) << i;
+    EXPECT_NEAR((&high.x)[i], expectHigh[i], 1e-15) << i;
+  }
+}
+
+TEST(MatrixProjection, ToClip) {
+  // Camera at z = -10 looking at the origin, so view z is world z + 10.
+  Matrix viewProj = Matrix::View(Vec4(0, 0, -10, 1), Vec4(0, 0, 0, 1)) * Matrix::Perspective(M_PI / 2, 1, 1, 100);
+  const int count = 6;
+  Vec4 in[count] = {
+    Vec4(0, 0, 0, 1),       // center
+    Vec4(-20, 0, 0, 1),     // left
+    Vec4(0, 20, 0, 1),      // top
+    Vec4(0, 0, -9.5, 1),    // in front of the near plane
+    Vec4(0, 0, 100, 1),     // past the far plane
+    Vec4(5, -20, -20, 1),   // behind the eye
+  };
+  // With w < 0 behind the eye, -w > w, so x there is outside both sides.
+  unsigned char expect[count] = {0, CLIP_LEFT, CLIP_TOP, CLIP_NEAR, CLIP_FAR, CLIP_LEFT | CLIP_RIGHT | CLIP_BOTTOM | CLIP_NEAR};
+  Vec4 out[count];
+  unsigned char codes[count];
+  EXPECT_EQ(viewProj.ToClip(in, out, codes, count), 0u);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(codes[i], expect[i]) << i;
+    Vec4 clip = viewProj.Project(in[i]);
+    if (clip.w > 0) {
+      EXPECT_NEAR(out[i].x, clip.x / clip.w, 1e-14) << i;
+      EXPECT_NEAR(out[i].y, clip.y / clip.w, 1e-14) << i;
+      EXPECT_NEAR(out[i].z, clip.z / clip.w, 1e-14) << i;
+      EXPECT_NEAR(out[i].w, 1 / clip.w, 1e-14) << i;
+    } else {
+      EXPECT_EQ(out[i].z, clip.z) << i;
+      EXPECT_EQ(out[i].w, clip.w) << i;
+    }
+  }
+  EXPECT_NEAR(out[0].z, (10 - 1) * 100 / 99.0 / 10, 1e-14);
+
+  // All past the far plane, in place.
+  Vec4 far[2] = {Vec4(1, 1, 200, 1), Vec4(-1, 0, 300, 1)};
+  EXPECT_EQ(viewProj.ToClip(far, far, codes, 2), (unsigned)CLIP_FAR);
+}
+
 
 #if 0
   // Logical messing around.
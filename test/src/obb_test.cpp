@@ -0,0 +1,91 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mathing/collide.h"
+#include "mathing/obb.h"
+
+using namespace mathing;
+
+static Quaternion AxisAngle(Scalar x, Scalar y, Scalar z, Scalar radians) {
+  Quaternion q;
+  q.FromAxisAndAngle(x, y, z, radians);
+  return q;
+}
+
+static Scalar Random(Scalar lo, Scalar hi) {
+  return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+TEST(ObbOverlap, FaceAxes) {
+  Vec4 half(1, 1, 1);
+  EXPECT_TRUE(ObbOverlap(Matrix(), half, Matrix(Quaternion(), Vec4(1.9, 0, 0, 1)), half));
+  EXPECT_FALSE(ObbOverlap(Matrix(), half, Matrix(Quaternion(), Vec4(2.1, 0, 0, 1)), half));
+  // B's corner points at A, so B reaches sqrt(2) along x.
+  Matrix turned(AxisAngle(0, 0, 1, M_PI / 4), Vec4(2.3, 0, 0, 1));
+  EXPECT_TRUE(ObbOverlap(Matrix(), half, turned, half));
+}
+
+TEST(ObbOverlap, EdgeAxis) {
+  // A's leading edge runs along z, B's along y, crossing each other. The gap between them is
+  // along x, which is only an axis as the cross product of the two edges.
+  Vec4 half(1, 1, 1);
+  Matrix a(AxisAngle(0, 0, 1, M_PI / 4), Vec4(0, 0, 0, 1));
+  Matrix apart(AxisAngle(0, 1, 0, M_PI / 4), Vec4(3.2, 0, 0, 1));
+  Matrix crossing(AxisAngle(0, 1, 0, M_PI / 4), Vec4(2.7, 0, 0, 1));
+  EXPECT_FALSE(ObbOverlap(a, half, apart, half));
+  EXPECT_TRUE(ObbOverlap(a, half, crossing, half));
+}
+
+TEST(ObbOverlap, BatchMatchesGjk) {
+  srand(3);
+  const int boxes = 40;
+  std::vector<Matrix> poses(boxes);
+  std::vector<Vec4> halves(boxes);
+  for (int i = 0; i < boxes; ++i) {
+    Vec4 axis(Random(-1, 1), Random(-1, 1), Random(-1, 1));
+    axis.Normalize3();
+    poses[i].Set(AxisAngle(axis.x, axis.y, axis.z, Random(0, M_PI)),
+                 Vec4(Random(-3, 3), Random(-3, 3), Random(-3, 3), 1));
+    halves[i].Set(Random(0.2, 1.5), Random(0.2, 1.5), Random(0.2, 1.5));
+  }
+
+  std::vector<uint32_t> pairs;
+  for (int i = 0; i < boxes; ++i) {
+    for (int j = i + 1; j < boxes; ++j) {
+      pairs.push_back(i);
+      pairs.push_back(j);
+    }
+  }
+  size_t pairCount = pairs.size() / 2;
+  std::vector<char> overlaps(pairCount);
+  size_t found = ObbOverlap(&poses[0], &halves[0], &pairs[0], pairCount, (bool *)&overlaps[0]);
+
+  size_t expected = 0;
+  for (size_t p = 0; p < pairCount; ++p) {
+    int i = pairs[p * 2], j = pairs[p * 2 + 1];
+    ShapeQueryResult r;
+    bool gjk = ShapeQuery(ConvexShape::Box(halves[i]), poses[i], ConvexShape::Box(halves[j]), poses[j], r);
+    if (fabs(r.distance) < 1e-6) {
+      continue;  // too close to call
+    }
+    EXPECT_EQ((bool)overlaps[p], gjk) << i << " vs " << j;
+    EXPECT_EQ((bool)overlaps[p], ObbOverlap(poses[i], halves[i], poses[j], halves[j]));
+    expected += gjk;
+  }
+  EXPECT_EQ(found, expected);
+  EXPECT_GT(found, 0u);
+}
+
+TEST(ObbSphereOverlap, CornerAndFace) {
+  Matrix pose(AxisAngle(0, 0, 1, M_PI / 4), Vec4(1, 1, 0, 1));
+  Vec4 half(1, 1, 1);
+  // The corner of the turned box is at (1 + sqrt(2), 1, 0).
+  Vec4 centers[2] = {Vec4(1 + sqrt(2.0) + 0.4, 1, 0, 1), Vec4(1 + sqrt(2.0) + 0.6, 1, 0, 1)};
+  Scalar radii[2] = {0.5, 0.5};
+  bool overlaps[2];
+  EXPECT_EQ(ObbSphereOverlap(&pose, &half, centers, radii, 1, overlaps), 1u);
+  EXPECT_FALSE(ObbSphereOverlap(pose, half, centers[1], radii[1]));
+}
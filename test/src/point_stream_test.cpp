@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define POINT_STREAM_TEST_MKSTEMP
+#endif
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mathing/point_stream.h"
+#include "mathing/vec3.h"
+
+using namespace mathing;
+
+namespace {
+
+Matrix MakeTransform() {
+  Quaternion q;
+  q.FromAxisAndAngle(0, 0, 1, 0.5);
+  return Matrix(q, Vec4(1, 2, 3, 1));
+}
+
+std::vector<Vec3f> MakePoints(size_t count) {
+  std::vector<Vec3f> points(count);
+  for (size_t i = 0; i < count; ++i) {
+    points[i].Set(i * 0.5f, -(float)i, 100.0f - i);
+  }
+  return points;
+}
+
+template <typename T>
+std::vector<T> ReadAll(FILE *f) {
+  fflush(f);
+  rewind(f);
+  std::vector<T> points;
+  T p;
+  while (fread(&p, sizeof(p), 1, f) == 1) {
+    points.push_back(p);
+  }
+  return points;
+}
+
+}  // namespace
+
+TEST(PointStream, Run) {
+  // Chunks that don't divide the points, so the last is short.
+  const size_t count = 1000;
+  std::vector<Vec3f> points = MakePoints(count);
+  FILE *in = tmpfile();
+  fwrite(&points[0], sizeof(Vec3f), count, in);
+  rewind(in);
+
+  Matrix m = MakeTransform();
+  FILE *out = tmpfile();
+  PointTransformer transformer(m, PointTransformer::FLOAT32, PointTransformer::FLOAT64, 64);
+  EXPECT_TRUE(transformer.Run(in, out));
+  EXPECT_EQ(transformer.PointCount(), count);
+
+  std::vector<Vec3d> result = ReadAll<Vec3d>(out);
+  ASSERT_EQ(result.size(), count);
+  for (size_t i = 0; i < count; ++i) {
+    Vec4 expected = m.Transform(Vec4(points[i].x, points[i].y, points[i].z, 1));
+    EXPECT_NEAR(result[i].x, expected.x, 1e-12) << i;
+    EXPECT_NEAR(result[i].y, expected.y, 1e-12) << i;
+    EXPECT_NEAR(result[i].z, expected.z, 1e-12) << i;
+  }
+  fclose(in);
+  fclose(out);
+}
+
+TEST(PointStream, PartialPoint) {
+  std::vector<Vec3f> points = MakePoints(10);
+  FILE *in = tmpfile();
+  fwrite(&points[0], 1, sizeof(Vec3f) * 10 - 4, in);
+  rewind(in);
+  FILE *out = tmpfile();
+  PointTransformer transformer(Matrix::Identity(), PointTransformer::FLOAT32, PointTransformer::FLOAT32, 4);
+  EXPECT_FALSE(transformer.Run(in, out));
+  EXPECT_EQ(transformer.PointCount(), 8u);
+  fclose(in);
+  fclose(out);
+}
+
+TEST(PointStream, WholeChunks) {
+  // The file ends right at the end of a chunk, so the last read gets nothing.
+  const size_t count = 256;
+  std::vector<Vec3f> points = MakePoints(count);
+  FILE *in = tmpfile();
+  fwrite(&points[0], sizeof(Vec3f), count, in);
+  rewind(in);
+  FILE *out = tmpfile();
+  PointTransformer transformer(Matrix::Identity(), PointTransformer::FLOAT32, PointTransformer::FLOAT32, 64);
+  EXPECT_TRUE(transformer.Run(in, out));
+  EXPECT_EQ(transformer.PointCount(), count);
+  std::vector<Vec3f> result = ReadAll<Vec3f>(out);
+  ASSERT_EQ(result.size(), count);
+  EXPECT_EQ(result[count - 1].z, points[count - 1].z);
+  fclose(in);
+  fclose(out);
+}
+
+#ifdef POINT_STREAM_TEST_MKSTEMP
+TEST(PointStream, RunMapped) {
+  const size_t count = 5000;
+  std::vector<Vec3f> points = MakePoints(count);
+  std::vector<Vec3d> doubles(count);
+  for (size_t i = 0; i < count; ++i) {
+    doubles[i].Set(points[i].x, points[i].y, points[i].z);
+  }
+
+  char path[] = "/tmp/point_stream_testXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  FILE *in = fdopen(fd, "wb");
+  fwrite(&doubles[0], sizeof(Vec3d), count, in);
+  fclose(in);
+
+  // The chunks cross page boundaries, and the mapped and read results are the same.
+  Matrix m = MakeTransform();
+  FILE *mappedOut = tmpfile();
+  PointTransformer transformer(m, PointTransformer::FLOAT64, PointTransformer::FLOAT32, 1000);
+  EXPECT_TRUE(transformer.RunMapped(path, mappedOut));
+  EXPECT_EQ(transformer.PointCount(), count);
+
+  FILE *readIn = fopen(path, "rb");
+  FILE *readOut = tmpfile();
+  EXPECT_TRUE(transformer.Run(readIn, readOut));
+  fclose(readIn);
+  unlink(path);
+
+  std::vector<Vec3f> mapped = ReadAll<Vec3f>(mappedOut);
+  std::vector<Vec3f> read = ReadAll<Vec3f>(readOut);
+  ASSERT_EQ(mapped.size(), count);
+  ASSERT_EQ(read.size(), count);
+  for (size_t i = 0; i < count; ++i) {
+    EXPECT_EQ(mapped[i].x, read[i].x) << i;
+    EXPECT_EQ(mapped[i].z, read[i].z) << i;
+  }
+  Vec4 expected = m.Transform(Vec4(doubles[4321].x, doubles[4321].y, doubles[4321].z, 1));
+  EXPECT_NEAR(mapped[4321].y, expected.y, 1e-3);
+  EXPECT_FALSE(transformer.RunMapped("/nonexistent/points", readOut));
+  fclose(mappedOut);
+  fclose(readOut);
+}
+#endif  // POINT_STREAM_TEST_MKSTEMP
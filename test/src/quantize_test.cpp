@@ -0,0 +1,121 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/quantize.h"
+
+using namespace mathing;
+
+TEST(Quantize, Sizes) {
+  EXPECT_EQ(sizeof(Half4), 8u);
+  EXPECT_EQ(sizeof(OctNormal), 4u);
+  EXPECT_EQ(sizeof(SnormQuaternion), 8u);
+  EXPECT_EQ(sizeof(FixedPosition), 6u);
+}
+
+TEST(Quantize, Half) {
+  EXPECT_EQ(FloatToHalf(0.0f), 0x0000);
+  EXPECT_EQ(FloatToHalf(-0.0f), 0x8000);
+  EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+  EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+  EXPECT_EQ(FloatToHalf(65504.0f), 0x7bff);
+  EXPECT_EQ(FloatToHalf(1e6f), 0x7c00);
+  EXPECT_EQ(FloatToHalf(powf(2, -24)), 0x0001);
+  // Halfway between 1 and the next half, rounds to even.
+  EXPECT_EQ(FloatToHalf(1.0f + powf(2, -11)), 0x3c00);
+  EXPECT_EQ(FloatToHalf(1.0f + 3 * powf(2, -11)), 0x3c02);
+
+  // Every half that isn't NaN goes through float and back.
+  for (uint32_t h = 0; h < 0x10000; ++h) {
+    if ((h & 0x7c00) == 0x7c00 && (h & 0x3ff))
+      continue;
+    ASSERT_EQ(FloatToHalf(HalfToFloat((uint16_t)h)), h) << h;
+  }
+  EXPECT_TRUE(isnan(HalfToFloat(FloatToHalf(NAN))));
+}
+
+TEST(Quantize, Half4) {
+  const int count = 3;
+  Vec4 in[count] = {Vec4(1, -2, 0.5, 1), Vec4(1000.25, -0.001, 3.14159, 0), Vec4(0, 0, 0, 0)};
+  Half4 packed[count];
+  Vec4 out[count];
+  EncodeHalf4(in, packed, count);
+  DecodeHalf4(packed, out, count);
+  EXPECT_EQ(out[0].x, 1);
+  EXPECT_EQ(out[0].y, -2);
+  EXPECT_EQ(out[0].z, 0.5);
+  EXPECT_EQ(out[0].w, 1);
+  EXPECT_NEAR(out[1].x, 1000.25, 0.5);
+  EXPECT_NEAR(out[1].y, -0.001, 1e-6);
+  EXPECT_NEAR(out[1].z, 3.14159, 2e-3);
+  EXPECT_EQ(packed[1].x, FloatToHalf(1000.25f));
+}
+
+TEST(Quantize, OctNormal) {
+  // Directions all over the sphere, including the axes and the folded lower half.
+  const int count = 64 + 6;
+  Vec4 in[count];
+  for (int i = 0; i < 64; ++i) {
+    Scalar theta = i * 0.7, z = -1 + (i + 0.5) / 32;
+    Scalar r = sqrt(1 - z * z);
+    in[i].Set(r * cos(theta), r * sin(theta), z);
+  }
+  in[64].Set(1, 0, 0);
+  in[65].Set(-1, 0, 0);
+  in[66].Set(0, 1, 0);
+  in[67].Set(0, -1, 0);
+  in[68].Set(0, 0, 1);
+  in[69].Set(0, 0, -1);
+
+  OctNormal packed[count];
+  Vec4 out[count];
+  EncodeOctNormal(in, packed, count);
+  DecodeOctNormal(packed, out, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_NEAR(out[i].Length3(), 1, 1e-12) << i;
+    EXPECT_GT(Vec4::Dot3(out[i], in[i]), cos(1e-4)) << i;
+    EXPECT_EQ(out[i].w, 0) << i;
+  }
+}
+
+TEST(Quantize, SnormQuaternion) {
+  const int count = 3;
+  Quaternion in[count];
+  in[0].FromAxisAndAngle(0, 0, 1, 1.0);
+  in[1].FromAxisAndAngle(1 / sqrt(3.0), -1 / sqrt(3.0), 1 / sqrt(3.0), -2.5);
+  in[2].Set(0, 0, 0, -1);
+
+  SnormQuaternion packed[count];
+  Quaternion out[count];
+  EncodeSnormQuaternion(in, packed, count);
+  DecodeSnormQuaternion(packed, out, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_NEAR(out[i].x, in[i].x, 1e-4) << i;
+    EXPECT_NEAR(out[i].y, in[i].y, 1e-4) << i;
+    EXPECT_NEAR(out[i].z, in[i].z, 1e-4) << i;
+    EXPECT_NEAR(out[i].w, in[i].w, 1e-4) << i;
+    EXPECT_NEAR(out[i].x * out[i].x + out[i].y * out[i].y + out[i].z * out[i].z + out[i].w * out[i].w, 1, 1e-12);
+  }
+  EXPECT_EQ(packed[2].w, -32767);
+}
+
+TEST(Quantize, FixedPosition) {
+  Vec4 boxMin(-10, 0, 5), boxMax(10, 100, 5);
+  const int count = 4;
+  Vec4 in[count] = {Vec4(-10, 0, 5), Vec4(10, 100, 5), Vec4(1.2345, 67.891, 5), Vec4(-20, 200, 7)};
+  FixedPosition packed[count];
+  Vec4 out[count];
+  EncodeFixedPosition(in, packed, count, boxMin, boxMax);
+  DecodeFixedPosition(packed, out, count, boxMin, boxMax);
+
+  EXPECT_EQ(packed[0].x, 0);
+  EXPECT_EQ(packed[1].x, 65535);
+  EXPECT_EQ(packed[1].y, 65535);
+  EXPECT_NEAR(out[2].x, 1.2345, 20.0 / 65535 / 2);
+  EXPECT_NEAR(out[2].y, 67.891, 100.0 / 65535 / 2);
+  EXPECT_EQ(out[2].z, 5);
+  EXPECT_EQ(out[2].w, 1);
+  // Clamped to the box.
+  EXPECT_EQ(out[3].x, -10);
+  EXPECT_EQ(out[3].y, 100);
+  EXPECT_EQ(out[3].z, 5);
+}
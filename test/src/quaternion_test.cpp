@@ -0,0 +1,125 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/matrix.h"
+
+#define QUAT_EPSILON 1.0e-12
+
+using namespace mathing;
+
+TEST(QuaternionConstruct, FromTo) {
+  const int count = 5;
+  Vec4 from[count] = {Vec4(1, 0, 0), Vec4(0, 2, 0), Vec4(1, 2, 3), Vec4(0, 0, 1), Vec4(1, -1, 0.5)};
+  Vec4 to[count] = {Vec4(0, 3, 0), Vec4(0, 1, 0), Vec4(-3, 0.5, 2), Vec4(0, 0, -4), Vec4(-1, 1, -0.5 + 1e-9)};
+  Quaternion out[count];
+  Quaternion::FromTo(from, to, out, count);
+
+  // 90 degrees about z.
+  EXPECT_NEAR(out[0].z, sqrt(0.5), QUAT_EPSILON);
+  EXPECT_NEAR(out[0].w, sqrt(0.5), QUAT_EPSILON);
+  // Already there.
+  EXPECT_NEAR(out[1].w, 1, QUAT_EPSILON);
+
+  for (int i = 0; i < count; ++i) {
+    const Quaternion &q = out[i];
+    EXPECT_NEAR(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w, 1, QUAT_EPSILON) << i;
+    // The rotation takes the direction of from onto the direction of to. Nearly opposite directions
+    // lose precision in w, from |from||to| + from.to cancelling out.
+    Scalar eps = i == 4 ? 1e-6 : QUAT_EPSILON;
+    Vec4 turned = Matrix(q).Rotate(from[i]);
+    Vec4 dir = to[i];
+    dir.Normalize3();
+    turned.Normalize3();
+    EXPECT_NEAR(turned.x, dir.x, eps) << i;
+    EXPECT_NEAR(turned.y, dir.y, eps) << i;
+    EXPECT_NEAR(turned.z, dir.z, eps) << i;
+  }
+
+  // Zero length gives no rotation.
+  Quaternion q(1, 0, 0, 0);
+  q.FromTo(Vec4(), Vec4(1, 0, 0));
+  EXPECT_EQ(q.w, 1);
+}
+
+TEST(QuaternionRotate, MatchesMatrix) {
+  const int count = 4;
+  Quaternion q[count];
+  q[1].FromAxisAndAngle(0, 0, 1, M_PI / 2);
+  q[2].FromAxisAndAngle(sqrt(1 / 3.0), sqrt(1 / 3.0), sqrt(1 / 3.0), 2.1);
+  q[3] = Quaternion(-0.5, 0.5, 0.1, 0.7);
+  q[3].Set(q[3].x / sqrt(0.99), q[3].y / sqrt(0.99), q[3].z / sqrt(0.99), q[3].w / sqrt(0.99));
+  Vec4 v[count] = {Vec4(1, 2, 3, 1), Vec4(1, 0, 0, 0), Vec4(0.5, -2, 4, 1), Vec4(-3, 1, 2, 0)};
+
+  Vec4 each[count], byOne[count];
+  Quaternion::Rotate(q, v, each, count);
+  q[2].Rotate(v, byOne, count);
+
+  for (int i = 0; i < count; ++i) {
+    Vec4 single = q[i].Rotate(v[i]);
+    Vec4 expected = Matrix(q[i]).Rotate(v[i]);
+    EXPECT_NEAR(single.x, expected.x, QUAT_EPSILON) << i;
+    EXPECT_NEAR(single.y, expected.y, QUAT_EPSILON) << i;
+    EXPECT_NEAR(single.z, expected.z, QUAT_EPSILON) << i;
+    EXPECT_EQ(single.w, v[i].w);
+    EXPECT_EQ(each[i].x, single.x);
+    EXPECT_EQ(each[i].z, single.z);
+
+    expected = Matrix(q[2]).Rotate(v[i]);
+    EXPECT_NEAR(byOne[i].x, expected.x, QUAT_EPSILON) << i;
+    EXPECT_NEAR(byOne[i].y, expected.y, QUAT_EPSILON) << i;
+    EXPECT_NEAR(byOne[i].z, expected.z, QUAT_EPSILON) << i;
+  }
+  EXPECT_NEAR(each[1].y, 1, QUAT_EPSILON);
+
+  // In place.
+  q[1].Rotate(v, v, count);
+  EXPECT_NEAR(v[0].x, -2, QUAT_EPSILON);
+  EXPECT_NEAR(v[0].y, 1, QUAT_EPSILON);
+}
+
+TEST(QuaternionNormalize, Fast) {
+  const int count = 16;
+  Quaternion exact[count], fast[count];
+  for (int i = 0; i < count; ++i) {
+    Scalar scale = 0.5 + i * 0.1;
+    exact[i].Set(sin(i * 1.1) * scale, cos(i * 0.3) * scale, 0.2 * scale, (i - 8) * 0.1 * scale);
+    fast[i] = exact[i];
+  }
+
+  Quaternion single = exact[3];
+  Scalar len = sqrt(single.x*single.x + single.y*single.y + single.z*single.z + single.w*single.w);
+  EXPECT_NEAR(single.Normalize(), len, QUAT_EPSILON);
+
+  Quaternion::Normalize(exact, count);
+  Quaternion::NormalizeFast(fast, count);
+  for (int i = 0; i < count; ++i) {
+    const Quaternion &q = fast[i];
+    EXPECT_NEAR(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w, 1, 2 * 2.1e-7) << i;
+    EXPECT_NEAR(q.x, exact[i].x, 2.1e-7) << i;
+    EXPECT_NEAR(q.w, exact[i].w, 2.1e-7) << i;
+  }
+
+  // Lerp halfway between 90 degree turns is short, Nlerp isn't.
+  Quaternion a, b;
+  b.FromAxisAndAngle(0, 0, 1, M_PI / 2);
+  Quaternion mid = Quaternion::Nlerp(a, b, 0.5);
+  EXPECT_NEAR(mid.z, sin(M_PI / 8), 2.1e-7);
+  EXPECT_NEAR(mid.w, cos(M_PI / 8), 2.1e-7);
+}
+
+TEST(Quaternion, FromMatrixHalfTurn) {
+  // Half turns take the branches of FromMatrix() that don't divide by w.
+  const Vec4 axes[3] = {Vec4(1, 0.1, 0.2, 0), Vec4(0.1, 1, -0.2, 0), Vec4(0.2, -0.1, 1, 0)};
+  for (int i = 0; i < 3; ++i) {
+    Vec4 axis = axes[i];
+    axis.Normalize3();
+    Quaternion q;
+    q.FromAxisAndAngle(axis.x, axis.y, axis.z, M_PI - 1e-6);
+    Quaternion back;
+    back.FromMatrix(Matrix(q));
+    EXPECT_NEAR(back.x, q.x, QUAT_EPSILON) << i;
+    EXPECT_NEAR(back.y, q.y, QUAT_EPSILON) << i;
+    EXPECT_NEAR(back.z, q.z, QUAT_EPSILON) << i;
+    EXPECT_NEAR(back.w, q.w, QUAT_EPSILON) << i;
+  }
+}
@@ -0,0 +1,124 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mathing/registration.h"
+
+using namespace mathing;
+
+namespace {
+
+Scalar Random() { return rand() / (Scalar)RAND_MAX * 2 - 1; }
+
+void MakePairs(const Quaternion &q, const Vec4 &t, const Vec4 &offset, size_t count, Scalar noise,
+               std::vector<Vec4> &source, std::vector<Vec4> &target) {
+  source.resize(count);
+  target.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    source[i].Set(offset.x + Random() * 10, offset.y + Random() * 5, offset.z + Random() * 2, 1);
+    target[i] = q.Rotate(source[i]) + t;
+    target[i].Set(target[i].x + Random() * noise, target[i].y + Random() * noise, target[i].z + Random() * noise, 1);
+  }
+}
+
+// Same rotation, whichever sign.
+void ExpectSameRotation(const Quaternion &a, const Quaternion &b, Scalar epsilon) {
+  Scalar dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+  EXPECT_NEAR(fabs(dot), 1, epsilon);
+}
+
+}  // namespace
+
+TEST(Registration, Exact) {
+  srand(7);
+  Quaternion q;
+  q.FromAxisAndAngle(1 / sqrt(3.0), 1 / sqrt(3.0), -1 / sqrt(3.0), 2.0);
+  Vec4 t(5, -3, 12, 0);
+  std::vector<Vec4> source, target;
+  MakePairs(q, t, Vec4(0, 0, 0, 0), 1000, 0, source, target);
+
+  RegistrationSums sums;
+  sums.Add(&source[0], &target[0], NULL, source.size());
+  EXPECT_EQ(sums.Weight(), 1000);
+
+  Quaternion rotation;
+  Vec4 translation;
+  ASSERT_TRUE(sums.Solve(rotation, translation));
+  ExpectSameRotation(rotation, q, 1e-12);
+  EXPECT_NEAR(translation.x, 5, 1e-10);
+  EXPECT_NEAR(translation.y, -3, 1e-10);
+  EXPECT_NEAR(translation.z, 12, 1e-10);
+
+  Matrix m;
+  ASSERT_TRUE(sums.Solve(m));
+  Vec4 p = m.Transform(source[10]);
+  EXPECT_NEAR(p.x, target[10].x, 1e-10);
+  EXPECT_NEAR(p.y, target[10].y, 1e-10);
+  EXPECT_NEAR(p.z, target[10].z, 1e-10);
+
+  RegistrationSums empty;
+  EXPECT_FALSE(empty.Solve(m));
+}
+
+TEST(Registration, MergedRangesFarFromOrigin) {
+  // Points a million units out, summed in ranges as separate threads would, merged out of order.
+  srand(11);
+  Quaternion q;
+  q.FromAxisAndAngle(0, 1, 0, -0.3);
+  Vec4 t(0.25, 0.5, -0.75, 0);
+  std::vector<Vec4> source, target;
+  MakePairs(q, t, Vec4(1e6, -2e6, 5e5, 0), 100000, 0, source, target);
+
+  const size_t ranges = 4, size = source.size() / ranges;
+  RegistrationSums partial[ranges];
+  for (size_t r = 0; r < ranges; ++r) {
+    partial[r].Add(&source[r * size], &target[r * size], NULL, size);
+  }
+  RegistrationSums sums;
+  sums.Merge(partial[2]);
+  sums.Merge(partial[0]);
+  sums.Merge(partial[3]);
+  sums.Merge(partial[1]);
+  EXPECT_EQ(sums.Weight(), (Scalar)source.size());
+
+  RegistrationSums whole;
+  whole.Add(&source[0], &target[0], NULL, source.size());
+
+  Quaternion rotation, wholeRotation;
+  Vec4 translation, wholeTranslation;
+  ASSERT_TRUE(sums.Solve(rotation, translation));
+  ASSERT_TRUE(whole.Solve(wholeRotation, wholeTranslation));
+  ExpectSameRotation(rotation, q, 1e-12);
+  ExpectSameRotation(wholeRotation, q, 1e-12);
+  EXPECT_NEAR(translation.x, t.x, 1e-6);
+  EXPECT_NEAR(translation.y, t.y, 1e-6);
+  EXPECT_NEAR(translation.z, t.z, 1e-6);
+  Vec4 centroid = sums.SourceCentroid(), wholeCentroid = whole.SourceCentroid();
+  EXPECT_NEAR(centroid.x, wholeCentroid.x, 1e-8);
+}
+
+TEST(Registration, Weights) {
+  // Half the pairs are outliers with no weight, and the rest are noisy.
+  srand(3);
+  Quaternion q;
+  q.FromAxisAndAngle(0, 0, 1, 3.0);
+  Vec4 t(1, 2, 3, 0);
+  std::vector<Vec4> source, target;
+  MakePairs(q, t, Vec4(0, 0, 0, 0), 2000, 1e-3, source, target);
+  std::vector<Scalar> weights(source.size(), 1);
+  for (size_t i = 0; i < source.size(); i += 2) {
+    target[i].Set(Random() * 100, Random() * 100, Random() * 100, 1);
+    weights[i] = 0;
+  }
+
+  RegistrationSums sums;
+  sums.Add(&source[0], &target[0], &weights[0], source.size());
+  EXPECT_EQ(sums.Weight(), 1000);
+  Quaternion rotation;
+  Vec4 translation;
+  ASSERT_TRUE(sums.Solve(rotation, translation));
+  ExpectSameRotation(rotation, q, 1e-6);
+  EXPECT_NEAR(translation.z, 3, 1e-3);
+}
@@ -0,0 +1,136 @@
+#include <math.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mathing/snapshot.h"
+
+using namespace mathing;
+
+namespace {
+
+const int kCount = 100;
+
+void MakeTransforms(Quaternion *rotations, Vec4 *positions, Scalar time) {
+  for (int i = 0; i < kCount; ++i) {
+    rotations[i].FromAxisAndAngle(0, 0, 1, i * 0.1 + time);
+    positions[i].Set(i * 3.5 - 100, sin(i + time) * 10, 2000 + i, 1);
+  }
+}
+
+}  // namespace
+
+TEST(Snapshot, RoundTrip) {
+  Quaternion rotations[kCount];
+  Vec4 positions[kCount];
+  MakeTransforms(rotations, positions, 0);
+
+  Snapshot empty, sent;
+  sent.Set(rotations, positions, kCount);
+  std::vector<uint8_t> bytes;
+  sent.Encode(empty, bytes);
+
+  Snapshot received;
+  ASSERT_TRUE(received.Decode(empty, &bytes[0], bytes.size()));
+  ASSERT_EQ(received.Count(), (size_t)kCount);
+
+  Quaternion outRotations[kCount];
+  Vec4 outPositions[kCount];
+  received.Get(outRotations, outPositions);
+  for (int i = 0; i < kCount; ++i) {
+    // The same rotation, with either sign.
+    Scalar dot = outRotations[i].x * rotations[i].x + outRotations[i].y * rotations[i].y +
+                 outRotations[i].z * rotations[i].z + outRotations[i].w * rotations[i].w;
+    EXPECT_NEAR(fabs(dot), 1, 1e-8) << i;
+    EXPECT_NEAR(outPositions[i].x, positions[i].x, SNAPSHOT_POSITION_STEP / 2) << i;
+    EXPECT_NEAR(outPositions[i].y, positions[i].y, SNAPSHOT_POSITION_STEP / 2) << i;
+    EXPECT_NEAR(outPositions[i].z, positions[i].z, SNAPSHOT_POSITION_STEP / 2) << i;
+    EXPECT_EQ(outPositions[i].w, 1);
+  }
+
+  // Matrices decode to the same transforms.
+  Matrix transforms[kCount];
+  received.Get(transforms);
+  Vec4 p = transforms[7].Transform(Vec4(1, 0, 0, 1));
+  Vec4 expected = outPositions[7] + outRotations[7].Rotate(Vec4(1, 0, 0, 0));
+  EXPECT_NEAR(p.x, expected.x, 1e-12);
+  EXPECT_NEAR(p.y, expected.y, 1e-12);
+}
+
+TEST(Snapshot, Delta) {
+  Quaternion rotations[kCount];
+  Vec4 positions[kCount];
+  MakeTransforms(rotations, positions, 0);
+  Snapshot empty, baseline;
+  baseline.Set(rotations, positions, kCount);
+  std::vector<uint8_t> full;
+  baseline.Encode(empty, full);
+
+  // Nothing changed, a bit per entity and the count.
+  std::vector<uint8_t> same;
+  baseline.Encode(baseline, same);
+  EXPECT_EQ(same.size(), 4u + (kCount + 7) / 8);
+
+  // A few move a little, they come out exactly, and it's much smaller than sending it all.
+  positions[3].x += 0.01;
+  positions[50].y -= 0.5;
+  rotations[99].FromAxisAndAngle(0, 0, 1, 9.95);
+  Snapshot next;
+  next.Set(rotations, positions, kCount);
+  std::vector<uint8_t> delta;
+  next.Encode(baseline, delta);
+  EXPECT_LT(delta.size(), full.size() / 10);
+
+  Snapshot received;
+  ASSERT_TRUE(received.Decode(baseline, &delta[0], delta.size()));
+  std::vector<uint8_t> again;
+  received.Encode(baseline, again);
+  EXPECT_EQ(again, delta);
+  Quaternion outRotations[kCount];
+  Vec4 outPositions[kCount];
+  received.Get(outRotations, outPositions);
+  EXPECT_NEAR(outPositions[3].x, positions[3].x, SNAPSHOT_POSITION_STEP / 2);
+  EXPECT_NEAR(outPositions[50].y, positions[50].y, SNAPSHOT_POSITION_STEP / 2);
+
+  // Flipping the sign of a rotation isn't a change.
+  for (int i = 0; i < kCount; ++i) {
+    rotations[i].Set(-rotations[i].x, -rotations[i].y, -rotations[i].z, -rotations[i].w);
+  }
+  Snapshot flipped;
+  flipped.Set(rotations, positions, kCount);
+  std::vector<uint8_t> flippedDelta;
+  flipped.Encode(next, flippedDelta);
+  EXPECT_EQ(flippedDelta.size(), same.size());
+}
+
+TEST(Snapshot, Truncated) {
+  Quaternion rotations[kCount];
+  Vec4 positions[kCount];
+  MakeTransforms(rotations, positions, 1);
+  Snapshot empty, sent;
+  sent.Set(rotations, positions, kCount);
+  std::vector<uint8_t> bytes;
+  sent.Encode(empty, bytes);
+
+  Snapshot received;
+  EXPECT_FALSE(received.Decode(empty, &bytes[0], bytes.size() - 1));
+  EXPECT_EQ(received.Count(), 0u);
+  EXPECT_FALSE(received.Decode(empty, &bytes[0], 2));
+  EXPECT_TRUE(received.Decode(empty, &bytes[0], bytes.size()));
+}
+
+TEST(Snapshot, BadWidth) {
+  // One entity, changed, with only position x, and a position width field of 63, wider than
+  // any difference the encoder writes.
+  std::vector<uint8_t> bytes(4 + 1 + 16, 0xff);
+  bytes[0] = 1;
+  bytes[1] = bytes[2] = bytes[3] = 0;
+  bytes[4] = 1 | (0x10 << 1);
+  Snapshot empty, received;
+  EXPECT_FALSE(received.Decode(empty, &bytes[0], bytes.size()));
+  EXPECT_EQ(received.Count(), 0u);
+
+  // The same with a rotation width field of 31, and only rotation x.
+  bytes[4] = 1 | (0x01 << 1);
+  EXPECT_FALSE(received.Decode(empty, &bytes[0], bytes.size()));
+}
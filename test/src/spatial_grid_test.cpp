@@ -0,0 +1,105 @@
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mathing/spatial_grid.h"
+
+using namespace mathing;
+
+static std::vector<Vec4> RandomPoints(size_t count, Scalar extent) {
+  srand(7);
+  std::vector<Vec4> points(count);
+  for (size_t i = 0; i < count; ++i) {
+    points[i].Set(extent * rand() / RAND_MAX - extent / 2,
+                  extent * rand() / RAND_MAX - extent / 2,
+                  extent * rand() / RAND_MAX - extent / 2, 1);
+  }
+  return points;
+}
+
+struct PairCounter {
+  const Vec4 *points;
+  size_t pairs;
+  PairCounter(const Vec4 *p) : points(p), pairs(0) {}
+  void operator()(uint32_t i, uint32_t j, Scalar distSqr) {
+    EXPECT_LT(i, j);
+    EXPECT_EQ(distSqr, (points[i] - points[j]).Length3Sqr());
+    ++pairs;
+  }
+};
+
+TEST(SpatialHashGrid, QueryRadiusMatchesBruteForce) {
+  std::vector<Vec4> points = RandomPoints(500, 10);
+  SpatialHashGrid grid;
+  grid.Build(&points[0], points.size(), 1);
+
+  // Radius both smaller and larger than the cells.
+  Scalar radii[2] = {0.8, 2.5};
+  for (int r = 0; r < 2; ++r) {
+    Vec4 center = points[3];
+    std::vector<uint32_t> found(points.size());
+    size_t count = grid.QueryRadius(center, radii[r], &found[0], found.size());
+    found.resize(count);
+    std::sort(found.begin(), found.end());
+
+    std::vector<uint32_t> expected;
+    for (size_t i = 0; i < points.size(); ++i) {
+      if ((points[i] - center).Length3Sqr() <= radii[r] * radii[r]) {
+        expected.push_back((uint32_t)i);
+      }
+    }
+    EXPECT_EQ(found, expected);
+  }
+}
+
+TEST(SpatialHashGrid, QueryKNearestMatchesBruteForce) {
+  std::vector<Vec4> points = RandomPoints(500, 10);
+  SpatialHashGrid grid;
+  grid.Build(&points[0], points.size(), 0.5);
+
+  Vec4 center(0.3, -1.2, 2, 1);
+  uint32_t results[8];
+  Scalar distSqr[8];
+  ASSERT_EQ(grid.QueryKNearest(center, 8, results, distSqr), 8u);
+
+  std::vector<Scalar> all;
+  for (size_t i = 0; i < points.size(); ++i) {
+    all.push_back((points[i] - center).Length3Sqr());
+  }
+  std::sort(all.begin(), all.end());
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(distSqr[i], all[i]);
+    EXPECT_EQ((points[results[i]] - center).Length3Sqr(), distSqr[i]);
+  }
+
+  // Fewer points in range than asked for.
+  EXPECT_EQ(grid.QueryKNearest(center, 8, results, distSqr, sqrt(all[2]) + 1e-9), 3u);
+}
+
+TEST(SpatialHashGrid, PairsSplitByBuckets) {
+  std::vector<Vec4> points = RandomPoints(400, 8);
+  SpatialHashGrid grid;
+  grid.Build(&points[0], points.size(), 1);
+
+  size_t expected = 0;
+  for (size_t i = 0; i < points.size(); ++i) {
+    for (size_t j = i + 1; j < points.size(); ++j) {
+      if ((points[i] - points[j]).Length3Sqr() < 1) {
+        ++expected;
+      }
+    }
+  }
+
+  PairCounter all(&points[0]);
+  grid.ForEachPair(1, all);
+  EXPECT_EQ(all.pairs, expected);
+
+  // As if each half were on its own thread.
+  PairCounter lo(&points[0]), hi(&points[0]);
+  size_t half = grid.BucketCount() / 2;
+  grid.ForEachPair(1, lo, 0, half);
+  grid.ForEachPair(1, hi, half);
+  EXPECT_EQ(lo.pairs + hi.pairs, expected);
+}
@@ -0,0 +1,134 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mathing/spatial_sort.h"
+
+using namespace mathing;
+
+// Bounds that make the 10 bit grid cells line up with the integers.
+static const Vec4 g_min(0, 0, 0, 1);
+static const Vec4 g_max(1023, 1023, 1023, 1);
+
+TEST(SpatialSort, MortonBitOrder) {
+  Vec4 points[4] = {
+    Vec4(1, 0, 0, 1),
+    Vec4(0, 1, 0, 1),
+    Vec4(0, 0, 1, 1),
+    Vec4(1023, 1023, 1023, 1),
+  };
+  uint32_t keys[4];
+  MortonKeys30(points, 4, g_min, g_max, keys);
+  EXPECT_EQ(keys[0], 1u);
+  EXPECT_EQ(keys[1], 2u);
+  EXPECT_EQ(keys[2], 4u);
+  EXPECT_EQ(keys[3], (1u << 30) - 1);
+
+  uint64_t keys63[4];
+  MortonKeys63(points, 4, g_min, Vec4(2097151, 2097151, 2097151, 1), keys63);
+  EXPECT_EQ(keys63[0], 1u);
+  EXPECT_EQ(keys63[1], 2u);
+  EXPECT_EQ(keys63[2], 4u);
+}
+
+TEST(SpatialSort, HilbertNeighbors) {
+  // The curve starts at the origin and fills the 4x4x4 corner first, one step at a time.
+  Vec4 points[64];
+  for (int i = 0; i < 64; ++i) {
+    points[i].Set(i % 4, (i / 4) % 4, i / 16, 1);
+  }
+  uint32_t perm[64];
+  uint32_t keys[64];
+  HilbertKeys30(points, 64, g_min, g_max, keys);
+  SortKeys(keys, 64, perm);
+
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ(keys[i], (uint32_t)i);
+  }
+  for (int i = 1; i < 64; ++i) {
+    Vec4 step = points[perm[i]] - points[perm[i - 1]];
+    EXPECT_EQ(fabs(step.x) + fabs(step.y) + fabs(step.z), 1) << "at " << i;
+  }
+}
+
+TEST(SpatialSort, PermutationSortsKeys) {
+  srand(1);
+  const size_t count = 1000;
+  std::vector<uint64_t> keys(count), original(count);
+  for (size_t i = 0; i < count; ++i) {
+    original[i] = keys[i] = ((uint64_t)rand() << 31) ^ (uint64_t)rand();
+  }
+  std::vector<uint32_t> perm(count);
+  SortKeys(&keys[0], count, &perm[0]);
+
+  std::vector<uint64_t> permuted(count);
+  ApplyPermutation(&original[0], &perm[0], count, &permuted[0]);
+  for (size_t i = 0; i < count; ++i) {
+    EXPECT_EQ(permuted[i], keys[i]);
+    if (i > 0) {
+      EXPECT_LE(keys[i - 1], keys[i]);
+    }
+  }
+}
+
+template <typename Key>
+static void ParallelSort(Key *keys, size_t count, uint32_t *perm, size_t ranges) {
+  ParallelKeySort<Key> sorter;
+  sorter.Begin(keys, count, perm, ranges);
+  std::vector<std::thread> threads;
+  for (int pass = 0; pass < sorter.PassCount(); ++pass) {
+    for (size_t r = 0; r < sorter.RangeCount(); ++r) {
+      threads.emplace_back([&sorter, pass, r]() { sorter.Count(pass, r); });
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+      threads[t].join();
+    }
+    threads.clear();
+    sorter.Offsets(pass);
+    for (size_t r = 0; r < sorter.RangeCount(); ++r) {
+      threads.emplace_back([&sorter, pass, r]() { sorter.Scatter(pass, r); });
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+      threads[t].join();
+    }
+    threads.clear();
+  }
+  for (size_t r = 0; r < sorter.RangeCount(); ++r) {
+    sorter.Finish(r);
+  }
+}
+
+TEST(SpatialSort, ParallelMatchesSerial) {
+  srand(2);
+  const size_t count = 1001;
+  std::vector<uint64_t> keys(count), expectKeys(count);
+  std::vector<uint32_t> keys32(count), expectKeys32(count);
+  for (size_t i = 0; i < count; ++i) {
+    keys[i] = expectKeys[i] = ((uint64_t)rand() << 31) ^ (uint64_t)rand();
+    // Repeats, and high bytes that are all 0, which skips passes.
+    keys32[i] = expectKeys32[i] = (uint32_t)(rand() % 300);
+  }
+  std::vector<uint32_t> perm(count), expectPerm(count);
+  SortKeys(&expectKeys[0], count, &expectPerm[0]);
+  ParallelSort(&keys[0], count, &perm[0], 4);
+  EXPECT_EQ(keys, expectKeys);
+  EXPECT_EQ(perm, expectPerm);
+
+  SortKeys(&expectKeys32[0], count, &expectPerm[0]);
+  for (size_t ranges = 1; ranges <= 7; ranges += 3) {
+    std::vector<uint32_t> sorted(keys32);
+    ParallelSort(&sorted[0], count, &perm[0], ranges);
+    EXPECT_EQ(sorted, expectKeys32) << ranges;
+    EXPECT_EQ(perm, expectPerm) << ranges;
+  }
+
+  // More ranges than keys.
+  uint32_t few[3] = {5, 1, 3};
+  ParallelSort(few, 3, &perm[0], 8);
+  EXPECT_EQ(few[0], 1u);
+  EXPECT_EQ(few[2], 5u);
+  EXPECT_EQ(perm[0], 1u);
+}
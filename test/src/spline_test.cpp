@@ -0,0 +1,134 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/spline.h"
+
+#define SPLINE_EPSILON 1.0e-12
+
+using namespace mathing;
+
+#define EXPECT_VEC_NEAR(a, b, eps) \
+  EXPECT_NEAR(a.x, b.x, eps) << a; \
+  EXPECT_NEAR(a.y, b.y, eps) << a; \
+  EXPECT_NEAR(a.z, b.z, eps) << a; \
+  EXPECT_NEAR(a.w, b.w, eps) << a;
+
+TEST(Spline, CatmullRomThroughPoints) {
+  Vec4 points[4] = {Vec4(0, 0, 0, 1), Vec4(1, 2, 0, 1), Vec4(3, 2, 1, 1), Vec4(4, 0, 1, 1)};
+  Spline spline;
+  spline.SetCatmullRom(points, 4);
+  ASSERT_EQ(spline.SegmentCount(), 3u);
+
+  Scalar u[6] = {-1, 0, 1, 2, 3, 7};
+  Vec4 out[6];
+  spline.Evaluate(u, out, 6);
+  EXPECT_VEC_NEAR(out[0], points[0], SPLINE_EPSILON);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_VEC_NEAR(out[i + 1], points[i], SPLINE_EPSILON);
+  }
+  EXPECT_VEC_NEAR(out[5], points[3], SPLINE_EPSILON);
+
+  // The tangent at an inner point is half the chord between its neighbors.
+  Scalar h = 1e-6;
+  Vec4 tangent = (spline.Evaluate(1 + h) - spline.Evaluate(1 - h)) / (2 * h);
+  Vec4 expected = (points[2] - points[0]) * 0.5;
+  EXPECT_NEAR(tangent.x, expected.x, 1e-6);
+  EXPECT_NEAR(tangent.y, expected.y, 1e-6);
+}
+
+TEST(Spline, HermiteAndBezier) {
+  Vec4 p0(0, 0, 0, 1), c0(1, 3, 0, 1), c1(3, 3, 0, 1), p1(4, 0, 0, 1);
+  Vec4 bezierPoints[4] = {p0, c0, c1, p1};
+  Spline bezier;
+  bezier.SetBezier(bezierPoints, 4);
+
+  // The same curve, as Hermite, has tangents 3 times the control legs.
+  Vec4 hermitePoints[4] = {p0, (c0 - p0) * 3, p1, (p1 - c1) * 3};
+  Spline hermite;
+  hermite.SetHermite(hermitePoints, 2);
+  ASSERT_EQ(hermite.SegmentCount(), 1u);
+
+  for (int i = 0; i <= 8; ++i) {
+    Scalar t = i / 8.0;
+    // de Casteljau
+    Vec4 a = Vec4::Lerp(p0, c0, t), b = Vec4::Lerp(c0, c1, t), c = Vec4::Lerp(c1, p1, t);
+    Vec4 expected = Vec4::Lerp(Vec4::Lerp(a, b, t), Vec4::Lerp(b, c, t), t);
+    Vec4 fromBezier = bezier.Evaluate(t);
+    Vec4 fromHermite = hermite.Evaluate(t);
+    EXPECT_VEC_NEAR(fromBezier, expected, SPLINE_EPSILON);
+    EXPECT_VEC_NEAR(fromHermite, expected, SPLINE_EPSILON);
+  }
+}
+
+TEST(Spline, ConstantSpeed) {
+  // A straight line with the controls bunched up at the start, so u is far from distance.
+  Vec4 points[4] = {Vec4(0, 0, 0, 1), Vec4(0.1, 0, 0, 1), Vec4(0.2, 0, 0, 1), Vec4(3, 0, 0, 1)};
+  Spline spline;
+  spline.SetBezier(points, 4);
+  spline.BuildArcLength(64);
+  EXPECT_NEAR(spline.Length(), 3, SPLINE_EPSILON);
+
+  const int count = 31;
+  Scalar distances[count];
+  Vec4 out[count];
+  for (int i = 0; i < count; ++i) {
+    distances[i] = i * 0.1;
+  }
+  spline.EvaluateAtDistance(distances, out, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_NEAR(out[i].x, distances[i], 2e-3) << i;
+  }
+
+  // A quarter circle, near enough, with Bezier controls.
+  Scalar k = 0.5522847498;
+  Vec4 arc[4] = {Vec4(1, 0, 0, 1), Vec4(1, k, 0, 1), Vec4(k, 1, 0, 1), Vec4(0, 1, 0, 1)};
+  spline.SetBezier(arc, 4);
+  spline.BuildArcLength();
+  EXPECT_NEAR(spline.Length(), M_PI / 2, 1e-3);
+  Vec4 half = spline.Evaluate(spline.ParamAtDistance(spline.Length() / 2));
+  EXPECT_NEAR(half.x, sqrt(0.5), 1e-3);
+  EXPECT_NEAR(half.y, sqrt(0.5), 1e-3);
+}
+
+static Scalar AngleZ(const Quaternion &q) {
+  return 2 * atan2(q.z, q.w);
+}
+
+TEST(QuaternionSpline, Squad) {
+  // Even steps about one axis, where SQUAD is the same as slerp.
+  Quaternion even[4];
+  for (int i = 0; i < 4; ++i) {
+    even[i].FromAxisAndAngle(0, 0, 1, 0.5 * i);
+  }
+  // One of them from the other side.
+  even[2].Set(-even[2].x, -even[2].y, -even[2].z, -even[2].w);
+
+  QuaternionSpline spline;
+  spline.Set(even, 4);
+  ASSERT_EQ(spline.SegmentCount(), 3u);
+
+  const int count = 13;
+  Scalar u[count];
+  Quaternion out[count];
+  for (int i = 0; i < count; ++i) {
+    u[i] = i * 0.25;
+  }
+  spline.Evaluate(u, out, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_NEAR(AngleZ(out[i]), 0.5 * u[i], SPLINE_EPSILON) << u[i];
+  }
+
+  // Uneven rotations about different axes, it still goes through each one, and stays unit length.
+  Quaternion uneven[3];
+  uneven[1].FromAxisAndAngle(1, 0, 0, 0.8);
+  uneven[2].FromAxisAndAngle(0, 1, 0, 1.5);
+  spline.Set(uneven, 3);
+  for (int i = 0; i < 3; ++i) {
+    Quaternion q = spline.Evaluate(i);
+    EXPECT_NEAR(fabs(q.x*uneven[i].x + q.y*uneven[i].y + q.z*uneven[i].z + q.w*uneven[i].w), 1, SPLINE_EPSILON);
+  }
+  for (int i = 0; i <= 20; ++i) {
+    Quaternion q = spline.Evaluate(i * 0.1);
+    EXPECT_NEAR(q.x*q.x + q.y*q.y + q.z*q.z + q.w*q.w, 1, SPLINE_EPSILON);
+  }
+}
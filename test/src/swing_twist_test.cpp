@@ -0,0 +1,83 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/swing_twist.h"
+
+#define SWING_TWIST_TEST_EPSILON 1.0e-12
+
+using namespace mathing;
+
+static Quaternion AxisAngle(Scalar x, Scalar y, Scalar z, Scalar angle) {
+  Quaternion q;
+  q.FromAxisAndAngle(x, y, z, angle);
+  return q;
+}
+
+// Same rotation, either sign.
+static Scalar RotationDot(const Quaternion &a, const Quaternion &b) {
+  return fabs(a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w);
+}
+
+TEST(SwingTwist, DecomposeAndCompose) {
+  const Vec4 axis(0, 1, 0);
+  const int count = 3;
+  Quaternion rots[count] = {
+    // 40 degrees of twist, then 60 degrees of swing about z.
+    AxisAngle(0, 0, 1, M_PI / 3) * AxisAngle(0, 1, 0, 2 * M_PI / 9),
+    AxisAngle(1, 0, 0, -0.5) * AxisAngle(0, 1, 0, -1.2),
+    // Swings the axis all the way around, no twist to find.
+    AxisAngle(1, 0, 0, M_PI)};
+  Quaternion swing[count], twist[count], back[count];
+
+  SwingTwistDecompose(rots, axis, swing, twist, count);
+  SwingTwistCompose(swing, twist, back, count);
+
+  EXPECT_NEAR(twist[0].y, sin(M_PI / 9), SWING_TWIST_TEST_EPSILON);
+  EXPECT_NEAR(swing[0].z, sin(M_PI / 6), SWING_TWIST_TEST_EPSILON);
+  EXPECT_NEAR(twist[1].y, sin(-0.6), SWING_TWIST_TEST_EPSILON);
+  EXPECT_NEAR(twist[2].w, 1, SWING_TWIST_TEST_EPSILON);
+
+  for (int i = 0; i < count; ++i) {
+    EXPECT_GE(swing[i].w, 0);
+    EXPECT_GE(twist[i].w, 0);
+    // The twist is about the axis, and the swing is about something perpendicular to it.
+    EXPECT_NEAR(twist[i].x, 0, SWING_TWIST_TEST_EPSILON);
+    EXPECT_NEAR(twist[i].z, 0, SWING_TWIST_TEST_EPSILON);
+    EXPECT_NEAR(swing[i].y, 0, SWING_TWIST_TEST_EPSILON);
+    EXPECT_NEAR(RotationDot(back[i], rots[i]), 1, SWING_TWIST_TEST_EPSILON);
+  }
+}
+
+TEST(SwingTwist, ClampLimits) {
+  const Vec4 axis(1, 0, 0);
+  const int count = 3;
+  SwingTwistLimit limits[count];
+  for (int i = 0; i < count; ++i) {
+    limits[i].Set(axis, M_PI / 4, -M_PI / 6, M_PI / 3);
+  }
+  Quaternion rots[count] = {
+    // Inside the limits.
+    AxisAngle(0, 1, 0, 0.3) * AxisAngle(1, 0, 0, 0.5),
+    // Swung 90 degrees about y and z, twisted past the max.
+    AxisAngle(0, sqrt(0.5), sqrt(0.5), M_PI / 2) * AxisAngle(1, 0, 0, 1.5),
+    // Twisted past the min, given with negative w.
+    AxisAngle(1, 0, 0, -1.0)};
+  rots[2].Set(-rots[2].x, -rots[2].y, -rots[2].z, -rots[2].w);
+  Quaternion before[count] = {rots[0], rots[1], rots[2]};
+
+  EXPECT_EQ(ClampSwingTwist(rots, limits, count), 2u);
+
+  EXPECT_EQ(rots[0].x, before[0].x);
+  EXPECT_EQ(rots[0].w, before[0].w);
+
+  Quaternion expected = AxisAngle(0, sqrt(0.5), sqrt(0.5), M_PI / 4) * AxisAngle(1, 0, 0, M_PI / 3);
+  EXPECT_NEAR(RotationDot(rots[1], expected), 1, SWING_TWIST_TEST_EPSILON);
+
+  // Keeps its sign.
+  EXPECT_LT(rots[2].w, 0);
+  EXPECT_NEAR(rots[2].x, sin(M_PI / 12), SWING_TWIST_TEST_EPSILON);
+  EXPECT_NEAR(rots[2].w, -cos(M_PI / 12), SWING_TWIST_TEST_EPSILON);
+
+  // Clamped rotations are within the limits.
+  EXPECT_EQ(ClampSwingTwist(rots, limits, count), 0u);
+}
@@ -0,0 +1,103 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "mathing/text.h"
+
+using namespace mathing;
+
+TEST(Text, ScalarRoundTrip) {
+  const Scalar values[] = {0, -0.0, 1, -1, 0.1, 1.0 / 3, M_PI, 1e-310, -2.2250738585072014e-308, 1.7976931348623157e308};
+  for (Scalar v : values) {
+    char buffer[TEXT_SCALAR_CHARS];
+    char *end = ToChars(buffer, buffer + sizeof(buffer), v);
+    ASSERT_TRUE(end != NULL) << v;
+    Scalar back = 1234;
+    EXPECT_EQ(FromChars(buffer, end, back), end);
+    EXPECT_EQ(memcmp(&back, &v, sizeof(v)), 0) << v;
+  }
+
+  char small[4];
+  EXPECT_TRUE(ToChars(small, small + sizeof(small), 0.125) == NULL);
+  Scalar s;
+  const char *text = "abc";
+  EXPECT_TRUE(FromChars(text, text + 3, s) == NULL);
+}
+
+TEST(Text, Values) {
+  char buffer[512];
+  Vec4 v(1.5, -2, 1.0 / 3, 1), vBack;
+  char *end = ToChars(buffer, buffer + sizeof(buffer), v);
+  EXPECT_EQ(std::string(buffer, end), "1.5 -2 0.3333333333333333 1");
+  EXPECT_EQ(FromChars(buffer, end, vBack), end);
+  EXPECT_EQ(vBack.z, v.z);
+
+  Quaternion q, qBack;
+  q.FromAxisAndAngle(0, 1, 0, 0.7);
+  end = ToChars(buffer, buffer + sizeof(buffer), q);
+  EXPECT_EQ(FromChars(buffer, end, qBack), end);
+  EXPECT_EQ(qBack.y, q.y);
+  EXPECT_EQ(qBack.w, q.w);
+
+  Matrix m(q, Vec4(0.1, 0.2, 0.3, 1)), mBack;
+  end = ToChars(buffer, buffer + sizeof(buffer), m);
+  EXPECT_EQ(FromChars(buffer, end, mBack), end);
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(mBack.Buff()[i], m.Buff()[i]) << i;
+  }
+
+  // Reads what operator<< writes.
+  std::ostringstream os;
+  os << q;
+  std::string printed = os.str();
+  EXPECT_TRUE(FromChars(printed.data(), printed.data() + printed.size(), qBack) != NULL);
+  EXPECT_NEAR(qBack.w, q.w, 1e-5);
+}
+
+TEST(Text, Bulk) {
+  const int count = 100;
+  Vec4 v[count];
+  Matrix m[count];
+  for (int i = 0; i < count; ++i) {
+    v[i].Set(rand() / 7.0, -i * 1e-9, i, 1);
+    Quaternion q;
+    q.FromAxisAndAngle(1, 0, 0, i * 0.01);
+    m[i].Set(q, v[i]);
+  }
+
+  std::string text("header\n");
+  size_t start = text.size();
+  AppendText(v, count, text);
+  AppendText(m, count, text);
+
+  Vec4 vBack[count + 1];
+  Matrix mBack[count];
+  const char *first = text.data() + start;
+  const char *last = text.data() + text.size();
+  // 100 Vec4, and then the next Vec4 is the start of the first matrix.
+  EXPECT_EQ(ParseText(first, last, vBack, count), (size_t)count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(vBack[i].x, v[i].x) << i;
+    EXPECT_EQ(vBack[i].y, v[i].y) << i;
+  }
+  const char *matrices = strchr(first, '\n');
+  for (int i = 1; i < count; ++i) {
+    matrices = strchr(matrices + 1, '\n');
+  }
+  EXPECT_EQ(ParseText(matrices, last, mBack, count + 5), (size_t)count);
+  EXPECT_EQ(mBack[count - 1].Buff()[4], m[count - 1].Buff()[4]);
+
+  EXPECT_EQ(ParseText(text.data(), last, vBack, count), 0u);
+}
+
+TEST(Text, StreamStateKept) {
+  std::ostringstream os;
+  os << Matrix::Identity();
+  os << " " << 0.125;
+  EXPECT_EQ(os.str().substr(os.str().size() - 6), " 0.125");
+  EXPECT_FALSE(os.flags() & std::ios_base::fixed);
+}
@@ -0,0 +1,72 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/matrix.h"
+#include "mathing/vec3.h"
+
+using namespace mathing;
+
+TEST(Vec3, Packed) {
+  EXPECT_EQ(sizeof(Vec3f), 12u);
+  EXPECT_EQ(sizeof(Vec3d), 24u);
+  Vec3f floats[2];
+  EXPECT_EQ((char *)&floats[1] - (char *)&floats[0], 12);
+}
+
+TEST(Vec3, WidenAndNarrow) {
+  const int count = 5;
+  Vec3f in[count];
+  for (int i = 0; i < count; ++i) {
+    in[i].Set(i, -i * 0.5f, i * 0.25f);
+  }
+
+  Vec4 wide[count];
+  Vec3ToVec4(in, wide, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(wide[i].x, in[i].x);
+    EXPECT_EQ(wide[i].y, in[i].y);
+    EXPECT_EQ(wide[i].z, in[i].z);
+    EXPECT_EQ(wide[i].w, 1);
+  }
+
+  Vec3d doubles[count];
+  Vec4ToVec3(wide, doubles, count);
+  Vec3ToVec4(doubles, wide, count, 0);
+  Vec3f back[count];
+  Vec4ToVec3(wide, back, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(doubles[i].y, in[i].y);
+    EXPECT_EQ(wide[i].w, 0);
+    EXPECT_EQ(back[i].z, in[i].z);
+  }
+}
+
+TEST(Vec3, MatrixTransform) {
+  Quaternion q;
+  q.FromAxisAndAngle(0, 0, 1, M_PI / 2);
+  Matrix m(q, Vec4(10, 20, 30, 1));
+
+  const int count = 3;
+  Vec3d points[count] = {Vec3d(1, 0, 0), Vec3d(0, 2, 0), Vec3d(1, 2, 3)};
+  Vec3d out[count];
+  m.Transform(points, out, count);
+  for (int i = 0; i < count; ++i) {
+    Vec4 expected = m.Transform(Vec4(points[i].x, points[i].y, points[i].z, 1));
+    EXPECT_NEAR(out[i].x, expected.x, 1e-12) << i;
+    EXPECT_NEAR(out[i].y, expected.y, 1e-12) << i;
+    EXPECT_NEAR(out[i].z, expected.z, 1e-12) << i;
+  }
+
+  // In place, as float, and directions don't move.
+  Vec3f dirs[count] = {Vec3f(1, 0, 0), Vec3f(0, 2, 0), Vec3f(1, 2, 3)};
+  m.Rotate(dirs, dirs, count);
+  EXPECT_NEAR(dirs[0].y, 1, 1e-6);
+  EXPECT_NEAR(dirs[1].x, -2, 1e-6);
+  EXPECT_NEAR(dirs[2].z, 3, 1e-6);
+
+  Vec3f pointsf[1] = {Vec3f(1, 0, 0)};
+  m.Transform(pointsf, pointsf, 1);
+  EXPECT_NEAR(pointsf[0].x, 10, 1e-5);
+  EXPECT_NEAR(pointsf[0].y, 21, 1e-5);
+  EXPECT_NEAR(pointsf[0].z, 30, 1e-5);
+}
@@ -0,0 +1,41 @@
+#include <math.h>
+
+#include "gtest/gtest.h"
+#include "mathing/vector.h"
+
+#define VEC_EPSILON 1.0e-15
+#define VEC_FAST_EPSILON 2.1e-7
+
+using namespace mathing;
+
+TEST(VectorNormalize, Fast) {
+  const int count = 64;
+  Vec4 exact[count], fast[count];
+  for (int i = 0; i < count; ++i) {
+    // Lengths from 1e-6 to 1e6, in all sorts of directions.
+    Scalar scale = pow(10.0, -6 + 12.0 * i / (count - 1));
+    exact[i].Set(sin(i * 1.3) * scale, cos(i * 0.7) * scale, (i % 5 - 2) * scale, 1);
+    fast[i] = exact[i];
+  }
+
+  Vec4 single = fast[10];
+  Scalar len = single.Length3();
+  EXPECT_NEAR(single.Normalize3Fast() / len, 1, VEC_FAST_EPSILON);
+  EXPECT_NEAR(single.Length3(), 1, VEC_FAST_EPSILON);
+  EXPECT_EQ(single.w, 1);
+
+  Vec4::Normalize3(exact, count);
+  Vec4::Normalize3Fast(fast, count);
+  for (int i = 0; i < count; ++i) {
+    EXPECT_NEAR(exact[i].Length3(), 1, VEC_EPSILON) << i;
+    EXPECT_NEAR(fast[i].Length3(), 1, VEC_FAST_EPSILON) << i;
+    EXPECT_NEAR(fast[i].x, exact[i].x, VEC_FAST_EPSILON) << i;
+    EXPECT_NEAR(fast[i].y, exact[i].y, VEC_FAST_EPSILON) << i;
+    EXPECT_NEAR(fast[i].z, exact[i].z, VEC_FAST_EPSILON) << i;
+    EXPECT_EQ(fast[i].w, 1);
+  }
+
+  Vec4 four(1, 2, 3, 4);
+  EXPECT_NEAR(four.Normalize4Fast(), sqrt(30.0), sqrt(30.0) * VEC_FAST_EPSILON);
+  EXPECT_NEAR(four.Length4(), 1, VEC_FAST_EPSILON);
+}
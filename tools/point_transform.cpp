@@ -0,0 +1,133 @@
+// Transforms a point file, of packed float or double x y z, into another.
+//
+//   point_transform [options] in out
+//
+//   --matrix m0 ... m15          the transform, in the order of Matrix::Buff()
+//   --rotate x y z w             a rotation quaternion, and
+//   --translate x y z            a translation, instead of --matrix
+//   --in-double, --out-double    points are Vec3d instead of Vec3f
+//   --mmap                       map the input instead of reading it
+//   --chunk n                    points per chunk
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mathing/matrix.h"
+#include "mathing/point_stream.h"
+#include "mathing/text.h"
+
+using namespace mathing;
+
+static void Usage()
+{
+	fprintf(stderr, "usage: point_transform [--matrix m0 .. m15 | --rotate x y z w --translate x y z]\n"
+		"                       [--in-double] [--out-double] [--mmap] [--chunk n] in out\n");
+}
+
+// Reads count numbers from the arguments after argv[i], and moves i past them.
+static bool ReadNumbers(int argc, char **argv, int &i, Scalar *out, int count)
+{
+	for (int k = 0; k < count; ++k)
+	{
+		if (++i >= argc)
+			return false;
+		const char *last = argv[i] + strlen(argv[i]);
+		if (FromChars(argv[i], last, out[k]) != last)
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	Scalar m[16];
+	Scalar rotate[4] = {0, 0, 0, 1};
+	Scalar translate[3] = {0, 0, 0};
+	bool haveMatrix = false;
+	PointTransformer::Type inType = PointTransformer::FLOAT32;
+	PointTransformer::Type outType = PointTransformer::FLOAT32;
+	bool mapped = false;
+	size_t chunk = POINT_STREAM_CHUNK;
+	const char *paths[2];
+	int pathCount = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		bool ok = true;
+		if (strcmp(arg, "--matrix") == 0)
+			ok = haveMatrix = ReadNumbers(argc, argv, i, m, 16);
+		else if (strcmp(arg, "--rotate") == 0)
+			ok = ReadNumbers(argc, argv, i, rotate, 4);
+		else if (strcmp(arg, "--translate") == 0)
+			ok = ReadNumbers(argc, argv, i, translate, 3);
+		else if (strcmp(arg, "--in-double") == 0)
+			inType = PointTransformer::FLOAT64;
+		else if (strcmp(arg, "--out-double") == 0)
+			outType = PointTransformer::FLOAT64;
+		else if (strcmp(arg, "--mmap") == 0)
+			mapped = true;
+		else if (strcmp(arg, "--chunk") == 0 && i + 1 < argc)
+			chunk = strtoul(argv[++i], 0, 10);
+		else if (arg[0] != '-' && pathCount < 2)
+			paths[pathCount++] = arg;
+		else
+			ok = false;
+		if (!ok)
+		{
+			Usage();
+			return 2;
+		}
+	}
+	if (pathCount != 2 || chunk == 0)
+	{
+		Usage();
+		return 2;
+	}
+
+	Matrix transform;
+	if (haveMatrix)
+	{
+		transform = Matrix(m);
+	}
+	else
+	{
+		Quaternion q(rotate[0], rotate[1], rotate[2], rotate[3]);
+		q.Normalize();
+		transform = Matrix(q, Vec4(translate[0], translate[1], translate[2], 1));
+	}
+
+	FILE *out = fopen(paths[1], "wb");
+	if (!out)
+	{
+		perror(paths[1]);
+		return 1;
+	}
+	PointTransformer transformer(transform, inType, outType, chunk);
+	bool ok;
+	if (mapped)
+	{
+		ok = transformer.RunMapped(paths[0], out);
+	}
+	else
+	{
+		FILE *in = fopen(paths[0], "rb");
+		if (!in)
+		{
+			perror(paths[0]);
+			fclose(out);
+			return 1;
+		}
+		ok = transformer.Run(in, out);
+		fclose(in);
+	}
+	if (fclose(out) != 0)
+		ok = false;
+	if (!ok)
+	{
+		fprintf(stderr, "point_transform: failed after %zu points\n", transformer.PointCount());
+		return 1;
+	}
+	return 0;
+}